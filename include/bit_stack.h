@@ -19,10 +19,15 @@ void json_z_bits_init(JsonBitStack *bits);
 
 void json_z_bits_clear(JsonBitStack *bits);
 
+// Empties the stack but keeps its array for reuse.
+void json_z_bits_reset(JsonBitStack *bits);
+
 bool json_z_bits_push(JsonBitStack *bits, bool value);
 
 bool json_z_bits_pop(JsonBitStack *bits);
 
 size_t json_z_bits_count(const JsonBitStack* bits);
 
+bool json_z_bits_get(const JsonBitStack* bits, size_t index);
+
 #endif //BIT_STACK_H
@@ -0,0 +1,55 @@
+#ifndef JSON_CHECKPOINT_H
+#define JSON_CHECKPOINT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "json_stream.h"
+
+#define JSON_CHECKPOINT_VERSION 1
+#define JSON_CHECKPOINT_HEADER_SIZE 52
+
+// Serializes the reader state after the last complete token: nesting, token types, position, line and column, and
+// the options other than the error handler. The format is little-endian and does not depend on the host. Returns the
+// size of the checkpoint; nothing is written when buffer_length is smaller.
+size_t json_stream_checkpoint(const JsonStream* stream, void* buffer, size_t buffer_length);
+
+// Replaces the parse state of an initialized stream with a checkpoint. The error handler and is_final_block are kept.
+// Afterwards json_total_bytes_consumed is the document offset to resume from; feed the input from there with
+// json_stream_continue. Throws JSON_ERROR_INVALID_CHECKPOINT for a malformed or incompatible checkpoint.
+bool json_stream_restore(JsonStream* stream, const void* checkpoint, size_t checkpoint_length);
+
+typedef struct JsonSeekPoint {
+    size_t offset;
+    size_t checkpoint;
+    size_t checkpoint_length;
+} JsonSeekPoint;
+
+// A sparse index of checkpoints taken while a document is read. After every interval bytes the next value that ends at
+// most depth levels deep is checkpointed, so with depth 1 and a top-level array each point starts a whole element.
+// points[i].offset is the document offset the point resumes from; its checkpoint is stored in data.
+typedef struct JsonSeekIndex {
+    size_t interval;
+    size_t depth;
+    size_t next_offset;
+    JsonSeekPoint* points;
+    size_t point_count;
+    size_t point_capacity;
+    unsigned char* data;
+    size_t data_length;
+    size_t data_capacity;
+} JsonSeekIndex;
+
+// Starts an index whose first point is the current state of stream, usually the start of the document.
+bool json_seek_index_init(JsonSeekIndex* index, JsonStream* stream, size_t interval, size_t depth);
+
+void json_seek_index_free(JsonSeekIndex* index);
+
+// Call after each token json_read returns; takes a checkpoint when one is due. Throws JSON_ERROR_OUT_OF_MEMORY.
+bool json_seek_index_update(JsonSeekIndex* index, JsonStream* stream);
+
+// Restores the last point at or before offset, or the first point when there is none. As with json_stream_restore,
+// json_total_bytes_consumed is then the document offset to feed the input from.
+bool json_stream_seek(JsonStream* stream, const JsonSeekIndex* index, size_t offset);
+
+#endif // JSON_CHECKPOINT_H
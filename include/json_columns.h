@@ -0,0 +1,65 @@
+#ifndef JSON_COLUMNS_H
+#define JSON_COLUMNS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "json_property_table.h"
+#include "json_stream.h"
+
+typedef enum {
+    JSON_COLUMN_BOOL,
+    JSON_COLUMN_I64,
+    JSON_COLUMN_DOUBLE,
+    JSON_COLUMN_STRING,
+} JsonColumnType;
+
+typedef struct JsonColumnDescriptor {
+    const char* name;
+    JsonColumnType type;
+} JsonColumnDescriptor;
+
+// One column in struct-of-arrays form. values holds a bool, int64_t or double per row; string columns instead hold
+// row_count + 1 size_t offsets into data, row i being data[offsets[i], offsets[i + 1]). Bit i of validity (least
+// significant bit first) is set when row i has a value; missing keys and nulls clear it and store zero or "".
+typedef struct JsonColumn {
+    const char* name;
+    JsonColumnType type;
+    void* values;
+    uint8_t* validity;
+    size_t null_count;
+    char* data;
+    size_t data_length;
+    size_t data_capacity;
+} JsonColumn;
+
+typedef struct JsonColumns {
+    JsonColumn* columns;
+    size_t column_count;
+    size_t row_count;
+    size_t row_capacity;
+    const char** names;
+    JsonPropertyTable table;
+    uint64_t* seen;
+} JsonColumns;
+
+bool json_columns_init(JsonColumns* columns, const JsonColumnDescriptor* descriptors, size_t descriptor_count);
+
+void json_columns_free(JsonColumns* columns);
+
+// Drops the rows, keeping the column buffers for the next batch.
+void json_columns_clear(JsonColumns* columns);
+
+// Appends the object at the stream's position, or the next one, as a row. Properties without a column are skipped,
+// so the stream must hold the complete object. A value of the wrong type raises the matching
+// JSON_ERROR_INVALID_OPERATION_EXPECTED_* and leaves the row out.
+bool json_columns_read_row(JsonStream* stream, JsonColumns* columns);
+
+// Appends every object of the array at the stream's position, or the next one, stopping on its JSON_TYPE_ARRAY_END.
+bool json_columns_read(JsonStream* stream, JsonColumns* columns);
+
+static inline bool json_column_is_valid(const JsonColumn* column, size_t row) {
+    return column->validity[row / 8] & (1u << (row % 8));
+}
+
+#endif // JSON_COLUMNS_H
@@ -0,0 +1,84 @@
+#ifndef JSON_DECOMPRESS_H
+#define JSON_DECOMPRESS_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "json_stream.h"
+
+#define JSON_DECOMPRESSOR_BLOCKS 3
+#define JSON_DECOMPRESSOR_INPUT_SIZE 65536
+#define JSON_DECOMPRESSOR_NO_BLOCK SIZE_MAX
+
+typedef enum JsonCompression {
+    JSON_COMPRESSION_NONE,
+    JSON_COMPRESSION_GZIP,
+    JSON_COMPRESSION_ZSTD,
+} JsonCompression;
+
+// A window of decompressed data. As with the file reader, each window is preceded by window_size bytes of headroom
+// that receive the unconsumed end of the previous window.
+typedef struct JsonDecompressorBlock {
+    char* data;
+    size_t length;
+    bool is_final;
+} JsonDecompressorBlock;
+
+// Decompresses a gzip or zstd file (detected from its magic bytes; anything else is passed through) into a small ring
+// of reusable windows and feeds them to a stream. The decompressed document is never held in memory as a whole.
+// Files of at least thread_threshold compressed bytes are decompressed on a second thread, so that the next windows
+// are produced while the current one is tokenized.
+typedef struct JsonDecompressor {
+    JsonDecompressorBlock blocks[JSON_DECOMPRESSOR_BLOCKS];
+    size_t window_size;
+    size_t thread_threshold;
+    char* memory;
+    unsigned char* input;
+    size_t input_offset;
+    size_t input_length;
+    bool input_eof;
+    JsonCompression compression;
+    void* codec;
+    bool codec_done;
+    int fd;
+    bool owns_fd;
+    size_t current;
+    char* carry;
+    size_t carry_capacity;
+    bool finished;
+
+    // Blocks are produced and taken in ring order. Once the thread runs, produced, released and error only change
+    // under the mutex; the producer may fill a block while produced < released + JSON_DECOMPRESSOR_BLOCKS.
+    size_t produced;
+    size_t taken;
+    size_t released;
+    const char* error;
+    bool threaded;
+    bool stop;
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+} JsonDecompressor;
+
+// Returns false when window_size is zero or the buffers cannot be allocated. A thread_threshold of SIZE_MAX never
+// starts a thread.
+bool json_decompressor_init(JsonDecompressor* decompressor, size_t window_size, size_t thread_threshold);
+
+void json_decompressor_free(JsonDecompressor* decompressor);
+
+// Returns false with errno set when the file cannot be opened or read, or when it is compressed with a codec this
+// build does not support (ENOTSUP).
+bool json_decompressor_open(JsonDecompressor* decompressor, const char* path);
+
+// Same as json_decompressor_open for a file that is already open; the descriptor is borrowed.
+bool json_decompressor_open_fd(JsonDecompressor* decompressor, int fd);
+
+void json_decompressor_close(JsonDecompressor* decompressor);
+
+// Hands the next decompressed window to a stream that was initialized with a NULL buffer, in the same way as
+// json_file_reader_next. Only the last window is passed as the final block. Returns false once the input is exhausted,
+// or after raising JSON_ERROR_READ_FAILED on the stream for an I/O error or corrupt compressed data.
+bool json_decompressor_next(JsonDecompressor* decompressor, JsonStream* stream);
+
+#endif // JSON_DECOMPRESS_H
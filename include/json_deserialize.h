@@ -0,0 +1,57 @@
+#ifndef JSON_DESERIALIZE_H
+#define JSON_DESERIALIZE_H
+
+#include <stddef.h>
+
+#include "json_property_table.h"
+#include "json_stream.h"
+
+typedef enum {
+    JSON_FIELD_BOOL,
+    JSON_FIELD_U8,
+    JSON_FIELD_I8,
+    JSON_FIELD_U16,
+    JSON_FIELD_I16,
+    JSON_FIELD_U32,
+    JSON_FIELD_I32,
+    JSON_FIELD_U64,
+    JSON_FIELD_I64,
+    JSON_FIELD_FLOAT,
+    JSON_FIELD_DOUBLE,
+    JSON_FIELD_STRING,
+    JSON_FIELD_OBJECT,
+} JsonFieldType;
+
+struct JsonObjectDescriptor;
+
+typedef struct JsonFieldDescriptor {
+    const char* name;
+    size_t offset;
+    JsonFieldType type;
+    bool required;
+    const struct JsonObjectDescriptor* object;
+} JsonFieldDescriptor;
+
+typedef struct JsonObjectDescriptor {
+    const JsonFieldDescriptor* fields;
+    size_t field_count;
+    const char** names;
+    JsonPropertyTable table;
+} JsonObjectDescriptor;
+
+bool json_object_descriptor_init(
+    JsonObjectDescriptor* descriptor,
+    const JsonFieldDescriptor* fields,
+    size_t field_count
+);
+
+void json_object_descriptor_free(JsonObjectDescriptor* descriptor);
+
+// Reads an object into out, which must be zero initialized. JSON_FIELD_STRING members receive a malloc'd copy of the
+// unescaped text and are released by json_deserialize_free. Unknown properties are skipped, so the stream must hold
+// the complete object.
+bool json_deserialize(JsonStream* stream, const JsonObjectDescriptor* descriptor, void* out);
+
+void json_deserialize_free(const JsonObjectDescriptor* descriptor, void* out);
+
+#endif // JSON_DESERIALIZE_H
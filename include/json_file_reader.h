@@ -0,0 +1,76 @@
+#ifndef JSON_FILE_READER_H
+#define JSON_FILE_READER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "json_stream.h"
+
+#define JSON_FILE_READER_MAX_DEPTH 8
+#define JSON_FILE_READER_NO_SLOT SIZE_MAX
+
+// A chunk buffer. Each one is preceded by chunk_size bytes of headroom, where the unconsumed end of the previous chunk
+// is copied so that the stream can continue from it without moving the new data. length is the size of the read
+// issued for the slot, or zero while the slot is idle.
+typedef struct JsonFileReaderSlot {
+    char* data;
+    uint64_t offset;
+    size_t length;
+    int64_t result;
+    bool pending;
+} JsonFileReaderSlot;
+
+typedef struct JsonFileReaderRing JsonFileReaderRing;
+
+// Reads a file in chunk_size pieces with up to depth reads in flight, so that the next chunks are read while the
+// current one is tokenized. Reads go through io_uring with registered buffers when the kernel allows it, and through
+// pread otherwise. The ring and buffers are set up once and reused for every file opened on the reader.
+typedef struct JsonFileReader {
+    JsonFileReaderSlot slots[JSON_FILE_READER_MAX_DEPTH];
+    size_t depth;
+    size_t chunk_size;
+    char* memory;
+    JsonFileReaderRing* ring;
+    bool registered_buffers;
+    int fd;
+    bool owns_fd;
+    uint64_t file_size;
+    uint64_t next_offset;
+    size_t current;
+    size_t next_slot;
+    char* carry;
+    size_t carry_capacity;
+    bool finished;
+} JsonFileReader;
+
+// depth must be between 2 and JSON_FILE_READER_MAX_DEPTH. Returns false on invalid arguments or allocation failure.
+bool json_file_reader_init(JsonFileReader* reader, size_t chunk_size, size_t depth, bool use_io_uring);
+
+void json_file_reader_free(JsonFileReader* reader);
+
+static inline bool json_file_reader_uses_io_uring(const JsonFileReader* reader) {
+    return reader->ring != NULL;
+}
+
+// Opens a file and starts reading it. Returns false with errno set when the file cannot be opened.
+bool json_file_reader_open(JsonFileReader* reader, const char* path);
+
+// Same as json_file_reader_open for a file that is already open; the descriptor is borrowed.
+bool json_file_reader_open_fd(JsonFileReader* reader, int fd);
+
+// Waits for reads still in flight and closes the file, leaving the reader ready for the next one.
+void json_file_reader_close(JsonFileReader* reader);
+
+// Hands the next chunk to a stream that was initialized with a NULL buffer, together with the part of the previous
+// chunk it did not consume. The last chunk is passed as the final block. Returns false once the file is exhausted, or
+// after raising JSON_ERROR_READ_FAILED on the stream.
+//
+//     json_stream_init(&stream, NULL, 0, false, options);
+//     while (json_file_reader_next(&reader, &stream)) {
+//         while (json_read(&stream)) {
+//             ...
+//         }
+//     }
+bool json_file_reader_next(JsonFileReader* reader, JsonStream* stream);
+
+#endif // JSON_FILE_READER_H
@@ -0,0 +1,145 @@
+#ifndef JSON_PATH_H
+#define JSON_PATH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "json_property_table.h"
+#include "json_stream.h"
+
+#define JSON_PATH_NO_INDEX SIZE_MAX
+
+// A step matches an object member named name, an array element at index, or, for a wildcard, any child. Pointer
+// reference tokens such as "0" set both, since RFC 6901 resolves them against whichever container is found.
+typedef struct JsonPathStep {
+    char* name;
+    size_t name_length;
+    size_t index;
+    bool wildcard;
+} JsonPathStep;
+
+typedef struct JsonPath {
+    JsonPathStep* steps;
+    size_t step_count;
+} JsonPath;
+
+// Compiles "$", "$.name", "$.*", "$[0]", "$[*]" and "$['name']" steps. Recursive descent and filters are not
+// supported. Returns false on a syntax error or allocation failure.
+bool json_path_compile(const char* expression, JsonPath* out_path);
+
+// Compiles an RFC 6901 pointer such as "/items/0/id". The empty string refers to the whole document.
+bool json_pointer_compile(const char* pointer, JsonPath* out_path);
+
+void json_path_free(JsonPath* path);
+
+// Called with the stream positioned on the first token of a matched value. The callback may consume a matched
+// object or array (for example with json_skip); otherwise the matcher skips it. Returning false stops the scan.
+typedef bool (*JsonPathCallback)(JsonStream* stream, void* context);
+
+typedef struct JsonPathFrame {
+    size_t index;
+    bool is_object;
+    bool pending;
+} JsonPathFrame;
+
+// frames[i] describes the open container at depth i, whose children are matched against steps[i]. Containers that
+// cannot contain a match have no frame; skip_depth marks the one being passed over.
+typedef struct JsonPathMatcher {
+    const JsonPath* path;
+    JsonPathCallback callback;
+    void* context;
+    JsonPathFrame* frames;
+    size_t depth;
+    size_t capacity;
+    size_t skip_depth;
+    size_t match_count;
+    bool stopped;
+} JsonPathMatcher;
+
+void json_path_matcher_init(JsonPathMatcher* matcher, const JsonPath* path, JsonPathCallback callback, void* context);
+
+void json_path_matcher_free(JsonPathMatcher* matcher);
+
+// Processes the token json_read just produced. Returns false when the callback stopped the scan or an error was
+// raised on the stream.
+bool json_path_next(JsonPathMatcher* matcher, JsonStream* stream);
+
+// Reads tokens until the buffer is exhausted, skipping subtrees that cannot match. Returns false on a stream error or
+// when the callback stopped the scan; otherwise the caller continues the stream with more data and calls this again.
+bool json_path_extract(JsonPathMatcher* matcher, JsonStream* stream);
+
+#define JSON_PATH_NO_NODE SIZE_MAX
+
+// One trie node per distinct step prefix. Member names are dispatched through a perfect-hash table; a name can lead to
+// more than one child when a pointer token and a bracket name share it.
+typedef struct JsonPathNode {
+    const JsonPathStep* step;
+    size_t* queries;
+    size_t query_count;
+    size_t* children;
+    size_t child_count;
+    size_t wildcard;
+    const char** names;
+    size_t name_count;
+    size_t* name_offsets;
+    size_t* name_children;
+    JsonPropertyTable name_table;
+} JsonPathNode;
+
+// The paths are borrowed and must outlive the set.
+typedef struct JsonPathSet {
+    const JsonPath* paths;
+    size_t path_count;
+    JsonPathNode* nodes;
+    size_t node_count;
+} JsonPathSet;
+
+bool json_path_set_init(JsonPathSet* set, const JsonPath* paths, size_t path_count);
+
+void json_path_set_free(JsonPathSet* set);
+
+// Called once per query that matches the current value, with query the index into the paths given to the set. The
+// queries matching one value are called in ascending order; when a callback consumes the value, the later ones are not
+// called for it and are counted in skipped_count instead.
+typedef bool (*JsonPathSetCallback)(JsonStream* stream, size_t query, void* context);
+
+typedef struct JsonPathSetFrame {
+    size_t offset;
+    size_t count;
+    size_t index;
+    bool is_object;
+} JsonPathSetFrame;
+
+// Each frame owns a run of the active node stack: the trie nodes its container was reached through. The candidates
+// for the next child are gathered right after the top run, so they become the new frame's run when it is pushed.
+typedef struct JsonPathSetMatcher {
+    const JsonPathSet* set;
+    JsonPathSetCallback callback;
+    void* context;
+    JsonPathSetFrame* frames;
+    size_t depth;
+    size_t capacity;
+    size_t* active;
+    size_t active_capacity;
+    size_t pending_count;
+    size_t skip_depth;
+    size_t match_count;
+    size_t skipped_count;
+    bool stopped;
+} JsonPathSetMatcher;
+
+void json_path_set_matcher_init(
+    JsonPathSetMatcher* matcher,
+    const JsonPathSet* set,
+    JsonPathSetCallback callback,
+    void* context
+);
+
+void json_path_set_matcher_free(JsonPathSetMatcher* matcher);
+
+bool json_path_set_next(JsonPathSetMatcher* matcher, JsonStream* stream);
+
+// Same contract as json_path_extract, evaluating every query of the set in the one pass.
+bool json_path_set_extract(JsonPathSetMatcher* matcher, JsonStream* stream);
+
+#endif // JSON_PATH_H
@@ -0,0 +1,35 @@
+#ifndef JSON_PROPERTY_TABLE_H
+#define JSON_PROPERTY_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "json_stream.h"
+
+#define JSON_PROPERTY_NOT_FOUND (-1)
+
+typedef struct JsonPropertySlot {
+    const char* key;
+    size_t length;
+    int index;
+} JsonPropertySlot;
+
+typedef struct JsonPropertyTable {
+    const char* const* keys;
+    size_t key_count;
+    JsonPropertySlot* slots;
+    size_t slot_mask;
+    uint16_t* displacements;
+    size_t bucket_mask;
+    uint64_t seed;
+} JsonPropertyTable;
+
+bool json_property_table_init(JsonPropertyTable* table, const char* const* keys, size_t key_count);
+
+void json_property_table_free(JsonPropertyTable* table);
+
+int json_property_table_find(const JsonPropertyTable* table, const char* key, size_t length);
+
+int json_match_property(JsonStream* stream, const JsonPropertyTable* table);
+
+#endif // JSON_PROPERTY_TABLE_H
@@ -0,0 +1,53 @@
+#ifndef JSON_PUSH_H
+#define JSON_PUSH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "json_stream.h"
+
+// Each callback runs with the stream positioned on the completed token, so the usual accessors (json_get_string,
+// json_get_double, ...) read its value. The token bytes are only valid for the duration of the call. Returning false
+// stops the parser. Callbacks that are NULL are skipped.
+typedef bool (*JsonPushTokenCallback)(JsonStream* stream, void* context);
+
+typedef struct JsonPushCallbacks {
+    JsonPushTokenCallback on_object_start;
+    JsonPushTokenCallback on_object_end;
+    JsonPushTokenCallback on_array_start;
+    JsonPushTokenCallback on_array_end;
+    JsonPushTokenCallback on_property;
+    JsonPushTokenCallback on_string;
+    JsonPushTokenCallback on_number;
+    JsonPushTokenCallback on_boolean;
+    JsonPushTokenCallback on_null;
+    JsonPushTokenCallback on_comment;
+} JsonPushCallbacks;
+
+// Drives the tokenizer with fragments as they arrive, for example from a non-blocking socket. Only the incomplete
+// token at the end of a fragment is copied into tail; everything else is tokenized in place.
+typedef struct JsonPushParser {
+    JsonStream stream;
+    JsonPushCallbacks callbacks;
+    void* context;
+    char* tail;
+    size_t tail_length;
+    size_t tail_capacity;
+    bool stopped;
+} JsonPushParser;
+
+void json_push_init(JsonPushParser* parser, JsonPushCallbacks callbacks, void* context, JsonStreamOptions options);
+
+void json_push_free(JsonPushParser* parser);
+
+// Prepares the parser for the next document, keeping its callbacks, options and allocations.
+void json_push_reset(JsonPushParser* parser);
+
+// Tokenizes a fragment and fires the callbacks for every token it completes. The fragment does not need to outlive
+// the call. Returns false once a callback stopped the parser or an error was raised on parser->stream.
+bool json_push_feed(JsonPushParser* parser, const char* bytes, size_t length);
+
+// Signals the end of the input, flushing a trailing top-level number and reporting a truncated document as an error.
+bool json_push_finish(JsonPushParser* parser);
+
+#endif // JSON_PUSH_H
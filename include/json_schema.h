@@ -0,0 +1,71 @@
+#ifndef JSON_SCHEMA_H
+#define JSON_SCHEMA_H
+
+#include <stddef.h>
+
+#include "json_stream.h"
+
+typedef enum {
+    JSON_SCHEMA_NULL = 1 << 0,
+    JSON_SCHEMA_BOOLEAN = 1 << 1,
+    JSON_SCHEMA_OBJECT = 1 << 2,
+    JSON_SCHEMA_ARRAY = 1 << 3,
+    JSON_SCHEMA_NUMBER = 1 << 4,
+    JSON_SCHEMA_STRING = 1 << 5,
+    JSON_SCHEMA_INTEGER = 1 << 6,
+    JSON_SCHEMA_ANY = (1 << 7) - 1,
+} JsonSchemaType;
+
+struct JsonSchema;
+
+typedef struct JsonSchemaProperty {
+    char* name;
+    size_t name_length;
+    bool required;
+    struct JsonSchema* schema;
+} JsonSchemaProperty;
+
+typedef struct JsonSchemaEnumValue {
+    JsonType type;
+    // Unescaped text for strings, the raw token otherwise.
+    char* text;
+    size_t length;
+} JsonSchemaEnumValue;
+
+typedef struct JsonSchema {
+    unsigned types;
+    char* title;
+    char* format;
+
+    JsonSchemaProperty* properties;
+    size_t property_count;
+    bool additional_properties;
+
+    struct JsonSchema* items;
+    size_t min_items;
+    size_t max_items;
+
+    bool has_minimum;
+    bool exclusive_minimum;
+    double minimum;
+    bool has_maximum;
+    bool exclusive_maximum;
+    double maximum;
+
+    size_t min_length;
+    size_t max_length;
+    char* pattern;
+
+    JsonSchemaEnumValue* enum_values;
+    size_t enum_count;
+} JsonSchema;
+
+// Parses the schema document starting at the next token of stream. Keywords outside the supported subset are
+// skipped; $ref and combinators (allOf, anyOf, ...) are ignored.
+bool json_schema_parse(JsonStream* stream, JsonSchema** out_schema);
+
+void json_schema_free(JsonSchema* schema);
+
+const JsonSchemaProperty* json_schema_find_property(const JsonSchema* schema, const char* name, size_t length);
+
+#endif // JSON_SCHEMA_H
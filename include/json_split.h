@@ -0,0 +1,23 @@
+#ifndef JSON_SPLIT_H
+#define JSON_SPLIT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Receives the span [start, end) of one top-level value. Returning false stops the split.
+typedef bool (*JsonSplitCallback)(size_t start, size_t end, void* context);
+
+// Finds the top-level values of concatenated JSON, as json_stream_options.allow_multiple_values reads it, without
+// tokenizing: only strings, escapes and bracket depth are tracked, so malformed values are left for the reader to
+// reject. Comments are not recognized. When is_final_block is false, a value still open at the end of the buffer is
+// not reported, nor is a number or literal that reaches it. Returns the end of the last value reported, which is where
+// a caller splitting a stream in chunks continues from.
+size_t json_split_values(
+    const char* buffer,
+    size_t size,
+    bool is_final_block,
+    JsonSplitCallback callback,
+    void* context
+);
+
+#endif // JSON_SPLIT_H
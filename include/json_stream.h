@@ -26,6 +26,12 @@ typedef enum {
     JSON_COMMENT_ALLOW,
 } JsonCommentHandling;
 
+typedef enum {
+    JSON_UTF8_VALIDATION_NONE,
+    JSON_UTF8_VALIDATION_TOKENS,
+    JSON_UTF8_VALIDATION_BUFFER,
+} JsonUtf8Validation;
+
 typedef enum {
     JSON_ERROR_NONE,
     JSON_ERROR_NOT_IMPLEMENTED,
@@ -68,6 +74,15 @@ typedef enum {
     JSON_ERROR_INVALID_OPERATION_CANNOT_SKIP_ON_PARTIAL,
     JSON_ERROR_INVALID_OPERATION_EXPECTED_STRING_COMPARISON,
     JSON_ERROR_STRING_PARSE_FAILED,
+    JSON_ERROR_INVALID_UTF8,
+    JSON_ERROR_INVALID_UTF16_SURROGATE,
+    JSON_ERROR_REQUIRED_PROPERTY_NOT_FOUND,
+    JSON_ERROR_INVALID_SCHEMA,
+    JSON_ERROR_SCHEMA_VIOLATION,
+    JSON_ERROR_INVALID_CHECKPOINT,
+    JSON_ERROR_READ_FAILED,
+    JSON_ERROR_WRITE_FAILED,
+    JSON_ERROR_INVALID_TAPE,
 
     JSON_ERROR_INVALID_OPERATION_EXPECTED_STRING,
     JSON_ERROR_INVALID_OPERATION_EXPECTED_COMMENT,
@@ -151,19 +166,48 @@ typedef struct JsonStream {
 
     bool value_is_escaped;
     bool allow_multiple_values;
+    JsonUtf8Validation validate_utf8;
+    bool buffer_utf8_validated;
+
+    // Progress on a string that did not end in a partial buffer, keyed by the document offset of its opening quote.
+    size_t partial_string_start;
+    size_t partial_string_scanned;
+    bool partial_string_escaped;
+
+    // Receives escaped values for json_try_get_text. It grows geometrically and survives json_stream_reset.
+    char* scratch;
+    size_t scratch_capacity;
+
+    // Set by json_stream_init_tape: json_read replays these tokens instead of tokenizing the buffer.
+    const struct JsonTapeToken* tape;
+    size_t tape_count;
+    size_t tape_index;
 } JsonStream;
 
 typedef struct JsonStreamOptions {
     bool allow_trailing_commas;
     bool allow_multiple_values;
     JsonCommentHandling comment_handling;
+    JsonUtf8Validation validate_utf8;
     size_t max_depth;
     void (*error_handler)(struct JsonStream* stream, JsonError* error, void* error_context);
     void* error_context;
 } JsonStreamOptions;
 
+// A string or property as it appears in the buffer, without its quotes. When needs_unescape is false, ptr and len are
+// already the value; otherwise json_string_view_unescape produces it. Views are only valid while the buffer is.
+typedef struct JsonStringView {
+    const char* ptr;
+    size_t len;
+    bool needs_unescape;
+} JsonStringView;
+
 void json_stream_init(JsonStream* stream, const char* buffer, size_t buffer_size, bool is_final_block, JsonStreamOptions options);
 
+// Starts a new document on an initialized stream. The options and the bit stack's allocation are kept, so parsing a
+// stream of small documents this way allocates nothing once the deepest nesting has been seen.
+void json_stream_reset(JsonStream* stream, const char* buffer, size_t buffer_size, bool is_final_block);
+
 void json_stream_continue(JsonStream* stream, JsonStream* old, const char* buffer, size_t buffer_size, bool is_final_block);
 
 void json_stream_free_resources(JsonStream* stream);
@@ -230,6 +274,42 @@ bool json_try_get_property(JsonStream* stream, const char** out_property, size_t
 
 bool json_try_read_property(JsonStream* stream, const char** out_property, size_t* out_length);
 
+// Returns the value of a string or property without allocating. Text without escapes points into the buffer and is
+// not NUL-terminated; escaped text is unescaped into the stream's scratch buffer, NUL-terminated, and stays valid until
+// the next escaped text is requested.
+const char* json_get_text(JsonStream* stream, size_t* out_length);
+
+const char* json_read_text(JsonStream* stream, size_t* out_length);
+
+bool json_try_get_text(JsonStream* stream, const char** out_text, size_t* out_length);
+
+bool json_try_read_text(JsonStream* stream, const char** out_text, size_t* out_length);
+
+JsonStringView json_get_string_view(JsonStream* stream);
+
+JsonStringView json_read_string_view(JsonStream* stream);
+
+bool json_try_get_string_view(JsonStream* stream, JsonStringView* out_view);
+
+bool json_try_read_string_view(JsonStream* stream, JsonStringView* out_view);
+
+// Reads the remaining values of the current array into views, stopping after the array's end, once capacity views
+// are filled, or in front of a value that is not a string or null (which then stays to be read, as with
+// json_try_read_string). Nulls give an empty view with a NULL ptr. Returns true when it stopped after the end or at
+// capacity, so the caller loops until json_token_type is JSON_TYPE_ARRAY_END. On false, the views filled so far are
+// still valid, and a partial buffer that ran out is continued as usual.
+bool json_try_read_string_views(JsonStream* stream, JsonStringView* views, size_t capacity, size_t* out_count);
+
+// Unescapes a view taken from the current buffer. Returns false when the destination is too small or the view holds
+// an invalid escape.
+bool json_string_view_unescape(
+    JsonStream* stream,
+    JsonStringView view,
+    char* destination,
+    size_t destination_length,
+    size_t* out_length
+);
+
 const char* json_get_comment(JsonStream* stream, size_t* out_length);
 
 const char* json_read_comment(JsonStream* stream, size_t* out_length);
@@ -334,6 +414,17 @@ bool json_read_array_end(JsonStream* stream);
 
 bool json_try_read_array_end(JsonStream* stream);
 
+// Batch readers for homogeneous arrays. Starting after the array's start or one of its values, they store values until
+// the array ends (the stream is then on its JSON_TYPE_ARRAY_END) or capacity values are stored, and return true. A
+// partial buffer that runs out returns false without an error; the values stored so far are counted, and the next call
+// after json_stream_continue carries on. A value of another type, or for i64 a number that is not an integer in range,
+// raises JSON_ERROR_INVALID_OPERATION_EXPECTED_* and is left to be read again.
+bool json_read_array_i64(JsonStream* stream, int64_t* values, size_t capacity, size_t* out_count);
+
+bool json_read_array_double(JsonStream* stream, double* values, size_t capacity, size_t* out_count);
+
+bool json_read_array_bool(JsonStream* stream, bool* values, size_t capacity, size_t* out_count);
+
 bool json_read_object_start(JsonStream* stream);
 
 bool json_try_read_object_start(JsonStream* stream);
@@ -344,6 +435,8 @@ bool json_try_read_object_end(JsonStream* stream);
 
 void json_clear_error(JsonStream* stream);
 
+void json_raise_error(JsonStream* stream, JsonErrorType type, const char* string);
+
 bool json_error_get_message(const JsonError* error, char* buffer, size_t buffer_length);
 
 static inline bool json_has_error(JsonStream* stream);
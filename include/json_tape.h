@@ -0,0 +1,72 @@
+#ifndef JSON_TAPE_H
+#define JSON_TAPE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "json_stream.h"
+
+#define JSON_TAPE_VERSION 1
+#define JSON_TAPE_HEADER_SIZE 48
+
+#define JSON_TAPE_ESCAPED (1 << 0)
+
+// One token as json_read produced it. integer and real hold what json_get_i64 and json_get_double return for numbers.
+// depth is json_current_depth at the token, so a container's start and end share the depth of their parent's values.
+typedef struct JsonTapeToken {
+    uint64_t start;
+    uint64_t consumed;
+    int64_t integer;
+    double real;
+    uint64_t size;
+    uint32_t depth;
+    uint8_t type;
+    uint8_t flags;
+} JsonTapeToken;
+
+// A tokenized document followed by a copy of its bytes. Unlike checkpoints, tapes use the host's byte order and struct
+// layout so that a mapped file is used in place; json_tape_map rejects tapes written by a different layout.
+typedef struct JsonTape {
+    const JsonTapeToken* tokens;
+    size_t token_count;
+    const char* document;
+    size_t document_length;
+    void* memory;
+    size_t memory_length;
+    // The bytes json_tape_build or json_tape_edit tokenized to produce the tape.
+    size_t tokenized_length;
+    bool mapped;
+} JsonTape;
+
+// Records every token of a stream that holds the complete document, from its current position on.
+bool json_tape_build(JsonTape* tape, JsonStream* stream);
+
+// Builds the tape of a document that differs from previous's by one edit: removed_length bytes at offset were replaced
+// by inserted_length bytes. stream holds the whole edited document and has the options previous was built with. In the
+// innermost container enclosing the edit, tokenizing starts after the last element ending before the edit and stops at
+// the first element after it whose token lines up with previous's; the tokens in between are spliced into a copy of
+// previous. When the edit changes that container's extent or kind, or is not inside any container, the document is
+// read from stream in full as json_tape_build does.
+bool json_tape_edit(
+    JsonTape* tape,
+    const JsonTape* previous,
+    JsonStream* stream,
+    size_t offset,
+    size_t removed_length,
+    size_t inserted_length
+);
+
+bool json_tape_save(const JsonTape* tape, const char* path);
+
+// Maps a saved tape read-only and shared, so processes replaying the same file share its pages. Every token is checked
+// once against the document and the token before it, so a corrupt tape is rejected here.
+bool json_tape_map(JsonTape* tape, const char* path);
+
+void json_tape_free(JsonTape* tape);
+
+// Initializes a stream that replays the tape: json_read serves the recorded tokens without tokenizing, the getters read
+// the tape's copy of the document, and numbers come pre-parsed. Line numbers are not tracked. The tape must outlive
+// the stream.
+void json_stream_init_tape(JsonStream* stream, const JsonTape* tape, JsonStreamOptions options);
+
+#endif // JSON_TAPE_H
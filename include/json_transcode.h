@@ -0,0 +1,62 @@
+#ifndef JSON_TRANSCODE_H
+#define JSON_TRANSCODE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "json_stream.h"
+
+typedef enum {
+    JSON_TRANSCODE_CBOR,
+    JSON_TRANSCODE_MSGPACK,
+} JsonTranscodeFormat;
+
+// Receives the encoded bytes in order. Returning false raises JSON_ERROR_WRITE_FAILED on the stream.
+typedef bool (*JsonTranscodeWrite)(const void* bytes, size_t length, void* context);
+
+typedef struct JsonTranscodeContainer {
+    size_t header;
+    uint32_t count;
+    bool is_object;
+} JsonTranscodeContainer;
+
+// Converts the token stream into CBOR or MessagePack. Integers that fit 64 bits keep their exact value and every other
+// number becomes a double, or raises JSON_ERROR_INVALID_OPERATION_EXPECTED_DOUBLE when it overflows one; comments are
+// dropped. CBOR containers use indefinite lengths, so its output is handed to write whenever JSON_TRANSCODE_FLUSH_SIZE
+// bytes are pending. MessagePack needs the element count in front of each container: a 32-bit count is reserved and
+// patched, and shrunk to the smallest header, when the container ends. Output is therefore held back from the start of
+// the outermost open container until that container ends.
+typedef struct JsonTranscoder {
+    JsonTranscodeFormat format;
+    JsonTranscodeWrite write;
+    void* context;
+    uint8_t* output;
+    size_t output_length;
+    size_t output_capacity;
+    JsonTranscodeContainer* containers;
+    size_t depth;
+    size_t container_capacity;
+} JsonTranscoder;
+
+#define JSON_TRANSCODE_FLUSH_SIZE 4096
+
+void json_transcoder_init(
+    JsonTranscoder* transcoder,
+    JsonTranscodeFormat format,
+    JsonTranscodeWrite write,
+    void* context
+);
+
+void json_transcoder_free(JsonTranscoder* transcoder);
+
+// Encodes tokens until json_read returns false and writes the output that is final by then. With a partial buffer the
+// transcoder picks up where it left off once the stream has been continued. Returns false when an error was raised on
+// the stream.
+bool json_transcode(JsonTranscoder* transcoder, JsonStream* stream);
+
+// Convert the rest of a stream on its final block in one call.
+bool json_transcode_to_cbor(JsonStream* stream, JsonTranscodeWrite write, void* context);
+
+bool json_transcode_to_msgpack(JsonStream* stream, JsonTranscodeWrite write, void* context);
+
+#endif // JSON_TRANSCODE_H
@@ -0,0 +1,45 @@
+#ifndef JSON_VALIDATOR_H
+#define JSON_VALIDATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "json_schema.h"
+#include "json_stream.h"
+
+typedef struct JsonValidatorFrame {
+    // NULL when the container is unconstrained; its contents are then accepted without checks.
+    const JsonSchema* schema;
+    const JsonSchema* pending;
+    bool is_object;
+    size_t count;
+    size_t seen_offset;
+} JsonValidatorFrame;
+
+typedef struct JsonValidator {
+    const JsonSchema* schema;
+    JsonValidatorFrame* frames;
+    size_t depth;
+    size_t capacity;
+    uint64_t* seen;
+    size_t seen_count;
+    size_t seen_capacity;
+    bool complete;
+} JsonValidator;
+
+void json_validator_init(JsonValidator* validator, const JsonSchema* schema);
+
+void json_validator_free(JsonValidator* validator);
+
+// Checks the token json_read just produced. On the first violation the stream error is set (JSON_ERROR_SCHEMA_VIOLATION
+// with the failing keyword, or JSON_ERROR_REQUIRED_PROPERTY_NOT_FOUND with the property name) and false is returned.
+bool json_validator_next(JsonValidator* validator, JsonStream* stream);
+
+static inline bool json_validator_is_complete(const JsonValidator* validator) {
+    return validator->complete;
+}
+
+// Reads and validates one complete value.
+bool json_validate(JsonStream* stream, const JsonSchema* schema);
+
+#endif // JSON_VALIDATOR_H
@@ -23,7 +23,7 @@ static bool json_z_bits_push_current(JsonBitStack* bits) {
 }
 
 static void json_z_bits_pop_current(JsonBitStack* bits) {
-    size_t index = ((bits->count - 63) / 63) - 1;
+    size_t index = (bits->count - 63) / 63;
     bits->current = bits->array[index];
 }
 
@@ -44,6 +44,13 @@ void json_z_bits_clear(JsonBitStack *bits) {
     bits->capacity = 0;
 }
 
+void json_z_bits_reset(JsonBitStack *bits) {
+    assert(bits);
+
+    bits->current = 1;
+    bits->count = 0;
+}
+
 bool json_z_bits_push(JsonBitStack *bits, bool value) {
     if ((bits->current & 0x8000000000000000) != 0) {
         if (!json_z_bits_push_current(bits)) {
@@ -75,3 +82,15 @@ bool json_z_bits_pop(JsonBitStack *bits) {
 size_t json_z_bits_count(const JsonBitStack* bits) {
     return bits->count;
 }
+
+bool json_z_bits_get(const JsonBitStack* bits, size_t index) {
+    assert(index < bits->count);
+
+    // Full words hold 63 bits below their marker bit, oldest first; current holds the remainder.
+    size_t words = bits->count > 63 ? (bits->count - 1) / 63 : 0;
+    if (index / 63 < words) {
+        return (bits->array[index / 63] >> (62 - index % 63)) & 1;
+    }
+
+    return (bits->current >> (bits->count - 1 - index)) & 1;
+}
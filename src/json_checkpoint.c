@@ -0,0 +1,213 @@
+#include "json_checkpoint.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "json_internal.h"
+
+#define JSON_CHECKPOINT_MAGIC "JSCP"
+#define JSON_SEEK_INDEX_POINT_STEP 16
+
+#define JSON_CHECKPOINT_IN_OBJECT (1 << 0)
+#define JSON_CHECKPOINT_IS_NOT_PRIMITIVE (1 << 1)
+#define JSON_CHECKPOINT_TRAILING_COMMA (1 << 2)
+#define JSON_CHECKPOINT_ALLOW_TRAILING_COMMAS (1 << 3)
+#define JSON_CHECKPOINT_ALLOW_MULTIPLE_VALUES (1 << 4)
+
+static void json_checkpoint_put_u64(unsigned char* out, uint64_t value) {
+    for (size_t i = 0; i < 8; i++) {
+        out[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+static uint64_t json_checkpoint_get_u64(const unsigned char* in) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < 8; i++) {
+        value |= (uint64_t)in[i] << (8 * i);
+    }
+    return value;
+}
+
+size_t json_stream_checkpoint(const JsonStream* stream, void* buffer, size_t buffer_length) {
+    size_t depth = json_z_bits_count(&stream->bits);
+    size_t size = JSON_CHECKPOINT_HEADER_SIZE + (depth + 7) / 8;
+    if (buffer_length < size) {
+        return size;
+    }
+
+    unsigned char* out = buffer;
+    memcpy(out, JSON_CHECKPOINT_MAGIC, 4);
+    out[4] = JSON_CHECKPOINT_VERSION;
+    out[5] = (unsigned char)((stream->in_object ? JSON_CHECKPOINT_IN_OBJECT : 0)
+                             | (stream->is_not_primitive ? JSON_CHECKPOINT_IS_NOT_PRIMITIVE : 0)
+                             | (stream->trailing_comma ? JSON_CHECKPOINT_TRAILING_COMMA : 0)
+                             | (stream->allow_trailing_commas ? JSON_CHECKPOINT_ALLOW_TRAILING_COMMAS : 0)
+                             | (stream->allow_multiple_values ? JSON_CHECKPOINT_ALLOW_MULTIPLE_VALUES : 0));
+    out[6] = (unsigned char)stream->token_type;
+    out[7] = (unsigned char)stream->previous_token_type;
+    out[8] = (unsigned char)stream->comment_handling;
+    out[9] = (unsigned char)stream->validate_utf8;
+    out[10] = 0;
+    out[11] = 0;
+    json_checkpoint_put_u64(out + 12, stream->total_consumed + stream->consumed);
+    json_checkpoint_put_u64(out + 20, stream->line_number);
+    json_checkpoint_put_u64(out + 28, stream->byte_position_in_line);
+    json_checkpoint_put_u64(out + 36, stream->max_depth);
+    json_checkpoint_put_u64(out + 44, depth);
+
+    unsigned char* bits = out + JSON_CHECKPOINT_HEADER_SIZE;
+    memset(bits, 0, (depth + 7) / 8);
+    for (size_t i = 0; i < depth; i++) {
+        if (json_z_bits_get(&stream->bits, i)) {
+            bits[i / 8] |= (unsigned char)(1 << (i % 8));
+        }
+    }
+
+    return size;
+}
+
+static bool json_checkpoint_invalid(JsonStream* stream) {
+    json_throw(stream, JSON_ERROR_INVALID_CHECKPOINT);
+    return false;
+}
+
+bool json_stream_restore(JsonStream* stream, const void* checkpoint, size_t checkpoint_length) {
+    const unsigned char* in = checkpoint;
+    if (checkpoint_length < JSON_CHECKPOINT_HEADER_SIZE || memcmp(in, JSON_CHECKPOINT_MAGIC, 4) != 0
+        || in[4] != JSON_CHECKPOINT_VERSION)
+    {
+        return json_checkpoint_invalid(stream);
+    }
+
+    uint64_t max_depth = json_checkpoint_get_u64(in + 36);
+    uint64_t depth = json_checkpoint_get_u64(in + 44);
+    if (in[6] > JSON_TYPE_COMMENT || in[7] > JSON_TYPE_COMMENT || in[8] > JSON_COMMENT_ALLOW
+        || in[9] > JSON_UTF8_VALIDATION_BUFFER || depth > max_depth || max_depth > SIZE_MAX
+        || checkpoint_length - JSON_CHECKPOINT_HEADER_SIZE < (depth + 7) / 8)
+    {
+        return json_checkpoint_invalid(stream);
+    }
+
+    const unsigned char* bits = in + JSON_CHECKPOINT_HEADER_SIZE;
+    bool in_object = (in[5] & JSON_CHECKPOINT_IN_OBJECT) != 0;
+    if (depth > 0 && ((bits[(depth - 1) / 8] >> ((depth - 1) % 8)) & 1) != in_object) {
+        return json_checkpoint_invalid(stream);
+    }
+
+    json_z_bits_clear(&stream->bits);
+    for (size_t i = 0; i < depth; i++) {
+        if (!json_z_bits_push(&stream->bits, (bits[i / 8] >> (i % 8)) & 1)) {
+            json_throw(stream, JSON_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+    }
+
+    stream->in_object = in_object;
+    stream->is_not_primitive = (in[5] & JSON_CHECKPOINT_IS_NOT_PRIMITIVE) != 0;
+    stream->trailing_comma = (in[5] & JSON_CHECKPOINT_TRAILING_COMMA) != 0;
+    stream->allow_trailing_commas = (in[5] & JSON_CHECKPOINT_ALLOW_TRAILING_COMMAS) != 0;
+    stream->allow_multiple_values = (in[5] & JSON_CHECKPOINT_ALLOW_MULTIPLE_VALUES) != 0;
+    stream->token_type = (JsonType)in[6];
+    stream->previous_token_type = (JsonType)in[7];
+    stream->comment_handling = (JsonCommentHandling)in[8];
+    stream->validate_utf8 = (JsonUtf8Validation)in[9];
+    stream->total_consumed = (size_t)json_checkpoint_get_u64(in + 12);
+    stream->line_number = (size_t)json_checkpoint_get_u64(in + 20);
+    stream->byte_position_in_line = (size_t)json_checkpoint_get_u64(in + 28);
+    stream->max_depth = (size_t)max_depth;
+    stream->consumed = 0;
+    stream->token_start = 0;
+    stream->token_size = 0;
+    stream->value_is_escaped = false;
+    stream->buffer_utf8_validated = false;
+    stream->partial_string_start = SIZE_MAX;
+    return true;
+}
+
+static bool json_seek_index_add(JsonSeekIndex* index, JsonStream* stream) {
+    if (index->point_count == index->point_capacity) {
+        size_t capacity = index->point_capacity ? index->point_capacity * 2 : JSON_SEEK_INDEX_POINT_STEP;
+        JsonSeekPoint* points = realloc(index->points, capacity * sizeof(JsonSeekPoint));
+        if (!points) {
+            json_throw(stream, JSON_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+        index->points = points;
+        index->point_capacity = capacity;
+    }
+
+    size_t size = json_stream_checkpoint(stream, NULL, 0);
+    if (index->data_capacity - index->data_length < size) {
+        size_t capacity = index->data_capacity ? index->data_capacity : JSON_SEEK_INDEX_POINT_STEP * size;
+        while (capacity - index->data_length < size) {
+            capacity *= 2;
+        }
+        unsigned char* data = realloc(index->data, capacity);
+        if (!data) {
+            json_throw(stream, JSON_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+        index->data = data;
+        index->data_capacity = capacity;
+    }
+
+    JsonSeekPoint* point = &index->points[index->point_count++];
+    point->offset = json_total_bytes_consumed(stream);
+    point->checkpoint = index->data_length;
+    point->checkpoint_length = json_stream_checkpoint(stream, index->data + index->data_length, size);
+    index->data_length += size;
+    index->next_offset = point->offset + index->interval;
+    return true;
+}
+
+bool json_seek_index_init(JsonSeekIndex* index, JsonStream* stream, size_t interval, size_t depth) {
+    memset(index, 0, sizeof(JsonSeekIndex));
+    index->interval = interval;
+    index->depth = depth;
+    return json_seek_index_add(index, stream);
+}
+
+void json_seek_index_free(JsonSeekIndex* index) {
+    free(index->points);
+    free(index->data);
+    memset(index, 0, sizeof(JsonSeekIndex));
+}
+
+bool json_seek_index_update(JsonSeekIndex* index, JsonStream* stream) {
+    if (json_total_bytes_consumed(stream) < index->next_offset || json_current_depth(stream) > index->depth) {
+        return true;
+    }
+
+    // Only the end of a value is a boundary; after a property or an opening bracket the value is still to come.
+    switch (stream->token_type) {
+        case JSON_TYPE_OBJECT_END:
+        case JSON_TYPE_ARRAY_END:
+        case JSON_TYPE_STRING:
+        case JSON_TYPE_NUMBER:
+        case JSON_TYPE_BOOLEAN:
+        case JSON_TYPE_NULL:
+            return json_seek_index_add(index, stream);
+        default:
+            return true;
+    }
+}
+
+bool json_stream_seek(JsonStream* stream, const JsonSeekIndex* index, size_t offset) {
+    if (index->point_count == 0) {
+        return json_checkpoint_invalid(stream);
+    }
+
+    size_t low = 1;
+    size_t high = index->point_count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (index->points[middle].offset <= offset) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    const JsonSeekPoint* point = &index->points[low - 1];
+    return json_stream_restore(stream, index->data + point->checkpoint, point->checkpoint_length);
+}
@@ -0,0 +1,327 @@
+#include "json_columns.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "json_internal.h"
+
+#define JSON_COLUMNS_ROW_STEP 64
+
+static size_t json_column_value_size(JsonColumnType type) {
+    switch (type) {
+        case JSON_COLUMN_BOOL:
+            return sizeof(bool);
+        case JSON_COLUMN_I64:
+            return sizeof(int64_t);
+        case JSON_COLUMN_DOUBLE:
+            return sizeof(double);
+        case JSON_COLUMN_STRING:
+            return sizeof(size_t);
+    }
+
+    return 0;
+}
+
+bool json_columns_init(JsonColumns* columns, const JsonColumnDescriptor* descriptors, size_t descriptor_count) {
+    memset(columns, 0, sizeof(JsonColumns));
+    columns->column_count = descriptor_count;
+    columns->columns = calloc(descriptor_count + 1, sizeof(JsonColumn));
+    columns->names = malloc((descriptor_count + 1) * sizeof(const char*));
+    columns->seen = calloc((descriptor_count + 63) / 64 + 1, sizeof(uint64_t));
+    if (!columns->columns || !columns->names || !columns->seen) {
+        json_columns_free(columns);
+        return false;
+    }
+
+    for (size_t i = 0; i < descriptor_count; i++) {
+        columns->columns[i].name = descriptors[i].name;
+        columns->columns[i].type = descriptors[i].type;
+        columns->names[i] = descriptors[i].name;
+    }
+
+    if (!json_property_table_init(&columns->table, columns->names, descriptor_count)) {
+        json_columns_free(columns);
+        return false;
+    }
+
+    return true;
+}
+
+void json_columns_free(JsonColumns* columns) {
+    if (columns->columns) {
+        for (size_t i = 0; i < columns->column_count; i++) {
+            free(columns->columns[i].values);
+            free(columns->columns[i].validity);
+            free(columns->columns[i].data);
+        }
+    }
+
+    json_property_table_free(&columns->table);
+    free(columns->columns);
+    free(columns->names);
+    free(columns->seen);
+    columns->columns = NULL;
+    columns->names = NULL;
+    columns->seen = NULL;
+    columns->column_count = 0;
+    columns->row_count = 0;
+    columns->row_capacity = 0;
+}
+
+void json_columns_clear(JsonColumns* columns) {
+    columns->row_count = 0;
+    for (size_t i = 0; i < columns->column_count; i++) {
+        columns->columns[i].null_count = 0;
+        columns->columns[i].data_length = 0;
+    }
+}
+
+static bool json_columns_reserve_rows(JsonStream* stream, JsonColumns* columns, size_t rows) {
+    if (rows <= columns->row_capacity) {
+        return true;
+    }
+
+    size_t capacity = columns->row_capacity ? columns->row_capacity * 2 : JSON_COLUMNS_ROW_STEP;
+    while (capacity < rows) {
+        capacity *= 2;
+    }
+
+    for (size_t i = 0; i < columns->column_count; i++) {
+        JsonColumn* column = &columns->columns[i];
+        // String offsets need one more entry than there are rows.
+        size_t count = column->type == JSON_COLUMN_STRING ? capacity + 1 : capacity;
+        void* values = realloc(column->values, count * json_column_value_size(column->type));
+        if (!values) {
+            json_throw(stream, JSON_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+        column->values = values;
+        if (column->type == JSON_COLUMN_STRING && columns->row_capacity == 0) {
+            ((size_t*)values)[0] = 0;
+        }
+
+        uint8_t* validity = realloc(column->validity, (capacity + 7) / 8);
+        if (!validity) {
+            json_throw(stream, JSON_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+        size_t used = (columns->row_capacity + 7) / 8;
+        memset(validity + used, 0, (capacity + 7) / 8 - used);
+        column->validity = validity;
+    }
+
+    columns->row_capacity = capacity;
+    return true;
+}
+
+static bool json_column_append_data(JsonStream* stream, JsonColumn* column, const char* text, size_t length) {
+    if (column->data_length + length > column->data_capacity) {
+        size_t capacity = column->data_capacity ? column->data_capacity : JSON_COLUMNS_ROW_STEP;
+        while (capacity < column->data_length + length) {
+            capacity *= 2;
+        }
+
+        char* data = realloc(column->data, capacity);
+        if (!data) {
+            json_throw(stream, JSON_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+        column->data = data;
+        column->data_capacity = capacity;
+    }
+
+    memcpy(column->data + column->data_length, text, length);
+    column->data_length += length;
+    return true;
+}
+
+static void json_column_set_valid(JsonColumn* column, size_t row, bool valid) {
+    if (valid) {
+        column->validity[row / 8] |= (uint8_t)(1u << (row % 8));
+    } else {
+        column->validity[row / 8] &= (uint8_t)~(1u << (row % 8));
+    }
+}
+
+static void json_column_set_null(JsonColumn* column, size_t row) {
+    json_column_set_valid(column, row, false);
+    switch (column->type) {
+        case JSON_COLUMN_BOOL:
+            ((bool*)column->values)[row] = false;
+            break;
+        case JSON_COLUMN_I64:
+            ((int64_t*)column->values)[row] = 0;
+            break;
+        case JSON_COLUMN_DOUBLE:
+            ((double*)column->values)[row] = 0;
+            break;
+        case JSON_COLUMN_STRING: {
+            size_t* offsets = column->values;
+            column->data_length = offsets[row];
+            offsets[row + 1] = offsets[row];
+            break;
+        }
+    }
+}
+
+// Reads the next token other than a comment.
+static bool json_columns_next(JsonStream* stream) {
+    while (json_read(stream)) {
+        if (stream->token_type != JSON_TYPE_COMMENT) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool json_column_store(JsonStream* stream, JsonColumn* column, size_t row) {
+    if (stream->token_type == JSON_TYPE_NULL) {
+        json_column_set_null(column, row);
+        return true;
+    }
+
+    switch (column->type) {
+        case JSON_COLUMN_BOOL:
+            ((bool*)column->values)[row] = json_get_bool(stream);
+            break;
+        case JSON_COLUMN_I64:
+            ((int64_t*)column->values)[row] = json_get_i64(stream);
+            break;
+        case JSON_COLUMN_DOUBLE:
+            ((double*)column->values)[row] = json_get_double(stream);
+            break;
+        case JSON_COLUMN_STRING: {
+            const char* text;
+            size_t length;
+            if (!json_try_get_text(stream, &text, &length)) {
+                if (stream->error.type == JSON_ERROR_NONE) {
+                    json_throw(stream, JSON_ERROR_INVALID_OPERATION_EXPECTED_STRING);
+                }
+                return false;
+            }
+
+            // A repeated key replaces the row's earlier value.
+            size_t* offsets = column->values;
+            column->data_length = offsets[row];
+            if (!json_column_append_data(stream, column, text, length)) {
+                return false;
+            }
+            offsets[row + 1] = column->data_length;
+            break;
+        }
+    }
+
+    if (stream->error.type != JSON_ERROR_NONE) {
+        return false;
+    }
+
+    json_column_set_valid(column, row, true);
+    return true;
+}
+
+static bool json_columns_read_object(JsonStream* stream, JsonColumns* columns) {
+    if (!json_columns_reserve_rows(stream, columns, columns->row_count + 1)) {
+        return false;
+    }
+
+    size_t row = columns->row_count;
+    memset(columns->seen, 0, (columns->column_count + 63) / 64 * sizeof(uint64_t));
+    for (size_t i = 0; i < columns->column_count; i++) {
+        if (columns->columns[i].type == JSON_COLUMN_STRING) {
+            size_t* offsets = columns->columns[i].values;
+            offsets[row + 1] = offsets[row];
+        }
+    }
+
+    while (json_columns_next(stream)) {
+        if (stream->token_type == JSON_TYPE_OBJECT_END) {
+            for (size_t i = 0; i < columns->column_count; i++) {
+                JsonColumn* column = &columns->columns[i];
+                if (!(columns->seen[i / 64] & (1ULL << (i % 64)))) {
+                    json_column_set_null(column, row);
+                }
+                if (!json_column_is_valid(column, row)) {
+                    column->null_count++;
+                }
+            }
+
+            columns->row_count++;
+            return true;
+        }
+
+        int index = json_match_property(stream, &columns->table);
+        if (index == JSON_PROPERTY_NOT_FOUND) {
+            if (stream->error.type != JSON_ERROR_NONE || !json_skip(stream)) {
+                break;
+            }
+            continue;
+        }
+
+        if (!json_columns_next(stream) || !json_column_store(stream, &columns->columns[index], row)) {
+            break;
+        }
+        columns->seen[index / 64] |= 1ULL << (index % 64);
+    }
+
+    // Drop the string bytes of the incomplete row.
+    for (size_t i = 0; i < columns->column_count; i++) {
+        if (columns->columns[i].type == JSON_COLUMN_STRING) {
+            columns->columns[i].data_length = ((size_t*)columns->columns[i].values)[row];
+        }
+    }
+
+    return false;
+}
+
+bool json_columns_read_row(JsonStream* stream, JsonColumns* columns) {
+    if (stream->token_type != JSON_TYPE_OBJECT_START && !json_columns_next(stream)) {
+        return false;
+    }
+
+    if (stream->token_type != JSON_TYPE_OBJECT_START) {
+        json_throw_string(
+            stream,
+            JSON_ERROR_INVALID_OPERATION_EXPECTED_OBJECT_START,
+            json_token_type_name(stream->token_type)
+        );
+        return false;
+    }
+
+    return json_columns_read_object(stream, columns);
+}
+
+bool json_columns_read(JsonStream* stream, JsonColumns* columns) {
+    if (stream->token_type != JSON_TYPE_ARRAY_START && !json_columns_next(stream)) {
+        return false;
+    }
+
+    if (stream->token_type != JSON_TYPE_ARRAY_START) {
+        json_throw_string(
+            stream,
+            JSON_ERROR_INVALID_OPERATION_EXPECTED_ARRAY_START,
+            json_token_type_name(stream->token_type)
+        );
+        return false;
+    }
+
+    while (json_columns_next(stream)) {
+        if (stream->token_type == JSON_TYPE_ARRAY_END) {
+            return true;
+        }
+
+        if (stream->token_type != JSON_TYPE_OBJECT_START) {
+            json_throw_string(
+                stream,
+                JSON_ERROR_INVALID_OPERATION_EXPECTED_OBJECT_START,
+                json_token_type_name(stream->token_type)
+            );
+            return false;
+        }
+
+        if (!json_columns_read_object(stream, columns)) {
+            return false;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,411 @@
+// O_CLOEXEC and S_ISREG are not part of ISO C.
+#define _GNU_SOURCE
+
+#include "json_decompress.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "json_internal.h"
+
+#if defined(JSON_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+
+#if defined(JSON_HAVE_ZSTD)
+#include <zstd.h>
+#endif
+
+bool json_decompressor_init(JsonDecompressor* decompressor, size_t window_size, size_t thread_threshold) {
+    memset(decompressor, 0, sizeof(JsonDecompressor));
+    decompressor->fd = -1;
+    decompressor->current = JSON_DECOMPRESSOR_NO_BLOCK;
+    decompressor->finished = true;
+    if (window_size == 0) {
+        return false;
+    }
+
+    decompressor->window_size = window_size;
+    decompressor->thread_threshold = thread_threshold;
+    decompressor->memory = malloc(JSON_DECOMPRESSOR_BLOCKS * window_size * 2);
+    decompressor->input = malloc(JSON_DECOMPRESSOR_INPUT_SIZE);
+    if (!decompressor->memory || !decompressor->input) {
+        json_decompressor_free(decompressor);
+        return false;
+    }
+
+    for (size_t i = 0; i < JSON_DECOMPRESSOR_BLOCKS; i++) {
+        decompressor->blocks[i].data = decompressor->memory + (2 * i + 1) * window_size;
+    }
+    return true;
+}
+
+void json_decompressor_free(JsonDecompressor* decompressor) {
+    json_decompressor_close(decompressor);
+    free(decompressor->memory);
+    decompressor->memory = NULL;
+    free(decompressor->input);
+    decompressor->input = NULL;
+    free(decompressor->carry);
+    decompressor->carry = NULL;
+    decompressor->carry_capacity = 0;
+}
+
+static void json_codec_free(JsonDecompressor* decompressor) {
+    if (!decompressor->codec) {
+        return;
+    }
+
+    switch (decompressor->compression) {
+#if defined(JSON_HAVE_ZLIB)
+        case JSON_COMPRESSION_GZIP:
+            inflateEnd(decompressor->codec);
+            free(decompressor->codec);
+            break;
+#endif
+#if defined(JSON_HAVE_ZSTD)
+        case JSON_COMPRESSION_ZSTD:
+            ZSTD_freeDStream(decompressor->codec);
+            break;
+#endif
+        default:
+            break;
+    }
+    decompressor->codec = NULL;
+}
+
+static bool json_codec_create(JsonDecompressor* decompressor) {
+    switch (decompressor->compression) {
+        case JSON_COMPRESSION_NONE:
+            return true;
+        case JSON_COMPRESSION_GZIP: {
+#if defined(JSON_HAVE_ZLIB)
+            z_stream* z = calloc(1, sizeof(z_stream));
+            // 15 + 32 accepts both gzip and zlib headers.
+            if (!z || inflateInit2(z, 15 + 32) != Z_OK) {
+                free(z);
+                errno = ENOMEM;
+                return false;
+            }
+            decompressor->codec = z;
+            return true;
+#else
+            errno = ENOTSUP;
+            return false;
+#endif
+        }
+        case JSON_COMPRESSION_ZSTD: {
+#if defined(JSON_HAVE_ZSTD)
+            ZSTD_DStream* ds = ZSTD_createDStream();
+            if (!ds || ZSTD_isError(ZSTD_initDStream(ds))) {
+                ZSTD_freeDStream(ds);
+                errno = ENOMEM;
+                return false;
+            }
+            decompressor->codec = ds;
+            return true;
+#else
+            errno = ENOTSUP;
+            return false;
+#endif
+        }
+    }
+
+    return false;
+}
+
+// Refills the input buffer once the codec has taken all of it. Returns an error message, or NULL.
+static const char* json_decompressor_fill(JsonDecompressor* decompressor) {
+    if (decompressor->input_offset < decompressor->input_length || decompressor->input_eof) {
+        return NULL;
+    }
+
+    ssize_t result;
+    do {
+        result = read(decompressor->fd, decompressor->input, JSON_DECOMPRESSOR_INPUT_SIZE);
+    } while (result < 0 && errno == EINTR);
+    if (result < 0) {
+        return strerror(errno);
+    }
+
+    decompressor->input_offset = 0;
+    decompressor->input_length = (size_t)result;
+    decompressor->input_eof = result == 0;
+    return NULL;
+}
+
+// Decompresses up to one window into block; the block is final when the input ends with a complete frame. Returns an
+// error message, or NULL. Runs on the producer thread when there is one, touching only the codec, the input and block.
+static const char* json_decompressor_produce(JsonDecompressor* decompressor, JsonDecompressorBlock* block) {
+    size_t window_size = decompressor->window_size;
+    size_t out = 0;
+    block->is_final = false;
+    while (out < window_size) {
+        const char* error = json_decompressor_fill(decompressor);
+        if (error) {
+            return error;
+        }
+
+        size_t available = decompressor->input_length - decompressor->input_offset;
+        if (available == 0) {
+            if (!decompressor->codec_done) {
+                return "truncated compressed input";
+            }
+            block->is_final = true;
+            break;
+        }
+
+        unsigned char* in = decompressor->input + decompressor->input_offset;
+        switch (decompressor->compression) {
+            case JSON_COMPRESSION_NONE: {
+                size_t length = available < window_size - out ? available : window_size - out;
+                memcpy(block->data + out, in, length);
+                decompressor->input_offset += length;
+                out += length;
+                break;
+            }
+            case JSON_COMPRESSION_GZIP: {
+#if defined(JSON_HAVE_ZLIB)
+                // Concatenated gzip members decompress to the concatenation of their contents.
+                z_stream* z = decompressor->codec;
+                if (decompressor->codec_done) {
+                    inflateReset(z);
+                    decompressor->codec_done = false;
+                }
+                z->next_in = in;
+                z->avail_in = (uInt)(available < UINT32_MAX ? available : UINT32_MAX);
+                z->next_out = (unsigned char*)block->data + out;
+                z->avail_out = (uInt)(window_size - out < UINT32_MAX ? window_size - out : UINT32_MAX);
+                uInt avail_in = z->avail_in;
+                uInt avail_out = z->avail_out;
+                int result = inflate(z, Z_NO_FLUSH);
+                if (result != Z_OK && result != Z_STREAM_END) {
+                    return z->msg ? z->msg : "invalid gzip data";
+                }
+                decompressor->input_offset += avail_in - z->avail_in;
+                out += avail_out - z->avail_out;
+                decompressor->codec_done = result == Z_STREAM_END;
+#endif
+                break;
+            }
+            case JSON_COMPRESSION_ZSTD: {
+#if defined(JSON_HAVE_ZSTD)
+                ZSTD_inBuffer input = {in, available, 0};
+                ZSTD_outBuffer output = {block->data, window_size, out};
+                size_t result = ZSTD_decompressStream(decompressor->codec, &output, &input);
+                if (ZSTD_isError(result)) {
+                    return ZSTD_getErrorName(result);
+                }
+                decompressor->input_offset += input.pos;
+                out = output.pos;
+                decompressor->codec_done = result == 0;
+#endif
+                break;
+            }
+        }
+    }
+
+    block->length = out;
+    return NULL;
+}
+
+static void* json_decompressor_run(void* argument) {
+    JsonDecompressor* decompressor = argument;
+    pthread_mutex_lock(&decompressor->mutex);
+    for (;;) {
+        while (!decompressor->stop && decompressor->produced >= decompressor->released + JSON_DECOMPRESSOR_BLOCKS) {
+            pthread_cond_wait(&decompressor->cond, &decompressor->mutex);
+        }
+        if (decompressor->stop) {
+            break;
+        }
+
+        JsonDecompressorBlock* block = &decompressor->blocks[decompressor->produced % JSON_DECOMPRESSOR_BLOCKS];
+        pthread_mutex_unlock(&decompressor->mutex);
+        const char* error = json_decompressor_produce(decompressor, block);
+        pthread_mutex_lock(&decompressor->mutex);
+
+        if (error) {
+            decompressor->error = error;
+        } else {
+            decompressor->produced++;
+        }
+        pthread_cond_broadcast(&decompressor->cond);
+        if (error || block->is_final) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&decompressor->mutex);
+    return NULL;
+}
+
+bool json_decompressor_open_fd(JsonDecompressor* decompressor, int fd) {
+    json_decompressor_close(decompressor);
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        return false;
+    }
+
+    decompressor->fd = fd;
+    decompressor->owns_fd = false;
+    decompressor->input_offset = 0;
+    decompressor->input_length = 0;
+    decompressor->input_eof = false;
+    const char* error = json_decompressor_fill(decompressor);
+    if (error) {
+        decompressor->fd = -1;
+        return false;
+    }
+
+    const unsigned char* magic = decompressor->input;
+    size_t length = decompressor->input_length;
+    if (length >= 2 && magic[0] == 0x1F && magic[1] == 0x8B) {
+        decompressor->compression = JSON_COMPRESSION_GZIP;
+    } else if (length >= 4 && magic[0] == 0x28 && magic[1] == 0xB5 && magic[2] == 0x2F && magic[3] == 0xFD) {
+        decompressor->compression = JSON_COMPRESSION_ZSTD;
+    } else {
+        decompressor->compression = JSON_COMPRESSION_NONE;
+    }
+    if (!json_codec_create(decompressor)) {
+        decompressor->fd = -1;
+        return false;
+    }
+
+    decompressor->codec_done = decompressor->compression == JSON_COMPRESSION_NONE;
+    decompressor->current = JSON_DECOMPRESSOR_NO_BLOCK;
+    decompressor->finished = false;
+    decompressor->produced = 0;
+    decompressor->taken = 0;
+    decompressor->released = 0;
+    decompressor->error = NULL;
+    decompressor->stop = false;
+
+    decompressor->threaded = false;
+    if (decompressor->thread_threshold != SIZE_MAX && S_ISREG(info.st_mode) &&
+        (uint64_t)info.st_size >= decompressor->thread_threshold) {
+        pthread_mutex_init(&decompressor->mutex, NULL);
+        pthread_cond_init(&decompressor->cond, NULL);
+        decompressor->threaded = pthread_create(&decompressor->thread, NULL, json_decompressor_run, decompressor) == 0;
+        if (!decompressor->threaded) {
+            pthread_cond_destroy(&decompressor->cond);
+            pthread_mutex_destroy(&decompressor->mutex);
+        }
+    }
+
+    return true;
+}
+
+bool json_decompressor_open(JsonDecompressor* decompressor, const char* path) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    if (!json_decompressor_open_fd(decompressor, fd)) {
+        int error = errno;
+        close(fd);
+        errno = error;
+        return false;
+    }
+
+    decompressor->owns_fd = true;
+    return true;
+}
+
+void json_decompressor_close(JsonDecompressor* decompressor) {
+    if (decompressor->fd < 0) {
+        return;
+    }
+
+    if (decompressor->threaded) {
+        pthread_mutex_lock(&decompressor->mutex);
+        decompressor->stop = true;
+        pthread_cond_broadcast(&decompressor->cond);
+        pthread_mutex_unlock(&decompressor->mutex);
+        pthread_join(decompressor->thread, NULL);
+        pthread_cond_destroy(&decompressor->cond);
+        pthread_mutex_destroy(&decompressor->mutex);
+        decompressor->threaded = false;
+    }
+
+    json_codec_free(decompressor);
+    if (decompressor->owns_fd) {
+        close(decompressor->fd);
+    }
+    decompressor->fd = -1;
+    decompressor->owns_fd = false;
+    decompressor->finished = true;
+}
+
+bool json_decompressor_next(JsonDecompressor* decompressor, JsonStream* stream) {
+    if (decompressor->finished || decompressor->fd < 0 || stream->error.type != JSON_ERROR_NONE) {
+        return false;
+    }
+
+    const char* leftover = NULL;
+    size_t leftover_length = 0;
+    if (decompressor->current != JSON_DECOMPRESSOR_NO_BLOCK) {
+        leftover = stream->buffer + stream->consumed;
+        leftover_length = stream->buffer_size - stream->consumed;
+    }
+
+    size_t index = decompressor->taken % JSON_DECOMPRESSOR_BLOCKS;
+    JsonDecompressorBlock* block = &decompressor->blocks[index];
+    const char* error = NULL;
+    if (decompressor->threaded) {
+        pthread_mutex_lock(&decompressor->mutex);
+        while (decompressor->produced == decompressor->taken && !decompressor->error) {
+            pthread_cond_wait(&decompressor->cond, &decompressor->mutex);
+        }
+        if (decompressor->produced == decompressor->taken) {
+            error = decompressor->error;
+        }
+        pthread_mutex_unlock(&decompressor->mutex);
+    } else {
+        error = json_decompressor_produce(decompressor, block);
+    }
+    if (error) {
+        decompressor->finished = true;
+        json_throw_string(stream, JSON_ERROR_READ_FAILED, error);
+        return false;
+    }
+
+    char* buffer = json_join_leftover(
+        stream,
+        &decompressor->carry,
+        &decompressor->carry_capacity,
+        decompressor->window_size,
+        leftover,
+        leftover_length,
+        block->data,
+        block->length
+    );
+    if (!buffer) {
+        return false;
+    }
+
+    if (decompressor->current != JSON_DECOMPRESSOR_NO_BLOCK) {
+        if (decompressor->threaded) {
+            pthread_mutex_lock(&decompressor->mutex);
+            decompressor->released++;
+            pthread_cond_broadcast(&decompressor->cond);
+            pthread_mutex_unlock(&decompressor->mutex);
+        } else {
+            decompressor->released++;
+        }
+    }
+
+    decompressor->current = index;
+    decompressor->taken++;
+    decompressor->finished = block->is_final;
+
+    // Without a leftover, an empty final window becomes an empty NUL-terminated buffer.
+    size_t length = leftover_length + block->length;
+    json_stream_continue(stream, stream, length > 0 ? buffer : "", length, block->is_final);
+    return true;
+}
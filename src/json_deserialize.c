@@ -0,0 +1,226 @@
+#include "json_deserialize.h"
+
+#include <string.h>
+
+#include "json_internal.h"
+
+#define JSON_DESERIALIZE_INLINE_FIELDS 256
+
+static bool json_deserialize_object(JsonStream* stream, const JsonObjectDescriptor* descriptor, void* out);
+
+static bool json_deserialize_field(JsonStream* stream, const JsonFieldDescriptor* field, void* out, bool seen);
+
+bool json_object_descriptor_init(
+    JsonObjectDescriptor* descriptor,
+    const JsonFieldDescriptor* fields,
+    size_t field_count
+) {
+    memset(descriptor, 0, sizeof(JsonObjectDescriptor));
+    descriptor->fields = fields;
+    descriptor->field_count = field_count;
+
+    descriptor->names = malloc((field_count + 1) * sizeof(const char*));
+    if (!descriptor->names) {
+        return false;
+    }
+
+    for (size_t i = 0; i < field_count; i++) {
+        descriptor->names[i] = fields[i].name;
+    }
+
+    if (!json_property_table_init(&descriptor->table, descriptor->names, field_count)) {
+        free(descriptor->names);
+        descriptor->names = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+void json_object_descriptor_free(JsonObjectDescriptor* descriptor) {
+    json_property_table_free(&descriptor->table);
+    free(descriptor->names);
+    descriptor->names = NULL;
+}
+
+bool json_deserialize(JsonStream* stream, const JsonObjectDescriptor* descriptor, void* out) {
+    if (stream->token_type != JSON_TYPE_OBJECT_START && !json_read(stream)) {
+        return false;
+    }
+
+    if (stream->token_type != JSON_TYPE_OBJECT_START) {
+        json_throw_string(
+            stream,
+            JSON_ERROR_INVALID_OPERATION_EXPECTED_OBJECT_START,
+            json_token_type_name(stream->token_type)
+        );
+        return false;
+    }
+
+    return json_deserialize_object(stream, descriptor, out);
+}
+
+static bool json_deserialize_object(JsonStream* stream, const JsonObjectDescriptor* descriptor, void* out) {
+    uint64_t inline_seen[JSON_DESERIALIZE_INLINE_FIELDS / 64] = {0};
+    uint64_t* seen = inline_seen;
+    bool result = false;
+
+    if (descriptor->field_count > JSON_DESERIALIZE_INLINE_FIELDS) {
+        seen = calloc((descriptor->field_count + 63) / 64, sizeof(uint64_t));
+        if (!seen) {
+            json_throw(stream, JSON_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+    }
+
+    while (json_read(stream)) {
+        if (stream->token_type == JSON_TYPE_OBJECT_END) {
+            for (size_t i = 0; i < descriptor->field_count; i++) {
+                if (descriptor->fields[i].required && !(seen[i / 64] & (1ULL << (i % 64)))) {
+                    json_throw_string(stream, JSON_ERROR_REQUIRED_PROPERTY_NOT_FOUND, descriptor->fields[i].name);
+                    goto done;
+                }
+            }
+
+            result = true;
+            goto done;
+        }
+
+        if (stream->token_type == JSON_TYPE_COMMENT) {
+            continue;
+        }
+
+        int index = json_match_property(stream, &descriptor->table);
+        if (index == JSON_PROPERTY_NOT_FOUND) {
+            if (stream->error.type != JSON_ERROR_NONE || !json_skip(stream)) {
+                goto done;
+            }
+            continue;
+        }
+
+        bool field_seen = seen[index / 64] & (1ULL << (index % 64));
+        if (!json_read(stream) || !json_deserialize_field(stream, &descriptor->fields[index], out, field_seen)) {
+            goto done;
+        }
+
+        seen[index / 64] |= 1ULL << (index % 64);
+    }
+
+done:
+    if (seen != inline_seen) {
+        free(seen);
+    }
+
+    return result;
+}
+
+#define JSON_DESERIALIZE_VALUE(stream, destination, value_type, getter) \
+    do {                                                                 \
+        value_type value = getter(stream);                               \
+        if ((stream)->error.type != JSON_ERROR_NONE) {                   \
+            return false;                                                \
+        }                                                                \
+        memcpy(destination, &value, sizeof(value_type));                 \
+    } while (0)
+
+static bool json_deserialize_field(JsonStream* stream, const JsonFieldDescriptor* field, void* out, bool seen) {
+    char* destination = (char*)out + field->offset;
+
+    while (stream->token_type == JSON_TYPE_COMMENT) {
+        if (!json_read(stream)) {
+            return false;
+        }
+    }
+
+    switch (field->type) {
+        case JSON_FIELD_BOOL:
+            JSON_DESERIALIZE_VALUE(stream, destination, bool, json_get_bool);
+            return true;
+        case JSON_FIELD_U8:
+            JSON_DESERIALIZE_VALUE(stream, destination, uint8_t, json_get_u8);
+            return true;
+        case JSON_FIELD_I8:
+            JSON_DESERIALIZE_VALUE(stream, destination, int8_t, json_get_i8);
+            return true;
+        case JSON_FIELD_U16:
+            JSON_DESERIALIZE_VALUE(stream, destination, uint16_t, json_get_u16);
+            return true;
+        case JSON_FIELD_I16:
+            JSON_DESERIALIZE_VALUE(stream, destination, int16_t, json_get_i16);
+            return true;
+        case JSON_FIELD_U32:
+            JSON_DESERIALIZE_VALUE(stream, destination, uint32_t, json_get_u32);
+            return true;
+        case JSON_FIELD_I32:
+            JSON_DESERIALIZE_VALUE(stream, destination, int32_t, json_get_i32);
+            return true;
+        case JSON_FIELD_U64:
+            JSON_DESERIALIZE_VALUE(stream, destination, uint64_t, json_get_u64);
+            return true;
+        case JSON_FIELD_I64:
+            JSON_DESERIALIZE_VALUE(stream, destination, int64_t, json_get_i64);
+            return true;
+        case JSON_FIELD_FLOAT:
+            JSON_DESERIALIZE_VALUE(stream, destination, float, json_get_float);
+            return true;
+        case JSON_FIELD_DOUBLE:
+            JSON_DESERIALIZE_VALUE(stream, destination, double, json_get_double);
+            return true;
+        case JSON_FIELD_STRING: {
+            char* value;
+            if (!json_try_get_string_escaped(stream, NULL, 0, &value, NULL)) {
+                if (stream->error.type == JSON_ERROR_NONE) {
+                    json_throw(stream, JSON_ERROR_INVALID_OPERATION_EXPECTED_STRING);
+                }
+                return false;
+            }
+
+            if (seen) {
+                char* previous;
+                memcpy(&previous, destination, sizeof(char*));
+                free(previous);
+            }
+            memcpy(destination, &value, sizeof(char*));
+            return true;
+        }
+        case JSON_FIELD_OBJECT:
+            // A repeated key replaces the object; its strings would otherwise be overwritten without being freed.
+            if (seen) {
+                json_deserialize_free(field->object, destination);
+            }
+
+            if (stream->token_type == JSON_TYPE_NULL) {
+                return true;
+            }
+
+            if (stream->token_type != JSON_TYPE_OBJECT_START) {
+                json_throw_string(
+                    stream,
+                    JSON_ERROR_INVALID_OPERATION_EXPECTED_OBJECT_START,
+                    json_token_type_name(stream->token_type)
+                );
+                return false;
+            }
+
+            return json_deserialize_object(stream, field->object, destination);
+    }
+
+    return false;
+}
+
+void json_deserialize_free(const JsonObjectDescriptor* descriptor, void* out) {
+    for (size_t i = 0; i < descriptor->field_count; i++) {
+        const JsonFieldDescriptor* field = &descriptor->fields[i];
+        char* destination = (char*)out + field->offset;
+
+        if (field->type == JSON_FIELD_STRING) {
+            char* value;
+            memcpy(&value, destination, sizeof(char*));
+            free(value);
+            value = NULL;
+            memcpy(destination, &value, sizeof(char*));
+        } else if (field->type == JSON_FIELD_OBJECT) {
+            json_deserialize_free(field->object, destination);
+        }
+    }
+}
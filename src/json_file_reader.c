@@ -0,0 +1,476 @@
+// pread, syscall and the io_uring mmap flags are not part of ISO C.
+#define _GNU_SOURCE
+
+#include "json_file_reader.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "json_internal.h"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define JSON_FILE_READER_IO_URING
+#endif
+#endif
+
+#if defined(JSON_FILE_READER_IO_URING)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+// The ring is driven through the raw system calls, so that no liburing is needed to build the library.
+struct JsonFileReaderRing {
+    int fd;
+    void* sq_memory;
+    size_t sq_memory_size;
+    void* cq_memory;
+    size_t cq_memory_size;
+    struct io_uring_sqe* sqes;
+    size_t sqes_size;
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_array;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    struct io_uring_cqe* cqes;
+};
+
+static void json_ring_free(JsonFileReaderRing* ring) {
+    if (ring->sqes) {
+        munmap(ring->sqes, ring->sqes_size);
+    }
+    if (ring->cq_memory && ring->cq_memory != ring->sq_memory) {
+        munmap(ring->cq_memory, ring->cq_memory_size);
+    }
+    if (ring->sq_memory) {
+        munmap(ring->sq_memory, ring->sq_memory_size);
+    }
+    close(ring->fd);
+    free(ring);
+}
+
+static JsonFileReaderRing* json_ring_create(unsigned entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    JsonFileReaderRing* ring = calloc(1, sizeof(JsonFileReaderRing));
+    if (!ring) {
+        close(fd);
+        return NULL;
+    }
+    ring->fd = fd;
+
+    ring->sq_memory_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_memory_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cq_memory_size > ring->sq_memory_size) {
+            ring->sq_memory_size = ring->cq_memory_size;
+        }
+        ring->cq_memory_size = ring->sq_memory_size;
+    }
+
+    void* sq_memory = mmap(
+        NULL,
+        ring->sq_memory_size,
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE,
+        fd,
+        IORING_OFF_SQ_RING
+    );
+    if (sq_memory == MAP_FAILED) {
+        json_ring_free(ring);
+        return NULL;
+    }
+    ring->sq_memory = sq_memory;
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cq_memory = sq_memory;
+    } else {
+        void* cq_memory = mmap(
+            NULL,
+            ring->cq_memory_size,
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE,
+            fd,
+            IORING_OFF_CQ_RING
+        );
+        if (cq_memory == MAP_FAILED) {
+            json_ring_free(ring);
+            return NULL;
+        }
+        ring->cq_memory = cq_memory;
+    }
+
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        json_ring_free(ring);
+        return NULL;
+    }
+    ring->sqes = sqes;
+
+    char* sq = ring->sq_memory;
+    char* cq = ring->cq_memory;
+    ring->sq_head = (unsigned*)(sq + params.sq_off.head);
+    ring->sq_tail = (unsigned*)(sq + params.sq_off.tail);
+    ring->sq_mask = (unsigned*)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned*)(sq + params.sq_off.array);
+    ring->cq_head = (unsigned*)(cq + params.cq_off.head);
+    ring->cq_tail = (unsigned*)(cq + params.cq_off.tail);
+    ring->cq_mask = (unsigned*)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+    return ring;
+}
+
+static bool json_ring_register_buffers(JsonFileReaderRing* ring, JsonFileReader* reader) {
+    struct iovec iovecs[JSON_FILE_READER_MAX_DEPTH];
+    for (size_t i = 0; i < reader->depth; i++) {
+        iovecs[i].iov_base = reader->slots[i].data;
+        iovecs[i].iov_len = reader->chunk_size;
+    }
+    return syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_BUFFERS, iovecs, (unsigned)reader->depth) == 0;
+}
+
+static bool json_ring_submit_read(JsonFileReader* reader, size_t slot) {
+    JsonFileReaderRing* ring = reader->ring;
+    unsigned tail = *ring->sq_tail;
+    unsigned index = tail & *ring->sq_mask;
+    struct io_uring_sqe* sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = reader->registered_buffers ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    sqe->fd = reader->fd;
+    sqe->addr = (uint64_t)(uintptr_t)reader->slots[slot].data;
+    sqe->len = (uint32_t)reader->slots[slot].length;
+    sqe->off = reader->slots[slot].offset;
+    sqe->buf_index = (uint16_t)slot;
+    sqe->user_data = slot;
+    ring->sq_array[index] = index;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    return syscall(__NR_io_uring_enter, ring->fd, 1, 0, 0, NULL, 0) == 1;
+}
+
+// Blocks until at least one completion arrives and records every completion that is available.
+static bool json_ring_reap(JsonFileReader* reader) {
+    JsonFileReaderRing* ring = reader->ring;
+    unsigned head = *ring->cq_head;
+    if (head == __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)) {
+        if (syscall(__NR_io_uring_enter, ring->fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 && errno != EINTR) {
+            return false;
+        }
+    }
+
+    unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    for (; head != tail; head++) {
+        struct io_uring_cqe* cqe = &ring->cqes[head & *ring->cq_mask];
+        JsonFileReaderSlot* slot = &reader->slots[cqe->user_data];
+        slot->result = cqe->res;
+        slot->pending = false;
+    }
+    __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+    return true;
+}
+#else
+struct JsonFileReaderRing {
+    int unused;
+};
+
+static void json_ring_free(JsonFileReaderRing* ring) {
+    free(ring);
+}
+#endif
+
+bool json_file_reader_init(JsonFileReader* reader, size_t chunk_size, size_t depth, bool use_io_uring) {
+    memset(reader, 0, sizeof(JsonFileReader));
+    reader->fd = -1;
+    reader->current = JSON_FILE_READER_NO_SLOT;
+    if (chunk_size == 0 || chunk_size > UINT32_MAX || depth < 2 || depth > JSON_FILE_READER_MAX_DEPTH) {
+        return false;
+    }
+
+    reader->depth = depth;
+    reader->chunk_size = chunk_size;
+    reader->memory = malloc(depth * chunk_size * 2);
+    if (!reader->memory) {
+        return false;
+    }
+    for (size_t i = 0; i < depth; i++) {
+        reader->slots[i].data = reader->memory + (2 * i + 1) * chunk_size;
+    }
+
+#if defined(JSON_FILE_READER_IO_URING)
+    if (use_io_uring) {
+        reader->ring = json_ring_create((unsigned)depth);
+        if (reader->ring) {
+            reader->registered_buffers = json_ring_register_buffers(reader->ring, reader);
+        }
+    }
+#else
+    (void)use_io_uring;
+#endif
+
+    return true;
+}
+
+void json_file_reader_free(JsonFileReader* reader) {
+    json_file_reader_close(reader);
+    if (reader->ring) {
+        json_ring_free(reader->ring);
+        reader->ring = NULL;
+    }
+    free(reader->memory);
+    reader->memory = NULL;
+    free(reader->carry);
+    reader->carry = NULL;
+    reader->carry_capacity = 0;
+}
+
+#if defined(JSON_FILE_READER_IO_URING)
+// Falls back to pread for the rest of the reader's life. Reads already queued are waited for first, since the kernel
+// would otherwise still write into the buffers; except is a slot whose read never reached the ring.
+static void json_file_reader_drop_ring(JsonFileReader* reader, size_t except) {
+    for (size_t i = 0; i < reader->depth; i++) {
+        while (i != except && reader->slots[i].pending) {
+            if (!json_ring_reap(reader)) {
+                break;
+            }
+        }
+    }
+    json_ring_free(reader->ring);
+    reader->ring = NULL;
+}
+#endif
+
+static void json_file_reader_submit(JsonFileReader* reader, size_t slot) {
+    uint64_t remaining = reader->file_size - reader->next_offset;
+    reader->slots[slot].offset = reader->next_offset;
+    reader->slots[slot].length = remaining < reader->chunk_size ? (size_t)remaining : reader->chunk_size;
+    reader->slots[slot].result = 0;
+    reader->slots[slot].pending = true;
+    reader->next_offset += reader->slots[slot].length;
+
+#if defined(JSON_FILE_READER_IO_URING)
+    // A read that cannot be queued stays pending once the ring is gone; json_file_reader_wait then preads it.
+    if (reader->ring && !json_ring_submit_read(reader, slot)) {
+        json_file_reader_drop_ring(reader, slot);
+    }
+#endif
+}
+
+static ssize_t json_file_reader_pread(JsonFileReader* reader, char* buffer, size_t length, uint64_t offset) {
+    ssize_t result;
+    do {
+        result = pread(reader->fd, buffer, length, (off_t)offset);
+    } while (result < 0 && errno == EINTR);
+    return result;
+}
+
+// Waits for the read into slot and completes it when it came back short. Returns the number of bytes read, or -1
+// with errno set.
+static ssize_t json_file_reader_wait(JsonFileReader* reader, size_t slot) {
+    JsonFileReaderSlot* s = &reader->slots[slot];
+#if defined(JSON_FILE_READER_IO_URING)
+    while (s->pending && reader->ring) {
+        if (!json_ring_reap(reader)) {
+            return -1;
+        }
+    }
+#endif
+
+    size_t length = 0;
+    if (s->pending) {
+        s->pending = false;
+    } else if (s->result > 0) {
+        length = (size_t)s->result;
+    }
+
+    // Failed ring reads (for example an opcode the kernel does not know) and short reads are finished with pread.
+    while (length < s->length) {
+        ssize_t result = json_file_reader_pread(reader, s->data + length, s->length - length, s->offset + length);
+        if (result < 0) {
+            return -1;
+        }
+        if (result == 0) {
+            break;
+        }
+        length += (size_t)result;
+    }
+
+    return (ssize_t)length;
+}
+
+bool json_file_reader_open_fd(JsonFileReader* reader, int fd) {
+    json_file_reader_close(reader);
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        return false;
+    }
+
+    reader->fd = fd;
+    reader->owns_fd = false;
+    reader->file_size = info.st_size > 0 ? (uint64_t)info.st_size : 0;
+    reader->next_offset = 0;
+    reader->current = JSON_FILE_READER_NO_SLOT;
+    reader->next_slot = 0;
+    reader->finished = false;
+    for (size_t i = 0; i < reader->depth && reader->next_offset < reader->file_size; i++) {
+        json_file_reader_submit(reader, i);
+    }
+    return true;
+}
+
+bool json_file_reader_open(JsonFileReader* reader, const char* path) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    if (!json_file_reader_open_fd(reader, fd)) {
+        int error = errno;
+        close(fd);
+        errno = error;
+        return false;
+    }
+
+    reader->owns_fd = true;
+    return true;
+}
+
+void json_file_reader_close(JsonFileReader* reader) {
+    if (reader->fd < 0) {
+        return;
+    }
+
+    // The kernel may still be writing into the buffers; they can only be reused once those reads are done.
+#if defined(JSON_FILE_READER_IO_URING)
+    for (size_t i = 0; i < reader->depth && reader->ring; i++) {
+        while (reader->slots[i].pending) {
+            if (!json_ring_reap(reader)) {
+                json_file_reader_drop_ring(reader, JSON_FILE_READER_NO_SLOT);
+                break;
+            }
+        }
+    }
+#endif
+    for (size_t i = 0; i < reader->depth; i++) {
+        reader->slots[i].pending = false;
+        reader->slots[i].length = 0;
+    }
+
+    if (reader->owns_fd) {
+        close(reader->fd);
+    }
+    reader->fd = -1;
+    reader->owns_fd = false;
+    reader->finished = true;
+}
+
+char* json_join_leftover(
+    JsonStream* stream,
+    char** carry,
+    size_t* carry_capacity,
+    size_t headroom,
+    const char* leftover,
+    size_t leftover_length,
+    char* data,
+    size_t length
+) {
+    if (leftover_length <= headroom) {
+        if (leftover_length > 0) {
+            memcpy(data - leftover_length, leftover, leftover_length);
+        }
+        return data - leftover_length;
+    }
+
+    size_t capacity = leftover_length + length;
+    if (capacity > *carry_capacity) {
+        size_t new_capacity = *carry_capacity ? *carry_capacity : headroom;
+        while (new_capacity < capacity) {
+            new_capacity *= 2;
+        }
+
+        bool in_carry = *carry && leftover >= *carry && leftover < *carry + *carry_capacity;
+        size_t leftover_offset = in_carry ? (size_t)(leftover - *carry) : 0;
+        char* new_carry = realloc(*carry, new_capacity);
+        if (!new_carry) {
+            json_throw(stream, JSON_ERROR_OUT_OF_MEMORY);
+            return NULL;
+        }
+        if (in_carry) {
+            leftover = new_carry + leftover_offset;
+        }
+        *carry = new_carry;
+        *carry_capacity = new_capacity;
+    }
+
+    memmove(*carry, leftover, leftover_length);
+    memcpy(*carry + leftover_length, data, length);
+    return *carry;
+}
+
+bool json_file_reader_next(JsonFileReader* reader, JsonStream* stream) {
+    if (reader->finished || reader->fd < 0 || stream->error.type != JSON_ERROR_NONE) {
+        return false;
+    }
+
+    const char* leftover = NULL;
+    size_t leftover_length = 0;
+    if (reader->current != JSON_FILE_READER_NO_SLOT) {
+        leftover = stream->buffer + stream->consumed;
+        leftover_length = stream->buffer_size - stream->consumed;
+    }
+
+    // An empty file still gets one, empty, final block so that the stream reports the missing value.
+    size_t slot = reader->next_slot;
+    JsonFileReaderSlot* s = &reader->slots[slot];
+    if (s->length == 0) {
+        reader->finished = true;
+        json_stream_continue(stream, stream, "", 0, true);
+        return true;
+    }
+
+    ssize_t length = json_file_reader_wait(reader, slot);
+    if (length < 0) {
+        json_throw_string(stream, JSON_ERROR_READ_FAILED, strerror(errno));
+        return false;
+    }
+
+    char* buffer = json_join_leftover(
+        stream,
+        &reader->carry,
+        &reader->carry_capacity,
+        reader->chunk_size,
+        leftover,
+        leftover_length,
+        s->data,
+        (size_t)length
+    );
+    if (!buffer) {
+        return false;
+    }
+
+    bool is_final = s->offset + (uint64_t)length >= reader->file_size || (size_t)length < s->length;
+    s->length = 0;
+    if (reader->current != JSON_FILE_READER_NO_SLOT && !is_final && reader->next_offset < reader->file_size) {
+        json_file_reader_submit(reader, reader->current);
+    }
+
+    reader->current = slot;
+    reader->next_slot = (slot + 1) % reader->depth;
+    reader->finished = is_final;
+    json_stream_continue(stream, stream, buffer, leftover_length + (size_t)length, is_final);
+    return true;
+}
@@ -0,0 +1,45 @@
+#ifndef JSON_INTERNAL_H
+#define JSON_INTERNAL_H
+
+#include "json_stream.h"
+
+// Error helpers shared by the modules built on top of the tokenizer. They record the current stream position and
+// invoke the stream's error handler.
+void json_throw(JsonStream* stream, JsonErrorType type);
+
+void json_throw_char(JsonStream* stream, JsonErrorType type, char c);
+
+void json_throw_string(JsonStream* stream, JsonErrorType type, const char* string);
+
+void json_throw_number(JsonStream* stream, JsonErrorType type, int64_t number);
+
+void json_throw_slice(JsonStream* stream, JsonErrorType type, const char* string, int slice_length);
+
+// Places the unconsumed end of the previous buffer in front of data and returns where the combined bytes start. The
+// leftover goes into the headroom bytes before data when it fits; longer ones are assembled in the growable carry
+// buffer, which the leftover itself may live in.
+char* json_join_leftover(
+    JsonStream* stream,
+    char** carry,
+    size_t* carry_capacity,
+    size_t headroom,
+    const char* leftover,
+    size_t leftover_length,
+    char* data,
+    size_t length
+);
+
+// Number parsers behind the batch array readers. text must be a valid JSON number token. json_parse_i64 fails for
+// fractions, exponents and values out of range; json_parse_double fails for magnitudes beyond the range of a double
+// and when the stream cannot grow its scratch.
+bool json_parse_i64(const char* text, size_t length, int64_t* out);
+
+bool json_parse_double(JsonStream* stream, const char* text, size_t length, double* out);
+
+// Tape replay behind json_read for streams set up by json_stream_init_tape. json_tape_current returns the replayed
+// token the stream is on, or NULL when it is not replaying or has been rolled back to an earlier position.
+bool json_tape_read(JsonStream* stream);
+
+const struct JsonTapeToken* json_tape_current(const JsonStream* stream);
+
+#endif // JSON_INTERNAL_H
@@ -0,0 +1,764 @@
+#include "json_path.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "json_internal.h"
+
+static bool json_path_push_step(JsonPath* path, JsonPathStep step) {
+    JsonPathStep* steps = realloc(path->steps, (path->step_count + 1) * sizeof(JsonPathStep));
+    if (!steps) {
+        free(step.name);
+        return false;
+    }
+
+    steps[path->step_count++] = step;
+    path->steps = steps;
+    return true;
+}
+
+static bool json_path_parse_index(const char** cursor, size_t* out_index) {
+    const char* c = *cursor;
+    if (*c < '0' || *c > '9') {
+        return false;
+    }
+
+    size_t index = 0;
+    for (; *c >= '0' && *c <= '9'; c++) {
+        size_t digit = (size_t)(*c - '0');
+        if (index > (JSON_PATH_NO_INDEX - 1 - digit) / 10) {
+            return false;
+        }
+        index = index * 10 + digit;
+    }
+
+    *cursor = c;
+    *out_index = index;
+    return true;
+}
+
+// Reads a quoted bracket name; only the quote character and backslash may be escaped.
+static bool json_path_parse_quoted(const char** cursor, JsonPathStep* step) {
+    const char* c = *cursor;
+    char quote = *c++;
+    size_t length = 0;
+    const char* end = c;
+    while (*end != quote) {
+        if (!*end) {
+            return false;
+        }
+        if (*end == '\\') {
+            if (end[1] != quote && end[1] != '\\') {
+                return false;
+            }
+            end++;
+        }
+        end++;
+        length++;
+    }
+
+    char* name = malloc(length + 1);
+    if (!name) {
+        return false;
+    }
+
+    for (size_t i = 0; i < length; i++) {
+        if (*c == '\\') {
+            c++;
+        }
+        name[i] = *c++;
+    }
+    name[length] = '\0';
+
+    step->name = name;
+    step->name_length = length;
+    *cursor = end + 1;
+    return true;
+}
+
+bool json_path_compile(const char* expression, JsonPath* out_path) {
+    *out_path = (JsonPath){0};
+
+    const char* c = expression;
+    if (*c++ != '$') {
+        return false;
+    }
+
+    while (*c) {
+        JsonPathStep step = {.name = NULL, .name_length = 0, .index = JSON_PATH_NO_INDEX, .wildcard = false};
+
+        if (*c == '.') {
+            c++;
+            if (*c == '*') {
+                step.wildcard = true;
+                c++;
+            } else {
+                const char* start = c;
+                while (*c && *c != '.' && *c != '[') {
+                    c++;
+                }
+                if (c == start) {
+                    goto error;
+                }
+
+                step.name_length = (size_t)(c - start);
+                step.name = malloc(step.name_length + 1);
+                if (!step.name) {
+                    goto error;
+                }
+                memcpy(step.name, start, step.name_length);
+                step.name[step.name_length] = '\0';
+            }
+        } else if (*c == '[') {
+            c++;
+            if (*c == '*') {
+                step.wildcard = true;
+                c++;
+            } else if (*c == '\'' || *c == '"') {
+                if (!json_path_parse_quoted(&c, &step)) {
+                    goto error;
+                }
+            } else if (!json_path_parse_index(&c, &step.index)) {
+                goto error;
+            }
+
+            if (*c != ']') {
+                free(step.name);
+                goto error;
+            }
+            c++;
+        } else {
+            goto error;
+        }
+
+        if (!json_path_push_step(out_path, step)) {
+            goto error;
+        }
+    }
+
+    return true;
+
+error:
+    json_path_free(out_path);
+    return false;
+}
+
+bool json_pointer_compile(const char* pointer, JsonPath* out_path) {
+    *out_path = (JsonPath){0};
+
+    const char* c = pointer;
+    if (*c && *c != '/') {
+        return false;
+    }
+
+    while (*c == '/') {
+        const char* start = ++c;
+        size_t length = 0;
+        for (; *c && *c != '/'; c++, length++) {
+            if (*c == '~') {
+                if (c[1] != '0' && c[1] != '1') {
+                    goto error;
+                }
+                c++;
+            }
+        }
+
+        JsonPathStep step = {.name = malloc(length + 1), .name_length = length, .index = JSON_PATH_NO_INDEX};
+        if (!step.name) {
+            goto error;
+        }
+
+        const char* source = start;
+        for (size_t i = 0; i < length; i++) {
+            if (*source == '~') {
+                step.name[i] = source[1] == '0' ? '~' : '/';
+                source += 2;
+            } else {
+                step.name[i] = *source++;
+            }
+        }
+        step.name[length] = '\0';
+
+        // Array indices are written without leading zeros; "-" names the element after the last and never matches.
+        const char* digits = step.name;
+        if (length > 0 && (length == 1 || step.name[0] != '0') && json_path_parse_index(&digits, &step.index)
+            && digits != step.name + length) {
+            step.index = JSON_PATH_NO_INDEX;
+        }
+
+        if (!json_path_push_step(out_path, step)) {
+            goto error;
+        }
+    }
+
+    return true;
+
+error:
+    json_path_free(out_path);
+    return false;
+}
+
+void json_path_free(JsonPath* path) {
+    for (size_t i = 0; i < path->step_count; i++) {
+        free(path->steps[i].name);
+    }
+    free(path->steps);
+    *path = (JsonPath){0};
+}
+
+void json_path_matcher_init(JsonPathMatcher* matcher, const JsonPath* path, JsonPathCallback callback, void* context) {
+    *matcher = (JsonPathMatcher){
+        .path = path,
+        .callback = callback,
+        .context = context,
+        .frames = NULL,
+        .depth = 0,
+        .capacity = 0,
+        .skip_depth = SIZE_MAX,
+        .match_count = 0,
+        .stopped = false,
+    };
+}
+
+void json_path_matcher_free(JsonPathMatcher* matcher) {
+    free(matcher->frames);
+    matcher->frames = NULL;
+    matcher->depth = 0;
+    matcher->capacity = 0;
+}
+
+static bool json_path_push_frame(JsonPathMatcher* matcher, JsonStream* stream, bool is_object) {
+    if (matcher->depth == matcher->capacity) {
+        size_t capacity = matcher->capacity ? matcher->capacity * 2 : 16;
+        JsonPathFrame* frames = realloc(matcher->frames, capacity * sizeof(JsonPathFrame));
+        if (!frames) {
+            json_throw(stream, JSON_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+        matcher->frames = frames;
+        matcher->capacity = capacity;
+    }
+
+    matcher->frames[matcher->depth++] = (JsonPathFrame){.index = 0, .is_object = is_object, .pending = false};
+    return true;
+}
+
+static bool json_path_value(JsonPathMatcher* matcher, JsonStream* stream, JsonType type, size_t depth) {
+    bool is_container = type == JSON_TYPE_OBJECT_START || type == JSON_TYPE_ARRAY_START;
+
+    if (depth > 0) {
+        JsonPathFrame* parent = &matcher->frames[depth - 1];
+        const JsonPathStep* step = &matcher->path->steps[depth - 1];
+        bool matched = parent->is_object ? parent->pending : step->wildcard || step->index == parent->index;
+        parent->index++;
+
+        if (!matched) {
+            if (is_container) {
+                matcher->skip_depth = depth;
+            }
+            return true;
+        }
+    }
+
+    if (depth < matcher->path->step_count) {
+        return !is_container || json_path_push_frame(matcher, stream, type == JSON_TYPE_OBJECT_START);
+    }
+
+    matcher->match_count++;
+    size_t consumed = json_total_bytes_consumed(stream);
+    if (!matcher->callback(stream, matcher->context)) {
+        matcher->stopped = true;
+        return false;
+    }
+
+    if (json_has_error(stream)) {
+        return false;
+    }
+
+    // A container the callback left unread is passed over like any other subtree.
+    if (is_container && json_total_bytes_consumed(stream) == consumed) {
+        matcher->skip_depth = depth;
+    }
+
+    return true;
+}
+
+bool json_path_next(JsonPathMatcher* matcher, JsonStream* stream) {
+    if (matcher->stopped) {
+        return false;
+    }
+
+    JsonType type = json_token_type(stream);
+    size_t depth = json_current_depth(stream);
+
+    if (matcher->skip_depth != SIZE_MAX) {
+        if (depth == matcher->skip_depth && (type == JSON_TYPE_OBJECT_END || type == JSON_TYPE_ARRAY_END)) {
+            matcher->skip_depth = SIZE_MAX;
+        }
+        return true;
+    }
+
+    switch (type) {
+        case JSON_TYPE_OBJECT_END:
+        case JSON_TYPE_ARRAY_END:
+            matcher->depth--;
+            return true;
+        case JSON_TYPE_PROPERTY: {
+            const JsonPathStep* step = &matcher->path->steps[depth - 1];
+            matcher->frames[depth - 1].pending =
+                step->wildcard || (step->name && json_text_equals(stream, step->name, step->name_length));
+            return true;
+        }
+        case JSON_TYPE_COMMENT:
+        case JSON_TYPE_UNKNOWN:
+            return true;
+        default:
+            return json_path_value(matcher, stream, type, depth);
+    }
+}
+
+bool json_path_extract(JsonPathMatcher* matcher, JsonStream* stream) {
+    while (json_read(stream)) {
+        if (!json_path_next(matcher, stream)) {
+            return false;
+        }
+
+        JsonType type = json_token_type(stream);
+        bool skip_value = type == JSON_TYPE_PROPERTY && matcher->skip_depth == SIZE_MAX
+                       && !matcher->frames[json_current_depth(stream) - 1].pending;
+        bool skip_container = matcher->skip_depth == json_current_depth(stream)
+                           && (type == JSON_TYPE_OBJECT_START || type == JSON_TYPE_ARRAY_START);
+        if (!skip_value && !skip_container) {
+            continue;
+        }
+
+        // On a partial buffer json_try_skip rolls back when the subtree does not end in it; the remaining tokens
+        // then arrive here one by one and are dropped by json_path_next.
+        if (json_try_skip(stream)) {
+            matcher->skip_depth = SIZE_MAX;
+        } else if (json_has_error(stream)) {
+            return false;
+        }
+    }
+
+    return !json_has_error(stream);
+}
+
+static bool json_path_steps_equal(const JsonPathStep* a, const JsonPathStep* b) {
+    if (a->wildcard || b->wildcard) {
+        return a->wildcard == b->wildcard;
+    }
+
+    if (a->index != b->index || (a->name == NULL) != (b->name == NULL)) {
+        return false;
+    }
+
+    return !a->name || (a->name_length == b->name_length && memcmp(a->name, b->name, a->name_length) == 0);
+}
+
+static bool json_path_append(size_t** array, size_t* count, size_t value) {
+    size_t* values = realloc(*array, (*count + 1) * sizeof(size_t));
+    if (!values) {
+        return false;
+    }
+
+    values[(*count)++] = value;
+    *array = values;
+    return true;
+}
+
+static size_t json_path_set_child(JsonPathSet* set, size_t parent, const JsonPathStep* step) {
+    for (size_t i = 0; i < set->nodes[parent].child_count; i++) {
+        size_t child = set->nodes[parent].children[i];
+        if (json_path_steps_equal(set->nodes[child].step, step)) {
+            return child;
+        }
+    }
+
+    JsonPathNode* nodes = realloc(set->nodes, (set->node_count + 1) * sizeof(JsonPathNode));
+    if (!nodes) {
+        return JSON_PATH_NO_NODE;
+    }
+
+    set->nodes = nodes;
+    size_t child = set->node_count++;
+    nodes[child] = (JsonPathNode){.step = step, .wildcard = JSON_PATH_NO_NODE};
+
+    if (!json_path_append(&nodes[parent].children, &nodes[parent].child_count, child)) {
+        return JSON_PATH_NO_NODE;
+    }
+
+    if (step->wildcard) {
+        nodes[parent].wildcard = child;
+    }
+
+    return child;
+}
+
+// Groups the named children by name so one table lookup finds every child a member name leads to.
+static bool json_path_node_index_names(JsonPathNode* node, const JsonPathNode* nodes) {
+    if (node->child_count == 0) {
+        return true;
+    }
+
+    node->names = malloc(node->child_count * sizeof(const char*));
+    node->name_offsets = malloc((node->child_count + 1) * sizeof(size_t));
+    node->name_children = malloc(node->child_count * sizeof(size_t));
+    if (!node->names || !node->name_offsets || !node->name_children) {
+        return false;
+    }
+
+    for (size_t i = 0; i < node->child_count; i++) {
+        const JsonPathStep* step = nodes[node->children[i]].step;
+        if (!step->name) {
+            continue;
+        }
+
+        size_t k = 0;
+        while (k < node->name_count && strcmp(node->names[k], step->name) != 0) {
+            k++;
+        }
+        if (k == node->name_count) {
+            node->names[node->name_count++] = step->name;
+        }
+    }
+
+    size_t filled = 0;
+    for (size_t k = 0; k < node->name_count; k++) {
+        node->name_offsets[k] = filled;
+        for (size_t i = 0; i < node->child_count; i++) {
+            const JsonPathStep* step = nodes[node->children[i]].step;
+            if (step->name && strcmp(node->names[k], step->name) == 0) {
+                node->name_children[filled++] = node->children[i];
+            }
+        }
+    }
+    node->name_offsets[node->name_count] = filled;
+
+    return node->name_count == 0 || json_property_table_init(&node->name_table, node->names, node->name_count);
+}
+
+bool json_path_set_init(JsonPathSet* set, const JsonPath* paths, size_t path_count) {
+    *set = (JsonPathSet){.paths = paths, .path_count = path_count};
+
+    set->nodes = malloc(sizeof(JsonPathNode));
+    if (!set->nodes) {
+        return false;
+    }
+    set->nodes[0] = (JsonPathNode){.step = NULL, .wildcard = JSON_PATH_NO_NODE};
+    set->node_count = 1;
+
+    for (size_t query = 0; query < path_count; query++) {
+        size_t node = 0;
+        for (size_t i = 0; i < paths[query].step_count; i++) {
+            node = json_path_set_child(set, node, &paths[query].steps[i]);
+            if (node == JSON_PATH_NO_NODE) {
+                goto error;
+            }
+        }
+
+        if (!json_path_append(&set->nodes[node].queries, &set->nodes[node].query_count, query)) {
+            goto error;
+        }
+    }
+
+    for (size_t i = 0; i < set->node_count; i++) {
+        if (!json_path_node_index_names(&set->nodes[i], set->nodes)) {
+            goto error;
+        }
+    }
+
+    return true;
+
+error:
+    json_path_set_free(set);
+    return false;
+}
+
+void json_path_set_free(JsonPathSet* set) {
+    for (size_t i = 0; i < set->node_count; i++) {
+        JsonPathNode* node = &set->nodes[i];
+        if (node->name_count > 0) {
+            json_property_table_free(&node->name_table);
+        }
+        free(node->queries);
+        free(node->children);
+        free(node->names);
+        free(node->name_offsets);
+        free(node->name_children);
+    }
+
+    free(set->nodes);
+    *set = (JsonPathSet){0};
+}
+
+void json_path_set_matcher_init(
+    JsonPathSetMatcher* matcher,
+    const JsonPathSet* set,
+    JsonPathSetCallback callback,
+    void* context
+) {
+    *matcher = (JsonPathSetMatcher){
+        .set = set,
+        .callback = callback,
+        .context = context,
+        .frames = NULL,
+        .depth = 0,
+        .capacity = 0,
+        .active = NULL,
+        .active_capacity = 0,
+        .pending_count = 0,
+        .skip_depth = SIZE_MAX,
+        .match_count = 0,
+        .skipped_count = 0,
+        .stopped = false,
+    };
+}
+
+void json_path_set_matcher_free(JsonPathSetMatcher* matcher) {
+    free(matcher->frames);
+    free(matcher->active);
+    matcher->frames = NULL;
+    matcher->active = NULL;
+    matcher->depth = 0;
+    matcher->capacity = 0;
+    matcher->active_capacity = 0;
+}
+
+static bool json_path_set_add_active(JsonPathSetMatcher* matcher, JsonStream* stream, size_t position, size_t node) {
+    if (position == matcher->active_capacity) {
+        size_t capacity = matcher->active_capacity ? matcher->active_capacity * 2 : 32;
+        size_t* active = realloc(matcher->active, capacity * sizeof(size_t));
+        if (!active) {
+            json_throw(stream, JSON_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+        matcher->active = active;
+        matcher->active_capacity = capacity;
+    }
+
+    matcher->active[position] = node;
+    return true;
+}
+
+static size_t json_path_set_base(const JsonPathSetMatcher* matcher) {
+    if (matcher->depth == 0) {
+        return 0;
+    }
+
+    const JsonPathSetFrame* frame = &matcher->frames[matcher->depth - 1];
+    return frame->offset + frame->count;
+}
+
+static bool json_path_set_property(JsonPathSetMatcher* matcher, JsonStream* stream) {
+    const JsonPathSetFrame* frame = &matcher->frames[matcher->depth - 1];
+    const JsonPathNode* nodes = matcher->set->nodes;
+    size_t base = json_path_set_base(matcher);
+    size_t count = 0;
+
+    for (size_t i = 0; i < frame->count; i++) {
+        const JsonPathNode* node = &nodes[matcher->active[frame->offset + i]];
+        if (node->name_count > 0) {
+            int k = json_match_property(stream, &node->name_table);
+            if (k != JSON_PROPERTY_NOT_FOUND) {
+                for (size_t j = node->name_offsets[k]; j < node->name_offsets[k + 1]; j++) {
+                    if (!json_path_set_add_active(matcher, stream, base + count++, node->name_children[j])) {
+                        return false;
+                    }
+                }
+            }
+        }
+
+        if (node->wildcard != JSON_PATH_NO_NODE
+            && !json_path_set_add_active(matcher, stream, base + count++, node->wildcard))
+        {
+            return false;
+        }
+    }
+
+    matcher->pending_count = count;
+    return true;
+}
+
+static bool json_path_set_element(JsonPathSetMatcher* matcher, JsonStream* stream, size_t* out_count) {
+    const JsonPathSetFrame* frame = &matcher->frames[matcher->depth - 1];
+    const JsonPathNode* nodes = matcher->set->nodes;
+    size_t base = json_path_set_base(matcher);
+    size_t count = 0;
+
+    for (size_t i = 0; i < frame->count; i++) {
+        const JsonPathNode* node = &nodes[matcher->active[frame->offset + i]];
+        for (size_t j = 0; j < node->child_count; j++) {
+            size_t child = node->children[j];
+            if ((nodes[child].step->wildcard || nodes[child].step->index == frame->index)
+                && !json_path_set_add_active(matcher, stream, base + count++, child))
+            {
+                return false;
+            }
+        }
+    }
+
+    *out_count = count;
+    return true;
+}
+
+// Finds the smallest query after previous (SIZE_MAX before the first) among the active nodes that reached the value.
+static bool json_path_set_next_query(
+    const JsonPathSetMatcher* matcher,
+    size_t base,
+    size_t count,
+    size_t previous,
+    size_t* out_query
+) {
+    size_t next = SIZE_MAX;
+    for (size_t i = 0; i < count; i++) {
+        const JsonPathNode* node = &matcher->set->nodes[matcher->active[base + i]];
+        for (size_t j = 0; j < node->query_count; j++) {
+            size_t query = node->queries[j];
+            if ((previous == SIZE_MAX || query > previous) && query < next) {
+                next = query;
+            }
+        }
+    }
+
+    *out_query = next;
+    return next != SIZE_MAX;
+}
+
+static bool json_path_set_value(JsonPathSetMatcher* matcher, JsonStream* stream, JsonType type, size_t depth) {
+    bool is_container = type == JSON_TYPE_OBJECT_START || type == JSON_TYPE_ARRAY_START;
+    size_t base = json_path_set_base(matcher);
+    size_t count;
+
+    if (depth == 0) {
+        if (!json_path_set_add_active(matcher, stream, 0, 0)) {
+            return false;
+        }
+        count = 1;
+    } else {
+        JsonPathSetFrame* parent = &matcher->frames[depth - 1];
+        if (parent->is_object) {
+            count = matcher->pending_count;
+        } else if (!json_path_set_element(matcher, stream, &count)) {
+            return false;
+        }
+        parent->index++;
+        matcher->pending_count = 0;
+    }
+
+    // The matches fire in query order. One that consumes the value ends it: the later ones cannot see it, so they are
+    // counted as skipped, and there is nothing left to descend into.
+    size_t consumed = json_total_bytes_consumed(stream);
+    size_t previous = SIZE_MAX;
+    size_t query;
+    while (json_path_set_next_query(matcher, base, count, previous, &query)) {
+        if (json_total_bytes_consumed(stream) != consumed) {
+            matcher->skipped_count++;
+        } else {
+            matcher->match_count++;
+            if (!matcher->callback(stream, query, matcher->context)) {
+                matcher->stopped = true;
+                return false;
+            }
+
+            if (json_has_error(stream)) {
+                return false;
+            }
+        }
+        previous = query;
+    }
+
+    if (json_total_bytes_consumed(stream) != consumed) {
+        return true;
+    }
+
+    size_t live = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (matcher->set->nodes[matcher->active[base + i]].child_count > 0) {
+            matcher->active[base + live++] = matcher->active[base + i];
+        }
+    }
+
+    if (!is_container) {
+        return true;
+    }
+
+    if (live == 0) {
+        matcher->skip_depth = depth;
+        return true;
+    }
+
+    if (matcher->depth == matcher->capacity) {
+        size_t capacity = matcher->capacity ? matcher->capacity * 2 : 16;
+        JsonPathSetFrame* frames = realloc(matcher->frames, capacity * sizeof(JsonPathSetFrame));
+        if (!frames) {
+            json_throw(stream, JSON_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+        matcher->frames = frames;
+        matcher->capacity = capacity;
+    }
+
+    matcher->frames[matcher->depth++] = (JsonPathSetFrame){
+        .offset = base,
+        .count = live,
+        .index = 0,
+        .is_object = type == JSON_TYPE_OBJECT_START,
+    };
+    return true;
+}
+
+bool json_path_set_next(JsonPathSetMatcher* matcher, JsonStream* stream) {
+    if (matcher->stopped) {
+        return false;
+    }
+
+    JsonType type = json_token_type(stream);
+    size_t depth = json_current_depth(stream);
+
+    if (matcher->skip_depth != SIZE_MAX) {
+        if (depth == matcher->skip_depth && (type == JSON_TYPE_OBJECT_END || type == JSON_TYPE_ARRAY_END)) {
+            matcher->skip_depth = SIZE_MAX;
+        }
+        return true;
+    }
+
+    switch (type) {
+        case JSON_TYPE_OBJECT_END:
+        case JSON_TYPE_ARRAY_END:
+            matcher->depth--;
+            return true;
+        case JSON_TYPE_PROPERTY:
+            return json_path_set_property(matcher, stream);
+        case JSON_TYPE_COMMENT:
+        case JSON_TYPE_UNKNOWN:
+            return true;
+        default:
+            return json_path_set_value(matcher, stream, type, depth);
+    }
+}
+
+bool json_path_set_extract(JsonPathSetMatcher* matcher, JsonStream* stream) {
+    while (json_read(stream)) {
+        if (!json_path_set_next(matcher, stream)) {
+            return false;
+        }
+
+        JsonType type = json_token_type(stream);
+        bool skip_value =
+            type == JSON_TYPE_PROPERTY && matcher->skip_depth == SIZE_MAX && matcher->pending_count == 0;
+        bool skip_container = matcher->skip_depth == json_current_depth(stream)
+                           && (type == JSON_TYPE_OBJECT_START || type == JSON_TYPE_ARRAY_START);
+        if (!skip_value && !skip_container) {
+            continue;
+        }
+
+        if (json_try_skip(stream)) {
+            matcher->skip_depth = SIZE_MAX;
+        } else if (json_has_error(stream)) {
+            return false;
+        }
+    }
+
+    return !json_has_error(stream);
+}
@@ -0,0 +1,235 @@
+#include "json_property_table.h"
+
+#include <limits.h>
+#include <string.h>
+
+#include "json_internal.h"
+
+#define JSON_PROPERTY_SEED_ATTEMPTS 32
+#define JSON_PROPERTY_MAX_DISPLACEMENT UINT16_MAX
+#define JSON_PROPERTY_KEYS_PER_BUCKET 4
+#define JSON_PROPERTY_EMPTY SIZE_MAX
+
+static uint64_t json_property_hash(const char* key, size_t length, uint64_t seed) {
+    uint64_t hash = seed ^ (length * 0x9E3779B97F4A7C15ULL);
+
+    while (length >= 8) {
+        uint64_t word;
+        memcpy(&word, key, sizeof(word));
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCDULL;
+        hash ^= hash >> 32;
+        key += 8;
+        length -= 8;
+    }
+
+    if (length > 0) {
+        uint64_t word = 0;
+        memcpy(&word, key, length);
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCDULL;
+    }
+
+    hash ^= hash >> 29;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    return hash ^ (hash >> 32);
+}
+
+static inline size_t json_property_slot(uint64_t hash, uint16_t displacement, size_t slot_mask) {
+    return (size_t)((hash >> 32) + displacement * ((hash >> 8) | 1)) & slot_mask;
+}
+
+static size_t json_property_next_power_of_two(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+// Hash-and-displace construction: keys are grouped into small buckets by their hash, and each bucket (largest
+// first) searches for a displacement that moves all of its keys into free slots.
+static bool json_property_table_try_seed(
+    JsonPropertyTable* table,
+    uint64_t seed,
+    uint64_t* hashes,
+    size_t* heads,
+    size_t* next,
+    size_t* placed,
+    bool* out_duplicate
+) {
+    size_t slot_count = table->slot_mask + 1;
+    size_t bucket_count = table->bucket_mask + 1;
+
+    for (size_t i = 0; i < slot_count; i++) {
+        table->slots[i] = (JsonPropertySlot){.key = NULL, .length = 0, .index = JSON_PROPERTY_NOT_FOUND};
+    }
+
+    size_t largest_bucket = 0;
+    for (size_t i = 0; i < bucket_count; i++) {
+        heads[i] = JSON_PROPERTY_EMPTY;
+        table->displacements[i] = 0;
+    }
+
+    for (size_t i = 0; i < table->key_count; i++) {
+        hashes[i] = json_property_hash(table->keys[i], strlen(table->keys[i]), seed);
+        size_t bucket = hashes[i] & table->bucket_mask;
+        next[i] = heads[bucket];
+        heads[bucket] = i;
+    }
+
+    for (size_t i = 0; i < bucket_count; i++) {
+        size_t size = 0;
+        for (size_t key = heads[i]; key != JSON_PROPERTY_EMPTY; key = next[key]) {
+            // Duplicate keys always share a bucket, so checking bucket mates is enough.
+            for (size_t other = next[key]; other != JSON_PROPERTY_EMPTY; other = next[other]) {
+                if (hashes[key] == hashes[other] && strcmp(table->keys[key], table->keys[other]) == 0) {
+                    *out_duplicate = true;
+                    return false;
+                }
+            }
+            size++;
+        }
+        largest_bucket = size > largest_bucket ? size : largest_bucket;
+    }
+
+    for (size_t size = largest_bucket; size > 0; size--) {
+        for (size_t bucket = 0; bucket < bucket_count; bucket++) {
+            size_t bucket_size = 0;
+            for (size_t key = heads[bucket]; key != JSON_PROPERTY_EMPTY; key = next[key]) {
+                bucket_size++;
+            }
+            if (bucket_size != size) {
+                continue;
+            }
+
+            bool found = false;
+            for (uint32_t displacement = 0; displacement <= JSON_PROPERTY_MAX_DISPLACEMENT && !found; displacement++) {
+                size_t placed_count = 0;
+                found = true;
+
+                for (size_t key = heads[bucket]; key != JSON_PROPERTY_EMPTY; key = next[key]) {
+                    size_t slot = json_property_slot(hashes[key], (uint16_t)displacement, table->slot_mask);
+                    if (table->slots[slot].key) {
+                        found = false;
+                        break;
+                    }
+
+                    table->slots[slot].key = table->keys[key];
+                    table->slots[slot].length = strlen(table->keys[key]);
+                    table->slots[slot].index = (int)key;
+                    placed[placed_count++] = slot;
+                }
+
+                if (found) {
+                    table->displacements[bucket] = (uint16_t)displacement;
+                } else {
+                    for (size_t i = 0; i < placed_count; i++) {
+                        table->slots[placed[i]] =
+                            (JsonPropertySlot){.key = NULL, .length = 0, .index = JSON_PROPERTY_NOT_FOUND};
+                    }
+                }
+            }
+
+            if (!found) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool json_property_table_init(JsonPropertyTable* table, const char* const* keys, size_t key_count) {
+    memset(table, 0, sizeof(JsonPropertyTable));
+    table->keys = keys;
+    table->key_count = key_count;
+
+    if (key_count > INT_MAX) {
+        return false;
+    }
+
+    size_t slot_count = json_property_next_power_of_two(key_count + key_count / 4 + 1);
+    size_t bucket_count = json_property_next_power_of_two(key_count / JSON_PROPERTY_KEYS_PER_BUCKET + 1);
+
+    table->slots = malloc(slot_count * sizeof(JsonPropertySlot));
+    table->displacements = malloc(bucket_count * sizeof(uint16_t));
+    table->slot_mask = slot_count - 1;
+    table->bucket_mask = bucket_count - 1;
+
+    uint64_t* hashes = malloc((key_count + 1) * sizeof(uint64_t));
+    size_t* heads = malloc(bucket_count * sizeof(size_t));
+    size_t* next = malloc((key_count + 1) * sizeof(size_t));
+    size_t* placed = malloc((key_count + 1) * sizeof(size_t));
+
+    bool result = false;
+    bool duplicate = false;
+    if (table->slots && table->displacements && hashes && heads && next && placed) {
+        for (uint64_t attempt = 0; attempt < JSON_PROPERTY_SEED_ATTEMPTS && !result && !duplicate; attempt++) {
+            table->seed = (attempt + 1) * 0x9E3779B97F4A7C15ULL;
+            result = json_property_table_try_seed(table, table->seed, hashes, heads, next, placed, &duplicate);
+        }
+    }
+
+    free(hashes);
+    free(heads);
+    free(next);
+    free(placed);
+
+    if (!result) {
+        json_property_table_free(table);
+    }
+
+    return result;
+}
+
+void json_property_table_free(JsonPropertyTable* table) {
+    free(table->slots);
+    free(table->displacements);
+    table->slots = NULL;
+    table->displacements = NULL;
+    table->slot_mask = 0;
+    table->bucket_mask = 0;
+}
+
+int json_property_table_find(const JsonPropertyTable* table, const char* key, size_t length) {
+    if (!table->slots) {
+        return JSON_PROPERTY_NOT_FOUND;
+    }
+
+    uint64_t hash = json_property_hash(key, length, table->seed);
+    uint16_t displacement = table->displacements[hash & table->bucket_mask];
+    const JsonPropertySlot* slot = &table->slots[json_property_slot(hash, displacement, table->slot_mask)];
+
+    if (slot->length == length && slot->key && memcmp(slot->key, key, length) == 0) {
+        return slot->index;
+    }
+
+    return JSON_PROPERTY_NOT_FOUND;
+}
+
+int json_match_property(JsonStream* stream, const JsonPropertyTable* table) {
+    if (stream->token_type != JSON_TYPE_PROPERTY && stream->token_type != JSON_TYPE_STRING) {
+        json_throw_string(
+            stream,
+            JSON_ERROR_INVALID_OPERATION_EXPECTED_STRING_COMPARISON,
+            json_token_type_name(stream->token_type)
+        );
+        return JSON_PROPERTY_NOT_FOUND;
+    }
+
+    if (!stream->value_is_escaped) {
+        return json_property_table_find(table, stream->buffer + stream->token_start, stream->token_size);
+    }
+
+    // Escaped names are rare; compare against each key without materializing the unescaped text.
+    for (size_t i = 0; i < table->key_count; i++) {
+        if (json_text_equals(stream, table->keys[i], strlen(table->keys[i]))) {
+            return (int)i;
+        }
+
+        if (stream->error.type != JSON_ERROR_NONE) {
+            break;
+        }
+    }
+
+    return JSON_PROPERTY_NOT_FOUND;
+}
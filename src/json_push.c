@@ -0,0 +1,198 @@
+#include "json_push.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "json_internal.h"
+
+// The tail grows by at least this much, and otherwise doubles, while a carried token waits for its end.
+#define JSON_PUSH_TAIL_STEP 256
+
+void json_push_init(JsonPushParser* parser, JsonPushCallbacks callbacks, void* context, JsonStreamOptions options) {
+    json_stream_init(&parser->stream, NULL, 0, false, options);
+    parser->callbacks = callbacks;
+    parser->context = context;
+    parser->tail = NULL;
+    parser->tail_length = 0;
+    parser->tail_capacity = 0;
+    parser->stopped = false;
+}
+
+void json_push_free(JsonPushParser* parser) {
+    json_stream_free_resources(&parser->stream);
+    free(parser->tail);
+    parser->tail = NULL;
+    parser->tail_length = 0;
+    parser->tail_capacity = 0;
+}
+
+void json_push_reset(JsonPushParser* parser) {
+    json_stream_reset(&parser->stream, NULL, 0, false);
+    parser->tail_length = 0;
+    parser->stopped = false;
+}
+
+static bool json_push_dispatch(JsonPushParser* parser) {
+    JsonPushTokenCallback callback = NULL;
+    switch (json_token_type(&parser->stream)) {
+        case JSON_TYPE_OBJECT_START:
+            callback = parser->callbacks.on_object_start;
+            break;
+        case JSON_TYPE_OBJECT_END:
+            callback = parser->callbacks.on_object_end;
+            break;
+        case JSON_TYPE_ARRAY_START:
+            callback = parser->callbacks.on_array_start;
+            break;
+        case JSON_TYPE_ARRAY_END:
+            callback = parser->callbacks.on_array_end;
+            break;
+        case JSON_TYPE_PROPERTY:
+            callback = parser->callbacks.on_property;
+            break;
+        case JSON_TYPE_STRING:
+            callback = parser->callbacks.on_string;
+            break;
+        case JSON_TYPE_NUMBER:
+            callback = parser->callbacks.on_number;
+            break;
+        case JSON_TYPE_BOOLEAN:
+            callback = parser->callbacks.on_boolean;
+            break;
+        case JSON_TYPE_NULL:
+            callback = parser->callbacks.on_null;
+            break;
+        case JSON_TYPE_COMMENT:
+            callback = parser->callbacks.on_comment;
+            break;
+        default:
+            break;
+    }
+
+    if (callback && !callback(&parser->stream, parser->context)) {
+        parser->stopped = true;
+        return false;
+    }
+
+    return true;
+}
+
+// Reads and dispatches tokens until the current buffer runs out. Returns false when stopped or on an error.
+static bool json_push_drain(JsonPushParser* parser) {
+    while (json_read(&parser->stream)) {
+        if (!json_push_dispatch(parser)) {
+            return false;
+        }
+    }
+
+    return parser->stream.error.type == JSON_ERROR_NONE;
+}
+
+static bool json_push_reserve(JsonPushParser* parser, size_t capacity) {
+    if (capacity <= parser->tail_capacity) {
+        return true;
+    }
+
+    size_t new_capacity = parser->tail_capacity ? parser->tail_capacity : JSON_PUSH_TAIL_STEP;
+    while (new_capacity < capacity) {
+        new_capacity *= 2;
+    }
+
+    char* tail = realloc(parser->tail, new_capacity);
+    if (!tail) {
+        json_throw(&parser->stream, JSON_ERROR_OUT_OF_MEMORY);
+        return false;
+    }
+
+    parser->tail = tail;
+    parser->tail_capacity = new_capacity;
+    return true;
+}
+
+bool json_push_feed(JsonPushParser* parser, const char* bytes, size_t length) {
+    JsonStream* stream = &parser->stream;
+    if (parser->stopped || stream->error.type != JSON_ERROR_NONE) {
+        return false;
+    }
+
+    // An empty buffer would put the stream into NUL-terminated mode.
+    if (length == 0) {
+        return true;
+    }
+
+    // The tail always starts at the stream's consumed position. While it holds a carried token, only enough of the
+    // fragment to complete that token is appended; once the stream moves past the carried bytes it switches over to
+    // the fragment itself.
+    size_t offset = 0;
+    size_t carried = parser->tail_length;
+    while (parser->tail_length > 0) {
+        if (offset == length) {
+            return true;
+        }
+
+        size_t take = parser->tail_length > JSON_PUSH_TAIL_STEP ? parser->tail_length : JSON_PUSH_TAIL_STEP;
+        take = take < length - offset ? take : length - offset;
+        if (!json_push_reserve(parser, parser->tail_length + take)) {
+            return false;
+        }
+        memcpy(parser->tail + parser->tail_length, bytes + offset, take);
+        parser->tail_length += take;
+        offset += take;
+
+        json_stream_continue(stream, stream, parser->tail, parser->tail_length, false);
+        while (stream->consumed < carried) {
+            if (!json_read(stream)) {
+                break;
+            }
+            if (!json_push_dispatch(parser)) {
+                return false;
+            }
+        }
+        if (stream->error.type != JSON_ERROR_NONE) {
+            return false;
+        }
+
+        if (stream->consumed >= carried) {
+            offset = stream->consumed - carried;
+            parser->tail_length = 0;
+            if (offset == length) {
+                return true;
+            }
+            break;
+        }
+
+        memmove(parser->tail, parser->tail + stream->consumed, parser->tail_length - stream->consumed);
+        parser->tail_length -= stream->consumed;
+        carried -= stream->consumed;
+    }
+
+    json_stream_continue(stream, stream, bytes + offset, length - offset, false);
+    if (!json_push_drain(parser)) {
+        return false;
+    }
+
+    size_t remaining = length - offset - stream->consumed;
+    if (remaining > 0) {
+        if (!json_push_reserve(parser, remaining)) {
+            return false;
+        }
+        memcpy(parser->tail, bytes + offset + stream->consumed, remaining);
+        parser->tail_length = remaining;
+    }
+
+    return true;
+}
+
+bool json_push_finish(JsonPushParser* parser) {
+    JsonStream* stream = &parser->stream;
+    if (parser->stopped || stream->error.type != JSON_ERROR_NONE) {
+        return false;
+    }
+
+    // With nothing carried over, an empty NUL-terminated buffer stands in for the end of the input.
+    const char* buffer = parser->tail_length > 0 ? parser->tail : "";
+    json_stream_continue(stream, stream, buffer, parser->tail_length, true);
+    bool result = json_push_drain(parser);
+    parser->tail_length = 0;
+    return result;
+}
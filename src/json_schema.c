@@ -0,0 +1,434 @@
+#include "json_schema.h"
+
+#include <string.h>
+
+#include "json_internal.h"
+
+static JsonSchema* json_schema_parse_value(JsonStream* stream);
+
+static JsonSchema* json_schema_create(unsigned types) {
+    JsonSchema* schema = calloc(1, sizeof(JsonSchema));
+    if (!schema) {
+        return NULL;
+    }
+
+    schema->types = types;
+    schema->additional_properties = true;
+    schema->max_items = SIZE_MAX;
+    schema->max_length = SIZE_MAX;
+    return schema;
+}
+
+static bool json_schema_invalid(JsonStream* stream, const char* keyword) {
+    if (stream->error.type == JSON_ERROR_NONE) {
+        json_throw_string(stream, JSON_ERROR_INVALID_SCHEMA, keyword);
+    }
+    return false;
+}
+
+static bool json_schema_read_string(JsonStream* stream, const char* keyword, char** out_string, size_t* out_length) {
+    if (!json_read(stream) || json_token_type(stream) != JSON_TYPE_STRING) {
+        return json_schema_invalid(stream, keyword);
+    }
+
+    return json_try_get_string_escaped(stream, NULL, 0, out_string, out_length);
+}
+
+static bool json_schema_read_number(JsonStream* stream, const char* keyword, double* out_number) {
+    if (!json_read(stream) || !json_try_get_double(stream, out_number)) {
+        return json_schema_invalid(stream, keyword);
+    }
+
+    return true;
+}
+
+static bool json_schema_read_size(JsonStream* stream, const char* keyword, size_t* out_size) {
+    double value;
+    if (!json_read(stream) || !json_try_get_double(stream, &value) || value < 0 || value != (double)(size_t)value) {
+        return json_schema_invalid(stream, keyword);
+    }
+
+    *out_size = (size_t)value;
+    return true;
+}
+
+static bool json_schema_type_from_name(JsonStream* stream, unsigned* types) {
+    static const struct {
+        const char* name;
+        unsigned type;
+    } names[] = {
+        {"null", JSON_SCHEMA_NULL},
+        {"boolean", JSON_SCHEMA_BOOLEAN},
+        {"object", JSON_SCHEMA_OBJECT},
+        {"array", JSON_SCHEMA_ARRAY},
+        {"number", JSON_SCHEMA_NUMBER},
+        {"string", JSON_SCHEMA_STRING},
+        {"integer", JSON_SCHEMA_INTEGER},
+    };
+
+    if (json_token_type(stream) == JSON_TYPE_STRING) {
+        for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+            if (json_text_equals(stream, names[i].name, strlen(names[i].name))) {
+                *types |= names[i].type;
+                return true;
+            }
+        }
+    }
+
+    return json_schema_invalid(stream, "type");
+}
+
+static bool json_schema_parse_type(JsonStream* stream, JsonSchema* schema) {
+    if (!json_read(stream)) {
+        return json_schema_invalid(stream, "type");
+    }
+
+    schema->types = 0;
+    if (json_token_type(stream) != JSON_TYPE_ARRAY_START) {
+        return json_schema_type_from_name(stream, &schema->types);
+    }
+
+    while (json_read(stream) && json_token_type(stream) != JSON_TYPE_ARRAY_END) {
+        if (!json_schema_type_from_name(stream, &schema->types)) {
+            return false;
+        }
+    }
+
+    return stream->error.type == JSON_ERROR_NONE;
+}
+
+static bool json_schema_parse_properties(JsonStream* stream, JsonSchema* schema) {
+    if (!json_read(stream) || json_token_type(stream) != JSON_TYPE_OBJECT_START) {
+        return json_schema_invalid(stream, "properties");
+    }
+
+    while (json_read(stream) && json_token_type(stream) == JSON_TYPE_PROPERTY) {
+        JsonSchemaProperty* properties =
+            realloc(schema->properties, (schema->property_count + 1) * sizeof(JsonSchemaProperty));
+        if (!properties) {
+            json_throw(stream, JSON_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+        schema->properties = properties;
+
+        JsonSchemaProperty* property = &schema->properties[schema->property_count];
+        *property = (JsonSchemaProperty){0};
+        if (!json_try_get_string_escaped(stream, NULL, 0, &property->name, &property->name_length)) {
+            return false;
+        }
+        schema->property_count++;
+
+        if (!json_read(stream)) {
+            return json_schema_invalid(stream, "properties");
+        }
+
+        property->schema = json_schema_parse_value(stream);
+        if (!property->schema) {
+            return false;
+        }
+    }
+
+    return stream->error.type == JSON_ERROR_NONE && json_token_type(stream) == JSON_TYPE_OBJECT_END;
+}
+
+static bool json_schema_parse_enum(JsonStream* stream, JsonSchema* schema) {
+    if (!json_read(stream) || json_token_type(stream) != JSON_TYPE_ARRAY_START) {
+        return json_schema_invalid(stream, "enum");
+    }
+
+    while (json_read(stream) && json_token_type(stream) != JSON_TYPE_ARRAY_END) {
+        JsonType type = json_token_type(stream);
+        if (type == JSON_TYPE_OBJECT_START || type == JSON_TYPE_ARRAY_START) {
+            return json_schema_invalid(stream, "enum");
+        }
+
+        JsonSchemaEnumValue* values =
+            realloc(schema->enum_values, (schema->enum_count + 1) * sizeof(JsonSchemaEnumValue));
+        if (!values) {
+            json_throw(stream, JSON_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+        schema->enum_values = values;
+
+        JsonSchemaEnumValue* value = &schema->enum_values[schema->enum_count];
+        *value = (JsonSchemaEnumValue){.type = type};
+
+        if (type == JSON_TYPE_STRING) {
+            if (!json_try_get_string_escaped(stream, NULL, 0, &value->text, &value->length)) {
+                return false;
+            }
+        } else {
+            value->length = json_token_size(stream);
+            value->text = malloc(value->length + 1);
+            if (!value->text) {
+                json_throw(stream, JSON_ERROR_OUT_OF_MEMORY);
+                return false;
+            }
+            memcpy(value->text, stream->buffer + stream->token_start, value->length);
+            value->text[value->length] = '\0';
+        }
+        schema->enum_count++;
+    }
+
+    return stream->error.type == JSON_ERROR_NONE;
+}
+
+typedef struct JsonSchemaNames {
+    char** names;
+    size_t* lengths;
+    size_t count;
+} JsonSchemaNames;
+
+static bool json_schema_parse_required(JsonStream* stream, JsonSchemaNames* required) {
+    if (!json_read(stream) || json_token_type(stream) != JSON_TYPE_ARRAY_START) {
+        return json_schema_invalid(stream, "required");
+    }
+
+    while (json_read(stream) && json_token_type(stream) != JSON_TYPE_ARRAY_END) {
+        if (json_token_type(stream) != JSON_TYPE_STRING) {
+            return json_schema_invalid(stream, "required");
+        }
+
+        char** names = realloc(required->names, (required->count + 1) * sizeof(char*));
+        if (names) {
+            required->names = names;
+        }
+        size_t* lengths = realloc(required->lengths, (required->count + 1) * sizeof(size_t));
+        if (lengths) {
+            required->lengths = lengths;
+        }
+        if (!names || !lengths) {
+            json_throw(stream, JSON_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+
+        if (!json_try_get_string_escaped(
+                stream,
+                NULL,
+                0,
+                &required->names[required->count],
+                &required->lengths[required->count]
+            ))
+        {
+            return false;
+        }
+        required->count++;
+    }
+
+    return stream->error.type == JSON_ERROR_NONE;
+}
+
+// Takes ownership of name.
+static bool json_schema_mark_required(JsonStream* stream, JsonSchema* schema, char* name, size_t length) {
+    for (size_t i = 0; i < schema->property_count; i++) {
+        if (schema->properties[i].name_length == length && memcmp(schema->properties[i].name, name, length) == 0) {
+            schema->properties[i].required = true;
+            free(name);
+            return true;
+        }
+    }
+
+    // Required but not described: keep it as an unconstrained property.
+    JsonSchemaProperty* properties =
+        realloc(schema->properties, (schema->property_count + 1) * sizeof(JsonSchemaProperty));
+    if (!properties) {
+        free(name);
+        json_throw(stream, JSON_ERROR_OUT_OF_MEMORY);
+        return false;
+    }
+    schema->properties = properties;
+    schema->properties[schema->property_count++] =
+        (JsonSchemaProperty){.name = name, .name_length = length, .required = true, .schema = NULL};
+    return true;
+}
+
+static bool json_schema_parse_keyword(JsonStream* stream, JsonSchema* schema, JsonSchemaNames* required) {
+    if (json_text_equals(stream, "type", 4)) {
+        return json_schema_parse_type(stream, schema);
+    }
+
+    if (json_text_equals(stream, "properties", 10)) {
+        return json_schema_parse_properties(stream, schema);
+    }
+
+    if (json_text_equals(stream, "required", 8)) {
+        return json_schema_parse_required(stream, required);
+    }
+
+    if (json_text_equals(stream, "items", 5)) {
+        if (!json_read(stream)) {
+            return json_schema_invalid(stream, "items");
+        }
+        if (json_token_type(stream) == JSON_TYPE_ARRAY_START) {
+            // Tuple validation is outside the supported subset.
+            return json_skip(stream);
+        }
+        json_schema_free(schema->items);
+        schema->items = json_schema_parse_value(stream);
+        return schema->items != NULL;
+    }
+
+    if (json_text_equals(stream, "additionalProperties", 20)) {
+        if (!json_read(stream)) {
+            return json_schema_invalid(stream, "additionalProperties");
+        }
+        if (json_token_type(stream) == JSON_TYPE_BOOLEAN) {
+            return json_try_get_bool(stream, &schema->additional_properties);
+        }
+        return json_skip(stream);
+    }
+
+    if (json_text_equals(stream, "enum", 4)) {
+        return json_schema_parse_enum(stream, schema);
+    }
+
+    if (json_text_equals(stream, "title", 5)) {
+        return json_schema_read_string(stream, "title", &schema->title, NULL);
+    }
+
+    if (json_text_equals(stream, "format", 6)) {
+        return json_schema_read_string(stream, "format", &schema->format, NULL);
+    }
+
+    if (json_text_equals(stream, "pattern", 7)) {
+        return json_schema_read_string(stream, "pattern", &schema->pattern, NULL);
+    }
+
+    if (json_text_equals(stream, "minimum", 7)) {
+        schema->has_minimum = true;
+        return json_schema_read_number(stream, "minimum", &schema->minimum);
+    }
+
+    if (json_text_equals(stream, "maximum", 7)) {
+        schema->has_maximum = true;
+        return json_schema_read_number(stream, "maximum", &schema->maximum);
+    }
+
+    if (json_text_equals(stream, "exclusiveMinimum", 16)) {
+        schema->has_minimum = true;
+        schema->exclusive_minimum = true;
+        return json_schema_read_number(stream, "exclusiveMinimum", &schema->minimum);
+    }
+
+    if (json_text_equals(stream, "exclusiveMaximum", 16)) {
+        schema->has_maximum = true;
+        schema->exclusive_maximum = true;
+        return json_schema_read_number(stream, "exclusiveMaximum", &schema->maximum);
+    }
+
+    if (json_text_equals(stream, "minLength", 9)) {
+        return json_schema_read_size(stream, "minLength", &schema->min_length);
+    }
+
+    if (json_text_equals(stream, "maxLength", 9)) {
+        return json_schema_read_size(stream, "maxLength", &schema->max_length);
+    }
+
+    if (json_text_equals(stream, "minItems", 8)) {
+        return json_schema_read_size(stream, "minItems", &schema->min_items);
+    }
+
+    if (json_text_equals(stream, "maxItems", 8)) {
+        return json_schema_read_size(stream, "maxItems", &schema->max_items);
+    }
+
+    return json_skip(stream);
+}
+
+static JsonSchema* json_schema_parse_value(JsonStream* stream) {
+    if (json_token_type(stream) == JSON_TYPE_BOOLEAN) {
+        bool value = json_get_bool(stream);
+        JsonSchema* schema = json_schema_create(value ? JSON_SCHEMA_ANY : 0);
+        if (!schema) {
+            json_throw(stream, JSON_ERROR_OUT_OF_MEMORY);
+        }
+        return schema;
+    }
+
+    if (json_token_type(stream) != JSON_TYPE_OBJECT_START) {
+        json_schema_invalid(stream, "schema");
+        return NULL;
+    }
+
+    JsonSchema* schema = json_schema_create(JSON_SCHEMA_ANY);
+    if (!schema) {
+        json_throw(stream, JSON_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    // Property declarations may follow the required list, so names are resolved once the object is complete.
+    JsonSchemaNames required = {0};
+    size_t resolved = 0;
+    while (json_read(stream) && json_token_type(stream) == JSON_TYPE_PROPERTY) {
+        if (!json_schema_parse_keyword(stream, schema, &required)) {
+            goto error;
+        }
+    }
+
+    if (stream->error.type != JSON_ERROR_NONE || json_token_type(stream) != JSON_TYPE_OBJECT_END) {
+        goto error;
+    }
+
+    for (; resolved < required.count; resolved++) {
+        if (!json_schema_mark_required(stream, schema, required.names[resolved], required.lengths[resolved])) {
+            resolved++;
+            goto error;
+        }
+    }
+
+    free(required.names);
+    free(required.lengths);
+    return schema;
+
+error:
+    for (size_t i = resolved; i < required.count; i++) {
+        free(required.names[i]);
+    }
+    free(required.names);
+    free(required.lengths);
+    json_schema_free(schema);
+    return NULL;
+}
+
+bool json_schema_parse(JsonStream* stream, JsonSchema** out_schema) {
+    *out_schema = NULL;
+    if (!json_read(stream)) {
+        return json_schema_invalid(stream, "schema");
+    }
+
+    *out_schema = json_schema_parse_value(stream);
+    return *out_schema != NULL;
+}
+
+void json_schema_free(JsonSchema* schema) {
+    if (!schema) {
+        return;
+    }
+
+    for (size_t i = 0; i < schema->property_count; i++) {
+        free(schema->properties[i].name);
+        json_schema_free(schema->properties[i].schema);
+    }
+    free(schema->properties);
+
+    for (size_t i = 0; i < schema->enum_count; i++) {
+        free(schema->enum_values[i].text);
+    }
+    free(schema->enum_values);
+
+    json_schema_free(schema->items);
+    free(schema->title);
+    free(schema->format);
+    free(schema->pattern);
+    free(schema);
+}
+
+const JsonSchemaProperty* json_schema_find_property(const JsonSchema* schema, const char* name, size_t length) {
+    for (size_t i = 0; i < schema->property_count; i++) {
+        if (schema->properties[i].name_length == length && memcmp(schema->properties[i].name, name, length) == 0) {
+            return &schema->properties[i];
+        }
+    }
+
+    return NULL;
+}
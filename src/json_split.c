@@ -0,0 +1,235 @@
+#include "json_split.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define JSON_SPLIT_BLOCK_SIZE 64
+#define JSON_SPLIT_EVEN_BITS 0x5555555555555555ull
+
+typedef enum {
+    JSON_SPLIT_BETWEEN,
+    JSON_SPLIT_CONTAINER,
+    JSON_SPLIT_STRING,
+    JSON_SPLIT_SCALAR,
+} JsonSplitState;
+
+// One bit per byte of a block.
+typedef struct JsonSplitMasks {
+    uint64_t quote;
+    uint64_t backslash;
+    uint64_t open;
+    uint64_t close;
+    uint64_t whitespace;
+} JsonSplitMasks;
+
+typedef struct JsonSplitter {
+    JsonSplitState state;
+    size_t depth;
+    size_t start;
+    size_t end;
+    uint64_t escaped_carry;
+    uint64_t string_carry;
+    JsonSplitCallback callback;
+    void* context;
+    bool stopped;
+} JsonSplitter;
+
+static void json_split_classify(const char* block, JsonSplitMasks* masks) {
+    memset(masks, 0, sizeof(JsonSplitMasks));
+
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    // '[' and '{' differ only in 0x20, as do ']' and '}'.
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+    const __m128i open = _mm_set1_epi8('{');
+    const __m128i close = _mm_set1_epi8('}');
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i line_feed = _mm_set1_epi8('\n');
+    const __m128i carriage_return = _mm_set1_epi8('\r');
+    for (size_t i = 0; i < JSON_SPLIT_BLOCK_SIZE; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(block + i));
+        __m128i folded = _mm_or_si128(chunk, case_bit);
+        __m128i whitespace = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, line_feed), _mm_cmpeq_epi8(chunk, carriage_return))
+        );
+        masks->quote |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote)) << i;
+        masks->backslash |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, backslash)) << i;
+        masks->open |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(folded, open)) << i;
+        masks->close |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(folded, close)) << i;
+        masks->whitespace |= (uint64_t)(uint16_t)_mm_movemask_epi8(whitespace) << i;
+    }
+#else
+    for (size_t i = 0; i < JSON_SPLIT_BLOCK_SIZE; i++) {
+        uint64_t bit = 1ull << i;
+        switch (block[i]) {
+            case '"':
+                masks->quote |= bit;
+                break;
+            case '\\':
+                masks->backslash |= bit;
+                break;
+            case '[':
+            case '{':
+                masks->open |= bit;
+                break;
+            case ']':
+            case '}':
+                masks->close |= bit;
+                break;
+            case ' ':
+            case '\t':
+            case '\n':
+            case '\r':
+                masks->whitespace |= bit;
+                break;
+            default:
+                break;
+        }
+    }
+#endif
+}
+
+// Marks the characters preceded by an odd run of backslashes. A run that ends the block carries into the next one.
+static uint64_t json_split_escaped(uint64_t backslash, uint64_t* carry) {
+    backslash &= ~*carry;
+    uint64_t follows_escape = backslash << 1 | *carry;
+    uint64_t odd_starts = backslash & ~JSON_SPLIT_EVEN_BITS & ~follows_escape;
+    uint64_t even_runs;
+    *carry = __builtin_add_overflow(odd_starts, backslash, &even_runs) ? 1 : 0;
+    return (JSON_SPLIT_EVEN_BITS ^ (even_runs << 1)) & follows_escape;
+}
+
+// Sets every bit from an opening quote up to, but not including, its closing quote.
+static uint64_t json_split_prefix_xor(uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+static void json_split_emit(JsonSplitter* splitter, size_t end) {
+    splitter->state = JSON_SPLIT_BETWEEN;
+    splitter->end = end;
+    if (!splitter->callback(splitter->start, end, splitter->context)) {
+        splitter->stopped = true;
+    }
+}
+
+// Steps through the bytes of a block where a value may start or end.
+static void json_split_walk(
+    JsonSplitter* splitter,
+    const JsonSplitMasks* masks,
+    uint64_t in_string,
+    size_t offset,
+    size_t length
+) {
+    for (size_t i = 0; i < length && !splitter->stopped; i++) {
+        uint64_t bit = 1ull << i;
+        bool string = (in_string & bit) != 0;
+        if (splitter->state == JSON_SPLIT_SCALAR) {
+            if (!string && !(masks->whitespace & bit) && !(masks->open & bit)) {
+                continue;
+            }
+            // The byte that ends a scalar may start the next value.
+            json_split_emit(splitter, offset + i);
+            if (splitter->stopped) {
+                return;
+            }
+        }
+
+        switch (splitter->state) {
+            case JSON_SPLIT_BETWEEN:
+                if (masks->whitespace & bit) {
+                    break;
+                }
+                splitter->start = offset + i;
+                if (string) {
+                    splitter->state = JSON_SPLIT_STRING;
+                } else if (masks->open & bit) {
+                    splitter->state = JSON_SPLIT_CONTAINER;
+                    splitter->depth = 1;
+                } else {
+                    splitter->state = JSON_SPLIT_SCALAR;
+                }
+                break;
+            case JSON_SPLIT_STRING:
+                if (!string) {
+                    json_split_emit(splitter, offset + i + 1);
+                }
+                break;
+            case JSON_SPLIT_CONTAINER:
+                if (masks->open & bit) {
+                    splitter->depth++;
+                } else if ((masks->close & bit) && --splitter->depth == 0) {
+                    json_split_emit(splitter, offset + i + 1);
+                }
+                break;
+            case JSON_SPLIT_SCALAR:
+                break;
+        }
+    }
+}
+
+static void json_split_block(JsonSplitter* splitter, const char* block, size_t offset, size_t length) {
+    JsonSplitMasks masks;
+    json_split_classify(block, &masks);
+    uint64_t quotes = masks.quote & ~json_split_escaped(masks.backslash, &splitter->escaped_carry);
+    uint64_t in_string = json_split_prefix_xor(quotes) ^ splitter->string_carry;
+    splitter->string_carry = (uint64_t)((int64_t)in_string >> 63);
+    masks.open &= ~in_string;
+    masks.close &= ~in_string;
+
+    // Inside a container, a block with fewer closing brackets than the depth cannot end the value.
+    size_t closes = (size_t)__builtin_popcountll(masks.close);
+    if (splitter->state == JSON_SPLIT_CONTAINER && splitter->depth > closes) {
+        splitter->depth = splitter->depth + (size_t)__builtin_popcountll(masks.open) - closes;
+        return;
+    }
+    if (splitter->state == JSON_SPLIT_STRING && in_string == UINT64_MAX) {
+        return;
+    }
+
+    json_split_walk(splitter, &masks, in_string, offset, length);
+}
+
+size_t json_split_values(
+    const char* buffer,
+    size_t size,
+    bool is_final_block,
+    JsonSplitCallback callback,
+    void* context
+) {
+    JsonSplitter splitter = {0};
+    splitter.state = JSON_SPLIT_BETWEEN;
+    splitter.callback = callback;
+    splitter.context = context;
+
+    size_t offset = 0;
+    for (; size - offset >= JSON_SPLIT_BLOCK_SIZE && !splitter.stopped; offset += JSON_SPLIT_BLOCK_SIZE) {
+        json_split_block(&splitter, buffer + offset, offset, JSON_SPLIT_BLOCK_SIZE);
+    }
+
+    if (offset < size && !splitter.stopped) {
+        // The padding is whitespace, and only the real bytes are walked.
+        char block[JSON_SPLIT_BLOCK_SIZE];
+        memset(block, ' ', sizeof(block));
+        memcpy(block, buffer + offset, size - offset);
+        json_split_block(&splitter, block, offset, size - offset);
+    }
+
+    if (splitter.state == JSON_SPLIT_SCALAR && is_final_block && !splitter.stopped) {
+        json_split_emit(&splitter, size);
+    }
+
+    return splitter.end;
+}
@@ -9,9 +9,16 @@
 #include <stdio.h>
 
 #include "bit_stack.h"
+#include "json_internal.h"
+#include "json_tape.h"
+#include "json_utf8.h"
 
 #include <string.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 typedef enum {
     JSON_CONSUME_NUMBER_SUCCESS,
     JSON_CONSUME_NUMBER_ERROR,
@@ -43,6 +50,30 @@ typedef struct JsonRollbackState {
 #define JSON_STREAM_OUT_OF_BOUNDS(stream, position) \
     JSON_BUFFER_OUT_OF_BOUNDS(stream->buffer, stream->buffer_size, position)
 
+// The comment helpers take a length of SIZE_MAX for a NUL-terminated buffer, so that an empty partial buffer stays
+// distinguishable from one.
+#define JSON_SPAN_OUT_OF_BOUNDS(buffer, length, position) ((position) >= (length) || (buffer)[position] == '\0')
+
+#define JSON_HEX_INVALID 0xFF
+
+static const uint8_t json_hex_values[256] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
 
 static bool json_read_single_segment(JsonStream* stream);
 
@@ -95,7 +126,11 @@ static bool json_helper_count_new_lines(
 
 static bool json_consume_string(JsonStream* stream);
 
-static bool json_consume_string_and_validate(JsonStream* stream, const char* buffer, size_t buffer_size, size_t index);
+static bool json_consume_string_and_validate(JsonStream* stream, const char* buffer, size_t length, size_t index);
+
+static size_t json_scan_string(const char* buffer, size_t length);
+
+static bool json_end_of_string(JsonStream* stream, size_t index, bool escaped);
 
 static bool json_validate_hex_digits(
     JsonStream* stream,
@@ -105,6 +140,10 @@ static bool json_validate_hex_digits(
     bool* threw
 );
 
+static bool json_validate_utf8_buffer(JsonStream* stream);
+
+static bool json_validate_utf8_string(JsonStream* stream, const char* string, size_t length, size_t quote_position);
+
 static bool json_try_get_number(
     JsonStream* stream,
     const char* buffer,
@@ -170,8 +209,12 @@ static bool json_skip_single_line_comment(
     size_t* out_index
 );
 
+static size_t json_scan_line_separator(const char* buffer, size_t length);
+
 static bool json_find_line_separator(JsonStream* stream, const char* buffer, size_t buffer_length, size_t* out_index);
 
+static size_t json_scan_comment_end(const char* buffer, size_t length);
+
 static bool json_skip_multiline_comment(
     JsonStream* stream,
     const char* buffer,
@@ -205,11 +248,40 @@ static bool json_unescape(
     bool* out_full
 );
 
+static bool json_unescape_buffer(
+    JsonStream* stream,
+    const char* source,
+    size_t source_length,
+    char* destination,
+    size_t destination_length,
+    size_t* out_written,
+    bool* out_full
+);
+
+static size_t json_copy_until_backslash(
+    const char* source,
+    size_t source_length,
+    char* destination,
+    size_t destination_length
+);
+
+static size_t json_decode_escape(
+    JsonStream* stream,
+    const char* source,
+    size_t source_length,
+    char* out,
+    size_t* out_length
+);
+
+static bool json_decode_hex(const char* source, uint32_t* out_value);
+
+static size_t json_encode_utf8(uint32_t code_point, char* out);
+
 static inline bool json_is_token_type_string(const JsonStream* stream) {
     return stream->token_type == JSON_TYPE_STRING || stream->token_type == JSON_TYPE_PROPERTY;
 }
 
-static void json_throw(JsonStream* stream, JsonErrorType type) {
+void json_throw(JsonStream* stream, JsonErrorType type) {
     stream->error.type = type;
     stream->error.column = stream->byte_position_in_line;
     stream->error.line = stream->line_number;
@@ -219,34 +291,46 @@ static void json_throw(JsonStream* stream, JsonErrorType type) {
     }
 }
 
-static void json_throw_char(JsonStream* stream, JsonErrorType type, char c) {
+void json_throw_char(JsonStream* stream, JsonErrorType type, char c) {
     stream->error.character = c;
     json_throw(stream, type);
 }
 
-static void json_throw_string(JsonStream* stream, JsonErrorType type, const char* string) {
+void json_throw_string(JsonStream* stream, JsonErrorType type, const char* string) {
     stream->error.string = string;
     json_throw(stream, type);
 }
 
-static void json_throw_number(JsonStream* stream, JsonErrorType type, int64_t number) {
+void json_throw_number(JsonStream* stream, JsonErrorType type, int64_t number) {
     stream->error.number = number;
     json_throw(stream, type);
 }
 
-static void json_throw_slice(JsonStream* stream, JsonErrorType type, const char* string, int slice_length) {
+void json_throw_slice(JsonStream* stream, JsonErrorType type, const char* string, int slice_length) {
     stream->error.string = string;
     stream->error.slice_length = slice_length;
     json_throw(stream, type);
 }
 
 void json_stream_init(JsonStream* stream, const char* buffer, size_t buffer_size, bool is_final_block, JsonStreamOptions options) {
-    stream->buffer = buffer;
-    stream->buffer_size = buffer_size;
-    stream->error = (JsonError){0};
     stream->error_handler = options.error_handler;
     stream->error_context = options.error_context;
+    stream->max_depth = options.max_depth;
+    stream->allow_multiple_values = options.allow_multiple_values;
+    stream->allow_trailing_commas = options.allow_trailing_commas;
+    stream->comment_handling = options.comment_handling;
+    stream->validate_utf8 = options.validate_utf8;
     json_z_bits_init(&stream->bits);
+    stream->scratch = NULL;
+    stream->scratch_capacity = 0;
+    json_stream_reset(stream, buffer, buffer_size, is_final_block);
+}
+
+void json_stream_reset(JsonStream* stream, const char* buffer, size_t buffer_size, bool is_final_block) {
+    stream->buffer = buffer;
+    stream->buffer_size = buffer_size;
+    stream->error = (JsonError){0};
+    json_z_bits_reset(&stream->bits);
     stream->is_final_block = is_final_block;
     stream->line_number = 0;
     stream->byte_position_in_line = 0;
@@ -255,15 +339,18 @@ void json_stream_init(JsonStream* stream, const char* buffer, size_t buffer_size
     stream->is_not_primitive = true;
     stream->token_type = JSON_TYPE_UNKNOWN;
     stream->previous_token_type = JSON_TYPE_UNKNOWN;
-    stream->max_depth = options.max_depth;
-    stream->allow_multiple_values = options.allow_multiple_values;
-    stream->allow_trailing_commas = options.allow_trailing_commas;
-    stream->comment_handling = options.comment_handling;
+    stream->buffer_utf8_validated = false;
     stream->total_consumed = 0;
     stream->trailing_comma = false;
     stream->token_start = 0;
     stream->token_size = 0;
     stream->value_is_escaped = false;
+    stream->partial_string_start = SIZE_MAX;
+    stream->partial_string_scanned = 0;
+    stream->partial_string_escaped = false;
+    stream->tape = NULL;
+    stream->tape_count = 0;
+    stream->tape_index = 0;
 }
 
 void json_stream_continue(JsonStream* stream, JsonStream* old, const char* buffer, size_t buffer_size, bool is_final_block) {
@@ -281,6 +368,8 @@ void json_stream_continue(JsonStream* stream, JsonStream* old, const char* buffe
     stream->previous_token_type = old->previous_token_type;
     stream->allow_trailing_commas = old->allow_trailing_commas;
     stream->comment_handling = old->comment_handling;
+    stream->validate_utf8 = old->validate_utf8;
+    stream->buffer_utf8_validated = false;
     stream->allow_multiple_values = old->allow_multiple_values;
     stream->max_depth = old->max_depth;
     stream->error_handler = old->error_handler;
@@ -291,6 +380,14 @@ void json_stream_continue(JsonStream* stream, JsonStream* old, const char* buffe
     stream->token_start = 0;
     stream->token_size = 0;
     stream->value_is_escaped = false;
+    stream->partial_string_start = old->partial_string_start;
+    stream->partial_string_scanned = old->partial_string_scanned;
+    stream->partial_string_escaped = old->partial_string_escaped;
+    stream->scratch = old->scratch;
+    stream->scratch_capacity = old->scratch_capacity;
+    stream->tape = NULL;
+    stream->tape_count = 0;
+    stream->tape_index = 0;
 }
 
 JsonStreamOptions json_stream_options_default() {
@@ -303,9 +400,24 @@ JsonStreamOptions json_stream_options_default() {
 
 void json_stream_free_resources(JsonStream* stream) {
     json_z_bits_clear(&stream->bits);
+    free(stream->scratch);
+    stream->scratch = NULL;
+    stream->scratch_capacity = 0;
 }
 
 bool json_read(JsonStream* stream) {
+    if (stream->tape) {
+        return json_tape_read(stream);
+    }
+
+    if (stream->validate_utf8 == JSON_UTF8_VALIDATION_BUFFER && stream->is_final_block
+        && !stream->buffer_utf8_validated)
+    {
+        if (!json_validate_utf8_buffer(stream)) {
+            return false;
+        }
+    }
+
     bool result = json_read_single_segment(stream);
     if (!result) {
         if (stream->is_final_block && stream->token_type == JSON_TYPE_UNKNOWN && !stream->allow_multiple_values) {
@@ -400,16 +512,56 @@ bool json_text_equals(JsonStream* stream, const char* text, size_t length) {
         return false;
     }
 
+    // Unescaping never makes a string longer, so a longer text can never match.
+    if (length > stream->token_size) {
+        return false;
+    }
+
     if (stream->value_is_escaped) {
         return json_unescape_and_compare(stream, text, length);
     }
 
-    return strncmp(stream->buffer + stream->token_start, text, length) == 0;
+    return stream->token_size == length && memcmp(stream->buffer + stream->token_start, text, length) == 0;
 }
 
 static bool json_unescape_and_compare(JsonStream* stream, const char* text, size_t length) {
-    json_throw_string(stream, JSON_ERROR_NOT_IMPLEMENTED, __func__);
-    return false;
+    const char* source = stream->buffer + stream->token_start;
+    size_t source_length = stream->token_size;
+    size_t read = 0;
+    size_t matched = 0;
+
+    while (read < source_length) {
+        const char* backslash = memchr(source + read, JSON_CONSTANT_BACKSLASH, source_length - read);
+        size_t run = backslash ? (size_t)(backslash - (source + read)) : source_length - read;
+
+        if (run > length - matched || memcmp(source + read, text + matched, run) != 0) {
+            return false;
+        }
+
+        read += run;
+        matched += run;
+
+        if (read == source_length) {
+            break;
+        }
+
+        char decoded[4];
+        size_t decoded_length;
+        size_t escape_length =
+            json_decode_escape(stream, source + read, source_length - read, decoded, &decoded_length);
+        if (escape_length == 0) {
+            return false;
+        }
+
+        if (decoded_length > length - matched || memcmp(decoded, text + matched, decoded_length) != 0) {
+            return false;
+        }
+
+        read += escape_length;
+        matched += decoded_length;
+    }
+
+    return matched == length;
 }
 
 static bool json_consume_object_start(JsonStream* stream) {
@@ -709,7 +861,7 @@ static bool json_consume_value(JsonStream* stream, char first) {
                     default:
                         assert(stream->comment_handling == JSON_COMMENT_SKIP);
                         if (first == JSON_CONSTANT_SLASH) {
-                            if (json_consume_comment(stream)) {
+                            if (json_skip_comment(stream)) {
                                 if (JSON_STREAM_OUT_OF_BOUNDS(stream, stream->consumed)) {
                                     if (stream->is_not_primitive && json_is_last_span(stream)
                                         && stream->token_type != JSON_TYPE_ARRAY_END
@@ -748,10 +900,29 @@ static bool json_consume_value(JsonStream* stream, char first) {
     }
 }
 
+// Bytes left for a literal of the given length; a zero buffer_size marks a NUL-terminated buffer.
+static size_t json_literal_available(const JsonStream* stream, size_t length) {
+    if (stream->buffer_size != 0) {
+        return stream->buffer_size - stream->consumed;
+    }
+
+    size_t available = 0;
+    while (available < length && stream->buffer[stream->consumed + available] != '\0') {
+        available++;
+    }
+    return available;
+}
+
 static bool json_consume_literal(JsonStream* stream, const char* literal, size_t length, JsonType literal_type) {
-    if ((stream->buffer_size != 0 && stream->buffer_size - stream->consumed < length)
-        || strncmp(stream->buffer + stream->consumed, literal, length) != 0)
-    {
+    size_t available = json_literal_available(stream, length);
+    if (available < length || memcmp(stream->buffer + stream->consumed, literal, length) != 0) {
+        // A literal cut off by the end of a partial buffer is completed by the next one.
+        if (available < length && !stream->is_final_block
+            && memcmp(stream->buffer + stream->consumed, literal, available) == 0)
+        {
+            return false;
+        }
+
         json_generate_literal_error(stream, literal, length, literal_type);
         return false;
     }
@@ -766,15 +937,17 @@ static bool json_consume_literal(JsonStream* stream, const char* literal, size_t
 
 static void json_generate_literal_error(JsonStream* stream, const char* literal, size_t length, JsonType literal_type) {
     // TODO: Move stream->consumed to first mismatched character.
+    size_t available = json_literal_available(stream, length);
+    int slice_length = (int)(available < length ? available : length);
     switch (literal[0]) {
         case 'f':
-            json_throw_slice(stream, JSON_ERROR_EXPECTED_FALSE, stream->buffer + stream->consumed, 5);
+            json_throw_slice(stream, JSON_ERROR_EXPECTED_FALSE, stream->buffer + stream->consumed, slice_length);
             break;
         case 't':
-            json_throw_slice(stream, JSON_ERROR_EXPECTED_TRUE, stream->buffer + stream->consumed, 4);
+            json_throw_slice(stream, JSON_ERROR_EXPECTED_TRUE, stream->buffer + stream->consumed, slice_length);
             break;
         case 'n':
-            json_throw_slice(stream, JSON_ERROR_EXPECTED_NULL, stream->buffer + stream->consumed, 4);
+            json_throw_slice(stream, JSON_ERROR_EXPECTED_NULL, stream->buffer + stream->consumed, slice_length);
             break;
         default:
             break;
@@ -851,12 +1024,28 @@ static bool json_consume_property_name(JsonStream* stream) {
 static bool json_consume_string(JsonStream* stream) {
     assert(stream->buffer[stream->consumed] == JSON_CONSTANT_QUOTE);
     const char* buffer = stream->buffer + stream->consumed + 1;
-    size_t buffer_size = stream->buffer_size == 0 ? 0 : stream->buffer_size - stream->consumed - 1;
-    // TODO: Implement search function to make unrolling/vectorization possible.
-    char* first = strpbrk(buffer, JSON_CONSTANT_CONTROL_BACKSLASH_QUOTE);
-    if (first) {
-        size_t index = first - buffer;
+    bool terminated = stream->buffer_size == 0;
+    size_t length = terminated ? SIZE_MAX : stream->buffer_size - stream->consumed - 1;
+
+    // A previous buffer may have scanned part of this string already; resume behind that part.
+    size_t index = 0;
+    bool escaped = false;
+    if (stream->partial_string_start == json_total_bytes_consumed(stream) && stream->partial_string_scanned <= length) {
+        index = stream->partial_string_scanned;
+        escaped = stream->partial_string_escaped;
+    }
+    stream->partial_string_start = SIZE_MAX;
+
+    if (!escaped) {
+        index += json_scan_string(buffer + index, terminated ? SIZE_MAX : length - index);
+        if (index == length || (terminated && buffer[index] == '\0')) {
+            return json_end_of_string(stream, index, false);
+        }
+
         if (buffer[index] == JSON_CONSTANT_QUOTE) {
+            if (!json_validate_utf8_string(stream, buffer, index, stream->byte_position_in_line)) {
+                return false;
+            }
             stream->byte_position_in_line += index + 2;
             stream->token_start = stream->consumed + 1;
             stream->token_size = index;
@@ -864,78 +1053,121 @@ static bool json_consume_string(JsonStream* stream) {
             stream->token_type = JSON_TYPE_STRING;
             stream->consumed += index + 2;
             return true;
-        } else {
-            return json_consume_string_and_validate(stream, buffer, buffer_size, index);
         }
-    } else {
-        if (json_is_last_span(stream)) {
-            stream->byte_position_in_line += buffer_size == 0 ? strlen(buffer) : buffer_size;
-            json_throw(stream, JSON_ERROR_END_OF_STRING_NOT_FOUND);
+    }
+
+    return json_consume_string_and_validate(stream, buffer, length, index);
+}
+
+// Returns the index of the first quote, backslash or control character, or length when there is none. A
+// NUL-terminated buffer is scanned with a length of SIZE_MAX and stops at its terminator.
+static size_t json_scan_string(const char* buffer, size_t length) {
+    size_t index = 0;
+
+#if defined(__SSE2__)
+    if (length != SIZE_MAX) {
+        const __m128i quote = _mm_set1_epi8(JSON_CONSTANT_QUOTE);
+        const __m128i backslash = _mm_set1_epi8(JSON_CONSTANT_BACKSLASH);
+        const __m128i control = _mm_set1_epi8(JSON_CONSTANT_SPACE - 1);
+        for (; length - index >= 16; index += 16) {
+            __m128i chunk = _mm_loadu_si128((const __m128i*)(buffer + index));
+            __m128i special = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+                _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control)
+            );
+            int mask = _mm_movemask_epi8(special);
+            if (mask != 0) {
+                return index + (size_t)__builtin_ctz((unsigned)mask);
+            }
+        }
+    }
+#endif
+
+    for (; index < length; index++) {
+        unsigned char c = (unsigned char)buffer[index];
+        if (c == JSON_CONSTANT_QUOTE || c == JSON_CONSTANT_BACKSLASH || c < JSON_CONSTANT_SPACE) {
+            break;
         }
-        return false;
     }
+
+    return index;
 }
 
-static bool json_consume_string_and_validate(JsonStream* stream, const char* buffer, size_t buffer_size, size_t index) {
-    assert(buffer_size == 0 || index < buffer_size);
-    assert(buffer[index] != JSON_CONSTANT_QUOTE);
-    assert(buffer[index] == JSON_CONSTANT_BACKSLASH || buffer[index] < JSON_CONSTANT_SPACE);
+// The string ran out of data at index. On a partial buffer the scanned part is remembered, so that the next buffer
+// (which starts again at the opening quote) only scans what is new.
+static bool json_end_of_string(JsonStream* stream, size_t index, bool escaped) {
+    if (json_is_last_span(stream)) {
+        stream->byte_position_in_line += index + 1;
+        json_throw(stream, JSON_ERROR_END_OF_STRING_NOT_FOUND);
+        return false;
+    }
 
+    stream->partial_string_start = json_total_bytes_consumed(stream);
+    stream->partial_string_scanned = index;
+    stream->partial_string_escaped = escaped;
+    return false;
+}
+
+static bool json_consume_string_and_validate(JsonStream* stream, const char* buffer, size_t length, size_t index) {
+    // Scanning resumes at index, which is never inside an escape sequence.
+    bool terminated = stream->buffer_size == 0;
     size_t prev_position = stream->byte_position_in_line;
-    size_t prev_line = stream->line_number;
 
-    stream->byte_position_in_line += index + 1;
+    for (;;) {
+        index += json_scan_string(buffer + index, terminated ? SIZE_MAX : length - index);
+        if (index == length || (terminated && buffer[index] == '\0')) {
+            break;
+        }
 
-    bool next_char_escaped = false;
-    for (; !JSON_BUFFER_OUT_OF_BOUNDS(buffer, buffer_size, index); index++) {
         char current_byte = buffer[index];
         if (current_byte == JSON_CONSTANT_QUOTE) {
-            if (!next_char_escaped) {
-                goto done;
-            }
-            next_char_escaped = false;
-        } else if (current_byte == JSON_CONSTANT_BACKSLASH) {
-            next_char_escaped = !next_char_escaped;
-        } else if (next_char_escaped) {
-            char* escape = strchr(JSON_CONSTANT_ESCAPE_CHARS, current_byte);
-            if (!escape) {
-                json_throw_char(stream, JSON_ERROR_INVALID_CHARACTER_AFTER_ESCAPE_WITHIN_STRING, current_byte);
-                goto error;
-            }
+            goto done;
+        }
 
-            if (current_byte == 'u') {
-                stream->byte_position_in_line++;
-                bool threw;
-                if (json_validate_hex_digits(stream, buffer, buffer_size, index + 1, &threw)) {
-                    index += 4;
-                } else if (threw) {
-                    goto error;
-                } else {
-                    break;
-                }
-            }
-            next_char_escaped = false;
-        } else if (current_byte < JSON_CONSTANT_SPACE) {
+        stream->byte_position_in_line = prev_position + 1 + index;
+        if (current_byte != JSON_CONSTANT_BACKSLASH) {
             json_throw_char(stream, JSON_ERROR_INVALID_CHARACTER_WITHIN_STRING, current_byte);
             goto error;
         }
-    }
 
-    if (json_is_last_span(stream)) {
-        json_throw(stream, JSON_ERROR_END_OF_STRING_NOT_FOUND);
-        goto error;
+        if (index + 1 == length || (terminated && buffer[index + 1] == '\0')) {
+            break;
+        }
+
+        char escape = buffer[index + 1];
+        stream->byte_position_in_line++;
+        if (escape != JSON_CONSTANT_BACKSLASH && !strchr(JSON_CONSTANT_ESCAPE_CHARS, escape)) {
+            json_throw_char(stream, JSON_ERROR_INVALID_CHARACTER_AFTER_ESCAPE_WITHIN_STRING, escape);
+            goto error;
+        }
+
+        if (escape == 'u') {
+            stream->byte_position_in_line++;
+            bool threw;
+            if (!json_validate_hex_digits(stream, buffer, length, index + 2, &threw)) {
+                if (threw) {
+                    goto error;
+                }
+                break;
+            }
+            index += 6;
+        } else {
+            index += 2;
+        }
     }
 
     stream->byte_position_in_line = prev_position;
-    stream->line_number = prev_line;
-    return false;
+    return json_end_of_string(stream, index, true);
 
 error:
     stream->byte_position_in_line = prev_position;
-    stream->line_number = prev_line;
     return false;
 done:
-    stream->byte_position_in_line++;
+    stream->byte_position_in_line = prev_position;
+    if (!json_validate_utf8_string(stream, buffer, index, prev_position)) {
+        goto error;
+    }
+    stream->byte_position_in_line += index + 2;
     stream->token_start = stream->consumed + 1;
     stream->token_size = index;
     stream->token_type = JSON_TYPE_STRING;
@@ -962,6 +1194,54 @@ bool json_validate_hex_digits(JsonStream* stream, const char* buffer, size_t buf
     return false;
 }
 
+static bool json_validate_utf8_buffer(JsonStream* stream) {
+    const char* buffer = stream->buffer + stream->consumed;
+    size_t length = stream->buffer_size == 0 ? strlen(buffer) : stream->buffer_size - stream->consumed;
+    size_t error_index;
+
+    if (json_utf8_validate(buffer, length, &error_index)) {
+        stream->buffer_utf8_validated = true;
+        return true;
+    }
+
+    size_t prev_position = stream->byte_position_in_line;
+    size_t prev_line = stream->line_number;
+
+    for (size_t i = 0; i < error_index; i++) {
+        if (buffer[i] == JSON_CONSTANT_LINE_FEED) {
+            stream->line_number++;
+            stream->byte_position_in_line = 0;
+        } else {
+            stream->byte_position_in_line++;
+        }
+    }
+
+    json_throw_number(stream, JSON_ERROR_INVALID_UTF8, (int64_t)(json_total_bytes_consumed(stream) + error_index));
+
+    stream->byte_position_in_line = prev_position;
+    stream->line_number = prev_line;
+    return false;
+}
+
+static bool json_validate_utf8_string(JsonStream* stream, const char* string, size_t length, size_t quote_position) {
+    if (stream->validate_utf8 == JSON_UTF8_VALIDATION_NONE || stream->buffer_utf8_validated) {
+        return true;
+    }
+
+    size_t error_index;
+    if (json_utf8_validate(string, length, &error_index)) {
+        return true;
+    }
+
+    stream->byte_position_in_line = quote_position + 1 + error_index;
+    json_throw_number(
+        stream,
+        JSON_ERROR_INVALID_UTF8,
+        (int64_t)(stream->total_consumed + (size_t)(string - stream->buffer) + error_index)
+    );
+    return false;
+}
+
 static bool json_try_get_number(
     JsonStream* stream,
     const char* buffer,
@@ -972,19 +1252,17 @@ static bool json_try_get_number(
     size_t index = 0;
 
     JsonConsumeNumberResult sign_result = json_consume_negative_sign(stream, buffer, buffer_length, &index);
-    if (sign_result == JSON_CONSUME_NUMBER_NEED_MORE_DATA) {
+    if (sign_result != JSON_CONSUME_NUMBER_OPERATION_INCOMPLETE) {
         return false;
     }
 
-    assert(sign_result == JSON_CONSUME_NUMBER_OPERATION_INCOMPLETE);
-
     char next = buffer[index];
 
     assert(next >= '0' && next <= '9');
 
     if (next == '0') {
         JsonConsumeNumberResult zero_result = json_consume_zero(stream, buffer, buffer_length, &index);
-        if (zero_result == JSON_CONSUME_NUMBER_NEED_MORE_DATA) {
+        if (zero_result == JSON_CONSUME_NUMBER_NEED_MORE_DATA || zero_result == JSON_CONSUME_NUMBER_ERROR) {
             return false;
         }
         if (zero_result == JSON_CONSUME_NUMBER_SUCCESS) {
@@ -1014,7 +1292,7 @@ static bool json_try_get_number(
     if (next == '.') {
         index++;
         JsonConsumeNumberResult decimal_result = json_consume_decimal_digits(stream, buffer, buffer_length, &index);
-        if (decimal_result == JSON_CONSUME_NUMBER_NEED_MORE_DATA) {
+        if (decimal_result == JSON_CONSUME_NUMBER_NEED_MORE_DATA || decimal_result == JSON_CONSUME_NUMBER_ERROR) {
             return false;
         }
         if (decimal_result == JSON_CONSUME_NUMBER_SUCCESS) {
@@ -1033,12 +1311,10 @@ static bool json_try_get_number(
     index++;
 
     sign_result = json_consume_sign(stream, buffer, buffer_length, &index);
-    if (sign_result == JSON_CONSUME_NUMBER_NEED_MORE_DATA) {
+    if (sign_result != JSON_CONSUME_NUMBER_OPERATION_INCOMPLETE) {
         return false;
     }
 
-    assert(sign_result == JSON_CONSUME_NUMBER_OPERATION_INCOMPLETE);
-
     index++;
     JsonConsumeNumberResult exponent_result = json_consume_integer_digits(stream, buffer, buffer_length, &index);
     if (exponent_result == JSON_CONSUME_NUMBER_NEED_MORE_DATA) {
@@ -1112,6 +1388,7 @@ static JsonConsumeNumberResult json_consume_zero(
     if (next != '.' && next != 'e' && next != 'E') {
         stream->byte_position_in_line += *index;
         json_throw_slice(stream, JSON_ERROR_INVALID_LEADING_ZERO_IN_NUMBER, buffer, (int)*index);
+        return JSON_CONSUME_NUMBER_ERROR;
     }
 
     return JSON_CONSUME_NUMBER_OPERATION_INCOMPLETE;
@@ -1272,7 +1549,7 @@ static JsonConsumeTokenResult json_consume_next_token(JsonStream* stream, char t
         if (first <= JSON_CONSTANT_SPACE) {
             json_skip_whitespace(stream);
             if (!json_has_more_data_specific_error(stream, JSON_ERROR_EXPECTED_START_OF_PROPERTY_OR_VALUE_NOT_FOUND)) {
-                return JSON_CONSUME_TOKEN_ERROR;
+                return JSON_CONSUME_TOKEN_NOT_ENOUGH_DATA_ROLLBACK_STATE;
             }
             first = stream->buffer[stream->consumed];
         }
@@ -1359,8 +1636,8 @@ static JsonConsumeTokenResult json_consume_next_token_from_last_non_comment_toke
     stream->token_start = stream->consumed;
 
     if (first == JSON_CONSTANT_LIST_SEPARATOR) {
-        if (stream->previous_token_type == JSON_TYPE_UNKNOWN || stream->token_type == JSON_TYPE_OBJECT_START
-            || stream->token_type == JSON_TYPE_ARRAY_START || stream->trailing_comma)
+        if (stream->previous_token_type == JSON_TYPE_UNKNOWN || stream->previous_token_type == JSON_TYPE_OBJECT_START
+            || stream->previous_token_type == JSON_TYPE_ARRAY_START || stream->trailing_comma)
         {
             json_throw(stream, JSON_ERROR_EXPECTED_START_OF_PROPERTY_OR_VALUE_NOT_FOUND);
             return JSON_CONSUME_TOKEN_ERROR;
@@ -1565,11 +1842,11 @@ static JsonConsumeTokenResult json_consume_next_token_until_all_comments_are_ski
 
     stream->token_start = stream->consumed;
 
-    if (stream->token_start == JSON_TYPE_OBJECT_START) {
+    if (stream->token_type == JSON_TYPE_OBJECT_START) {
         if (token == JSON_CONSTANT_BRACE_CLOSE) {
             return json_consume_object_end(stream) ? JSON_CONSUME_TOKEN_SUCCESS : JSON_CONSUME_TOKEN_ERROR;
         } else {
-            if (token == JSON_CONSTANT_QUOTE) {
+            if (token != JSON_CONSTANT_QUOTE) {
                 json_throw(stream, JSON_ERROR_EXPECTED_START_OF_PROPERTY_NOT_FOUND);
                 goto incomplete_no_rollback;
             }
@@ -1687,17 +1964,19 @@ incomplete_no_rollback:
 
 static bool json_skip_comment(JsonStream* stream) {
     const char* buffer = stream->buffer + stream->consumed + 1;
-    size_t buffer_length = stream->buffer_size == 0 ? 0 : (stream->buffer_size - stream->consumed - 1);
+    size_t buffer_length = stream->buffer_size == 0 ? SIZE_MAX : (stream->buffer_size - stream->consumed - 1);
 
-    if (JSON_BUFFER_OUT_OF_BOUNDS(buffer, buffer_length, 0)) {
-        json_throw_char(stream, JSON_ERROR_EXPECTED_START_OF_VALUE_NOT_FOUND, buffer[0]);
+    if (JSON_SPAN_OUT_OF_BOUNDS(buffer, buffer_length, 0)) {
+        if (json_is_last_span(stream)) {
+            json_throw_char(stream, JSON_ERROR_EXPECTED_START_OF_VALUE_NOT_FOUND, '\0');
+        }
         return false;
     }
 
     char token = buffer[0];
 
     buffer++;
-    buffer_length = buffer_length == 0 ? 0 : buffer_length - 1;
+    buffer_length = buffer_length == SIZE_MAX ? SIZE_MAX : buffer_length - 1;
 
     if (token == JSON_CONSTANT_SLASH) {
         return json_skip_single_line_comment(stream, buffer, buffer_length, NULL);
@@ -1719,9 +1998,8 @@ static bool json_skip_single_line_comment(
     size_t to_consume;
 
     if (!json_find_line_separator(stream, buffer, buffer_length, &index)) {
-        if (json_is_last_span(stream)) {
+        if (stream->error.type == JSON_ERROR_NONE && json_is_last_span(stream)) {
             // Assume everything on this line is a comment and there is no more data.
-            index = buffer_length == 0 ? strlen(buffer) : buffer_length;
             to_consume = index;
             stream->byte_position_in_line += index + 2;
             goto done;
@@ -1739,7 +2017,7 @@ static bool json_skip_single_line_comment(
     // If we're here, we have definitely found a \r. Check to see if a \n follows.
     assert(buffer[index] == JSON_CONSTANT_CARRIAGE_RETURN);
 
-    if (JSON_BUFFER_OUT_OF_BOUNDS(buffer, buffer_length, index + 1)) {
+    if (JSON_SPAN_OUT_OF_BOUNDS(buffer, buffer_length, index + 1)) {
         if (!json_is_last_span(stream)) {
             // LF could be in next segment
             return false;
@@ -1760,32 +2038,99 @@ done:
     return true;
 }
 
+// Returns the index of the first CR, LF or U+2028/U+2029 lead byte, or the index at which the data ends.
+static size_t json_scan_line_separator(const char* buffer, size_t length) {
+    size_t index = 0;
+
+#if defined(__SSE2__)
+    if (length != SIZE_MAX) {
+        const __m128i carriage_return = _mm_set1_epi8(JSON_CONSTANT_CARRIAGE_RETURN);
+        const __m128i line_feed = _mm_set1_epi8(JSON_CONSTANT_LINE_FEED);
+        const __m128i separator = _mm_set1_epi8(JSON_CONSTANT_STARTING_BYTE_OF_NON_STANDARD_LINE_SEPARATOR);
+        const __m128i zero = _mm_setzero_si128();
+        for (; length - index >= 16; index += 16) {
+            __m128i chunk = _mm_loadu_si128((const __m128i*)(buffer + index));
+            __m128i special = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, carriage_return), _mm_cmpeq_epi8(chunk, line_feed)),
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, separator), _mm_cmpeq_epi8(chunk, zero))
+            );
+            int mask = _mm_movemask_epi8(special);
+            if (mask != 0) {
+                return index + (size_t)__builtin_ctz((unsigned)mask);
+            }
+        }
+    }
+#endif
+
+    for (; index < length; index++) {
+        char c = buffer[index];
+        if (c == JSON_CONSTANT_CARRIAGE_RETURN || c == JSON_CONSTANT_LINE_FEED
+            || c == JSON_CONSTANT_STARTING_BYTE_OF_NON_STANDARD_LINE_SEPARATOR || c == '\0') {
+            break;
+        }
+    }
+
+    return index;
+}
+
+// Returns false when the data ends before a line separator, with out_index set to where it ends.
 static bool json_find_line_separator(JsonStream* stream, const char* buffer, size_t buffer_length, size_t* out_index) {
-    size_t total_index = 0;
+    size_t index = 0;
     while (true) {
-        const char* char_index = strpbrk(buffer, "\r\n\xE2");
-        if (!char_index || (buffer_length != 0 && total_index + (char_index - buffer) >= buffer_length)) {
+        index += json_scan_line_separator(buffer + index, buffer_length == SIZE_MAX ? SIZE_MAX : buffer_length - index);
+        *out_index = index;
+        if (JSON_SPAN_OUT_OF_BOUNDS(buffer, buffer_length, index)) {
             return false;
         }
 
-        total_index += char_index - buffer;
-
-        if (*char_index != JSON_CONSTANT_STARTING_BYTE_OF_NON_STANDARD_LINE_SEPARATOR) {
-            *out_index = total_index;
+        if (buffer[index] != JSON_CONSTANT_STARTING_BYTE_OF_NON_STANDARD_LINE_SEPARATOR) {
             return true;
         }
 
-        total_index++;
-        buffer_length = buffer_length == 0 ? 0 : (buffer_length - (char_index - buffer) - 1);
-        buffer = char_index + 1;
+        index++;
+        if (!JSON_SPAN_OUT_OF_BOUNDS(buffer, buffer_length, index) && buffer[index] == '\x80'
+            && !JSON_SPAN_OUT_OF_BOUNDS(buffer, buffer_length, index + 1)
+            && (buffer[index + 1] == '\xA8' || buffer[index + 1] == '\xA9')) {
+            json_throw(stream, JSON_ERROR_UNEXPECTED_END_OF_LINE_SEPARATOR);
+            return false;
+        }
+    }
+}
+
+// Returns the index of the asterisk of the first "*/", or the index at which the data ends.
+static size_t json_scan_comment_end(const char* buffer, size_t length) {
+    size_t index = 0;
 
-        if (!JSON_BUFFER_OUT_OF_BOUNDS(buffer, buffer_length, 2)) {
-            if (buffer[0] == '\x80' && (buffer[1] == '\xA8' || buffer[1] == '\xA9')) {
-                json_throw(stream, JSON_ERROR_UNEXPECTED_END_OF_LINE_SEPARATOR);
-                return false;
+#if defined(__SSE2__)
+    if (length != SIZE_MAX) {
+        const __m128i asterisk = _mm_set1_epi8(JSON_CONSTANT_ASTERISK);
+        const __m128i slash = _mm_set1_epi8(JSON_CONSTANT_SLASH);
+        const __m128i zero = _mm_setzero_si128();
+        // The second load is one byte further on, so that each asterisk lines up with the byte that follows it.
+        for (; length - index >= 17; index += 16) {
+            __m128i chunk = _mm_loadu_si128((const __m128i*)(buffer + index));
+            __m128i next = _mm_loadu_si128((const __m128i*)(buffer + index + 1));
+            __m128i special = _mm_or_si128(
+                _mm_and_si128(_mm_cmpeq_epi8(chunk, asterisk), _mm_cmpeq_epi8(next, slash)),
+                _mm_cmpeq_epi8(chunk, zero)
+            );
+            int mask = _mm_movemask_epi8(special);
+            if (mask != 0) {
+                return index + (size_t)__builtin_ctz((unsigned)mask);
             }
         }
     }
+#endif
+
+    for (; index < length; index++) {
+        char c = buffer[index];
+        if (c == '\0'
+            || (c == JSON_CONSTANT_ASTERISK && index + 1 < length && buffer[index + 1] == JSON_CONSTANT_SLASH)) {
+            break;
+        }
+    }
+
+    return index;
 }
 
 static bool json_skip_multiline_comment(
@@ -1794,26 +2139,12 @@ static bool json_skip_multiline_comment(
     size_t buffer_length,
     size_t* out_index
 ) {
-    size_t index = 0;
-    while (true) {
-        const char* char_index = buffer_length == 0
-            ? strchr(buffer + index, JSON_CONSTANT_SLASH)
-            : memchr(buffer + index, JSON_CONSTANT_SLASH, buffer_length - index);
-        if (!char_index) {
-            if (json_is_last_span(stream)) {
-                json_throw(stream, JSON_ERROR_END_OF_COMMENT_NOT_FOUND);
-            }
-            return false;
-        }
-
-        size_t found_index = char_index - (buffer + index);
-
-        if (char_index != buffer + index && char_index[-1] == JSON_CONSTANT_ASTERISK) {
-            index += found_index - 1;
-            break;
+    size_t index = json_scan_comment_end(buffer, buffer_length);
+    if (JSON_SPAN_OUT_OF_BOUNDS(buffer, buffer_length, index)) {
+        if (json_is_last_span(stream)) {
+            json_throw(stream, JSON_ERROR_END_OF_COMMENT_NOT_FOUND);
         }
-
-        index += found_index + 1;
+        return false;
     }
 
     stream->consumed += index + 4;
@@ -1835,17 +2166,19 @@ static bool json_skip_multiline_comment(
 
 static bool json_consume_comment(JsonStream* stream) {
     const char* buffer = stream->buffer + stream->consumed + 1;
-    size_t buffer_length = stream->buffer_size == 0 ? 0 : (stream->buffer_size - stream->consumed - 1);
+    size_t buffer_length = stream->buffer_size == 0 ? SIZE_MAX : (stream->buffer_size - stream->consumed - 1);
 
-    if (JSON_BUFFER_OUT_OF_BOUNDS(buffer, buffer_length, 0)) {
-        json_throw(stream, JSON_ERROR_UNEXPECTED_END_OF_DATA_WHILE_READING_COMMENT);
+    if (JSON_SPAN_OUT_OF_BOUNDS(buffer, buffer_length, 0)) {
+        if (json_is_last_span(stream)) {
+            json_throw(stream, JSON_ERROR_UNEXPECTED_END_OF_DATA_WHILE_READING_COMMENT);
+        }
         return false;
     }
 
     char token = buffer[0];
 
     buffer++;
-    buffer_length = buffer_length == 0 ? 0 : buffer_length - 1;
+    buffer_length = buffer_length == SIZE_MAX ? SIZE_MAX : buffer_length - 1;
 
     if (token == JSON_CONSTANT_SLASH) {
         return json_consume_single_line_comment(stream, buffer, buffer_length, stream->consumed);
@@ -1906,7 +2239,7 @@ static bool json_helper_is_digit(char c) {
 }
 
 static bool json_helper_is_hex_digit(char c) {
-    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+    return json_hex_values[(unsigned char)c] != JSON_HEX_INVALID;
 }
 
 static bool json_helper_is_token_type_primitive(JsonType token_type) {
@@ -1927,19 +2260,18 @@ static bool json_helper_count_new_lines(
     size_t* out_count,
     size_t* out_new_line_index
 ) {
+    *out_count = 0;
+    *out_new_line_index = 0;
+
     const char* search = buffer;
-    bool found_line_feed = false;
-    while ((search = memchr(search, JSON_CONSTANT_LINE_FEED, buffer_size - (search - buffer))) != NULL) {
-        size_t index = search - buffer;
-        if (index >= buffer_size)
-            return true;
+    const char* end = buffer + buffer_size;
+    while ((search = memchr(search, JSON_CONSTANT_LINE_FEED, (size_t)(end - search))) != NULL) {
         (*out_count)++;
-        *out_new_line_index = index;
-        found_line_feed = true;
+        *out_new_line_index = (size_t)(search - buffer);
         search++;
     }
 
-    return found_line_feed;
+    return *out_count > 0;
 }
 
 static void json_rollback_init(const JsonStream* stream, JsonRollbackState* state) {
@@ -2050,17 +2382,11 @@ bool json_try_get_string_escaped(
             *out_length = length;
         }
     } else {
-        int length =
-            snprintf(buffer, buffer_length, "%.*s", (int)stream->token_size, stream->buffer + stream->token_start);
-        if (length < 0) {
-            json_throw(stream, JSON_ERROR_STRING_PARSE_FAILED);
-            if (allocated) {
-                free(buffer);
-            }
-            return false;
-        }
+        size_t length = buffer_length - 1 < stream->token_size ? buffer_length - 1 : stream->token_size;
+        memcpy(buffer, stream->buffer + stream->token_start, length);
+        buffer[length] = '\0';
         if (out_length) {
-            *out_length = buffer_length - 1 < (size_t)length ? buffer_length - 1 : (size_t)length;
+            *out_length = length;
         }
     }
 
@@ -2097,89 +2423,67 @@ static bool json_unescape(
     size_t* out_written,
     bool* out_full
 ) {
-    const char* source = stream->buffer + stream->token_start;
-    size_t source_length = stream->token_size;
+    return json_unescape_buffer(
+        stream,
+        stream->buffer + stream->token_start,
+        stream->token_size,
+        destination,
+        destination_length,
+        out_written,
+        out_full
+    );
+}
+
+static bool json_unescape_buffer(
+    JsonStream* stream,
+    const char* source,
+    size_t source_length,
+    char* destination,
+    size_t destination_length,
+    size_t* out_written,
+    bool* out_full
+) {
+    size_t read = 0;
     size_t written = 0;
     bool full = true;
 
-    while (source_length > 0) {
-        char* backslash_ptr = memchr(source, JSON_CONSTANT_BACKSLASH, source_length);
-        if (backslash_ptr) {
-            size_t backslash_index = backslash_ptr - source;
-            size_t to_write =
-                written + backslash_index < destination_length ? backslash_index : destination_length - written;
-            memmove(destination + written, source, to_write);
-            written += to_write;
-            source += to_write + 1;
-            source_length -= to_write + 1;
-            if (to_write != backslash_index || written == destination_length) {
-                full = false;
-                break;
-            }
-            switch (source[0]) {
-                case JSON_CONSTANT_QUOTE:
-                    destination[written++] = JSON_CONSTANT_QUOTE;
-                    break;
-                case 'n':
-                    destination[written++] = JSON_CONSTANT_LINE_FEED;
-                    break;
-                case 'r':
-                    destination[written++] = JSON_CONSTANT_CARRIAGE_RETURN;
-                    break;
-                case JSON_CONSTANT_BACKSLASH:
-                    destination[written++] = JSON_CONSTANT_BACKSLASH;
-                    break;
-                case JSON_CONSTANT_SLASH:
-                    destination[written++] = JSON_CONSTANT_SLASH;
-                    break;
-                case 't':
-                    destination[written++] = JSON_CONSTANT_TAB;
-                    break;
-                case 'b':
-                    destination[written++] = JSON_CONSTANT_BACKSPACE;
-                    break;
-                case 'f':
-                    destination[written++] = JSON_CONSTANT_FORM_FEED;
-                    break;
-                case 'u':
-                    assert(source_length > 5);
-                    char hex[5];
-                    memcpy(hex, source + 1, 4);
-                    hex[4] = '\0';
-                    wchar_t code_point = (wchar_t)strtol(hex, NULL, 16);
-                    int bytes = wctomb(hex, code_point);
-                    if (bytes == -1) {
-                        json_throw_char(stream, JSON_ERROR_INVALID_HEX_CHARACTER_WITHIN_STRING, source[1]);
-                        return false;
-                    }
+    while (read < source_length) {
+        size_t copied = json_copy_until_backslash(
+            source + read,
+            source_length - read,
+            destination + written,
+            destination_length - written
+        );
+        read += copied;
+        written += copied;
 
-                    if (written + bytes > destination_length) {
-                        full = false;
-                        goto end;
-                    }
+        if (read == source_length) {
+            break;
+        }
 
-                    memcpy(destination + written, source + 1, bytes);
-                    written += bytes;
-                    source += bytes;
-                    source_length -= bytes;
-                    break;
-                default:
-                    json_throw_char(stream, JSON_ERROR_INVALID_CHARACTER_AFTER_ESCAPE_WITHIN_STRING, source[0]);
-                    return false;
-            }
-            source++;
-            source_length--;
-        } else {
-            size_t to_write =
-                written + source_length < destination_length ? source_length : destination_length - written;
-            memmove(destination + written, source, source_length);
-            written += to_write;
-            full = to_write == source_length;
+        if (source[read] != JSON_CONSTANT_BACKSLASH) {
+            // The destination filled up before the next escape.
+            full = false;
             break;
         }
-    }
 
-end:
+        char decoded[4];
+        size_t decoded_length;
+        size_t escape_length =
+            json_decode_escape(stream, source + read, source_length - read, decoded, &decoded_length);
+        if (escape_length == 0) {
+            return false;
+        }
+
+        if (destination_length - written < decoded_length) {
+            full = false;
+            break;
+        }
+
+        memcpy(destination + written, decoded, decoded_length);
+        written += decoded_length;
+        read += escape_length;
+    }
 
     if (out_full) {
         *out_full = full;
@@ -2192,6 +2496,153 @@ end:
     return true;
 }
 
+static size_t json_copy_until_backslash(
+    const char* source,
+    size_t source_length,
+    char* destination,
+    size_t destination_length
+) {
+    size_t limit = source_length < destination_length ? source_length : destination_length;
+    size_t index = 0;
+
+#if defined(__SSE2__)
+    // Scan and copy in the same pass; escape-heavy strings rarely have long enough runs for memchr to pay off.
+    const __m128i backslash = _mm_set1_epi8(JSON_CONSTANT_BACKSLASH);
+    while (limit - index >= 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(source + index));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, backslash));
+        if (mask != 0) {
+            size_t run = (size_t)__builtin_ctz((unsigned)mask);
+            memcpy(destination + index, source + index, run);
+            return index + run;
+        }
+        _mm_storeu_si128((__m128i*)(destination + index), chunk);
+        index += 16;
+    }
+#endif
+
+    const char* backslash_ptr = memchr(source + index, JSON_CONSTANT_BACKSLASH, limit - index);
+    size_t run = backslash_ptr ? (size_t)(backslash_ptr - (source + index)) : limit - index;
+    memcpy(destination + index, source + index, run);
+    return index + run;
+}
+
+static size_t json_decode_escape(
+    JsonStream* stream,
+    const char* source,
+    size_t source_length,
+    char* out,
+    size_t* out_length
+) {
+    assert(source[0] == JSON_CONSTANT_BACKSLASH);
+
+    if (source_length < 2) {
+        json_throw_char(stream, JSON_ERROR_INVALID_CHARACTER_AFTER_ESCAPE_WITHIN_STRING, '\0');
+        return 0;
+    }
+
+    *out_length = 1;
+    switch (source[1]) {
+        case JSON_CONSTANT_QUOTE:
+            out[0] = JSON_CONSTANT_QUOTE;
+            return 2;
+        case 'n':
+            out[0] = JSON_CONSTANT_LINE_FEED;
+            return 2;
+        case 'r':
+            out[0] = JSON_CONSTANT_CARRIAGE_RETURN;
+            return 2;
+        case JSON_CONSTANT_BACKSLASH:
+            out[0] = JSON_CONSTANT_BACKSLASH;
+            return 2;
+        case JSON_CONSTANT_SLASH:
+            out[0] = JSON_CONSTANT_SLASH;
+            return 2;
+        case 't':
+            out[0] = JSON_CONSTANT_TAB;
+            return 2;
+        case 'b':
+            out[0] = JSON_CONSTANT_BACKSPACE;
+            return 2;
+        case 'f':
+            out[0] = JSON_CONSTANT_FORM_FEED;
+            return 2;
+        case 'u':
+            break;
+        default:
+            json_throw_char(stream, JSON_ERROR_INVALID_CHARACTER_AFTER_ESCAPE_WITHIN_STRING, source[1]);
+            return 0;
+    }
+
+    uint32_t code_point;
+    if (source_length < 6 || !json_decode_hex(source + 2, &code_point)) {
+        json_throw_char(stream, JSON_ERROR_INVALID_HEX_CHARACTER_WITHIN_STRING, source_length > 2 ? source[2] : '\0');
+        return 0;
+    }
+
+    size_t consumed = 6;
+
+    if (code_point >= 0xD800 && code_point <= 0xDBFF) {
+        // A high surrogate is only meaningful when immediately followed by an escaped low surrogate.
+        uint32_t low_surrogate;
+        if (source_length < 12 || source[6] != JSON_CONSTANT_BACKSLASH || source[7] != 'u'
+            || !json_decode_hex(source + 8, &low_surrogate) || low_surrogate < 0xDC00 || low_surrogate > 0xDFFF)
+        {
+            json_throw_number(stream, JSON_ERROR_INVALID_UTF16_SURROGATE, code_point);
+            return 0;
+        }
+
+        code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low_surrogate - 0xDC00);
+        consumed = 12;
+    } else if (code_point >= 0xDC00 && code_point <= 0xDFFF) {
+        json_throw_number(stream, JSON_ERROR_INVALID_UTF16_SURROGATE, code_point);
+        return 0;
+    }
+
+    *out_length = json_encode_utf8(code_point, out);
+    return consumed;
+}
+
+static bool json_decode_hex(const char* source, uint32_t* out_value) {
+    uint8_t a = json_hex_values[(unsigned char)source[0]];
+    uint8_t b = json_hex_values[(unsigned char)source[1]];
+    uint8_t c = json_hex_values[(unsigned char)source[2]];
+    uint8_t d = json_hex_values[(unsigned char)source[3]];
+
+    if ((a | b | c | d) == JSON_HEX_INVALID) {
+        return false;
+    }
+
+    *out_value = ((uint32_t)a << 12) | ((uint32_t)b << 8) | ((uint32_t)c << 4) | d;
+    return true;
+}
+
+static size_t json_encode_utf8(uint32_t code_point, char* out) {
+    if (code_point < 0x80) {
+        out[0] = (char)code_point;
+        return 1;
+    }
+
+    if (code_point < 0x800) {
+        out[0] = (char)(0xC0 | (code_point >> 6));
+        out[1] = (char)(0x80 | (code_point & 0x3F));
+        return 2;
+    }
+
+    if (code_point < 0x10000) {
+        out[0] = (char)(0xE0 | (code_point >> 12));
+        out[1] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (code_point & 0x3F));
+        return 3;
+    }
+
+    out[0] = (char)(0xF0 | (code_point >> 18));
+    out[1] = (char)(0x80 | ((code_point >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (code_point & 0x3F));
+    return 4;
+}
+
 const char* json_get_string(JsonStream* stream, size_t* out_length) {
     const char* out;
     if (json_try_get_string(stream, &out, out_length)) {
@@ -2308,6 +2759,193 @@ bool json_try_read_property(JsonStream* stream, const char** out_property, size_
     return true;
 }
 
+const char* json_get_text(JsonStream* stream, size_t* out_length) {
+    const char* out;
+    if (json_try_get_text(stream, &out, out_length)) {
+        return out;
+    }
+
+    if (stream->error.type == JSON_ERROR_NONE) {
+        json_throw(stream, JSON_ERROR_INVALID_OPERATION_EXPECTED_STRING);
+    }
+    return NULL;
+}
+
+const char* json_read_text(JsonStream* stream, size_t* out_length) {
+    const char* out;
+    if (json_try_read_text(stream, &out, out_length)) {
+        return out;
+    }
+
+    if (stream->error.type == JSON_ERROR_NONE) {
+        json_throw(stream, JSON_ERROR_INVALID_OPERATION_EXPECTED_STRING);
+    }
+    return NULL;
+}
+
+static bool json_reserve_scratch(JsonStream* stream, size_t capacity) {
+    if (capacity <= stream->scratch_capacity) {
+        return true;
+    }
+
+    size_t new_capacity = stream->scratch_capacity ? stream->scratch_capacity : 64;
+    while (new_capacity < capacity) {
+        new_capacity *= 2;
+    }
+
+    char* scratch = realloc(stream->scratch, new_capacity);
+    if (!scratch) {
+        json_throw(stream, JSON_ERROR_OUT_OF_MEMORY);
+        return false;
+    }
+
+    stream->scratch = scratch;
+    stream->scratch_capacity = new_capacity;
+    return true;
+}
+
+bool json_try_get_text(JsonStream* stream, const char** out_text, size_t* out_length) {
+    if (!stream->value_is_escaped || stream->token_type == JSON_TYPE_NULL) {
+        return json_try_get_string(stream, out_text, out_length);
+    }
+
+    if (stream->token_type != JSON_TYPE_STRING && stream->token_type != JSON_TYPE_PROPERTY) {
+        if (stream->error.type == JSON_ERROR_NONE) {
+            stream->error.string = json_token_type_name(stream->token_type);
+        }
+
+        return false;
+    }
+
+    // Unescaping never makes a value longer.
+    size_t length;
+    if (!json_reserve_scratch(stream, stream->token_size + 1)
+        || !json_unescape(stream, stream->scratch, stream->token_size, &length, NULL))
+    {
+        return false;
+    }
+
+    stream->scratch[length] = '\0';
+    *out_text = stream->scratch;
+    *out_length = length;
+    return true;
+}
+
+bool json_try_read_text(JsonStream* stream, const char** out_text, size_t* out_length) {
+    JsonRollbackState state;
+    json_rollback_init(stream, &state);
+
+    if (!json_read(stream)) {
+        return false;
+    }
+
+    if (!json_try_get_text(stream, out_text, out_length)) {
+        json_rollback(stream, &state);
+        return false;
+    }
+
+    return true;
+}
+
+JsonStringView json_get_string_view(JsonStream* stream) {
+    JsonStringView view = {0};
+    if (!json_try_get_string_view(stream, &view) && stream->error.type == JSON_ERROR_NONE) {
+        json_throw(stream, JSON_ERROR_INVALID_OPERATION_EXPECTED_STRING);
+    }
+    return view;
+}
+
+JsonStringView json_read_string_view(JsonStream* stream) {
+    JsonStringView view = {0};
+    if (!json_try_read_string_view(stream, &view) && stream->error.type == JSON_ERROR_NONE) {
+        json_throw(stream, JSON_ERROR_INVALID_OPERATION_EXPECTED_STRING);
+    }
+    return view;
+}
+
+bool json_try_get_string_view(JsonStream* stream, JsonStringView* out_view) {
+    if (!json_try_get_string(stream, &out_view->ptr, &out_view->len)) {
+        return false;
+    }
+
+    out_view->needs_unescape = stream->token_type != JSON_TYPE_NULL && stream->value_is_escaped;
+    return true;
+}
+
+bool json_try_read_string_view(JsonStream* stream, JsonStringView* out_view) {
+    JsonRollbackState state;
+    json_rollback_init(stream, &state);
+
+    if (!json_read(stream)) {
+        return false;
+    }
+
+    if (!json_try_get_string_view(stream, out_view)) {
+        json_rollback(stream, &state);
+        return false;
+    }
+
+    return true;
+}
+
+bool json_try_read_string_views(JsonStream* stream, JsonStringView* views, size_t capacity, size_t* out_count) {
+    size_t count = 0;
+    bool result = true;
+
+    while (count < capacity) {
+        JsonRollbackState state;
+        json_rollback_init(stream, &state);
+
+        if (!json_read(stream)) {
+            result = false;
+            break;
+        }
+
+        JsonType type = stream->token_type;
+        if (type == JSON_TYPE_STRING) {
+            views[count++] = (JsonStringView){
+                .ptr = stream->buffer + stream->token_start,
+                .len = stream->token_size,
+                .needs_unescape = stream->value_is_escaped,
+            };
+        } else if (type == JSON_TYPE_NULL) {
+            views[count++] = (JsonStringView){0};
+        } else if (type == JSON_TYPE_ARRAY_END) {
+            break;
+        } else if (type != JSON_TYPE_COMMENT) {
+            json_rollback(stream, &state);
+            if (stream->error.type == JSON_ERROR_NONE) {
+                stream->error.string = json_token_type_name(type);
+            }
+            result = false;
+            break;
+        }
+    }
+
+    *out_count = count;
+    return result;
+}
+
+bool json_string_view_unescape(
+    JsonStream* stream,
+    JsonStringView view,
+    char* destination,
+    size_t destination_length,
+    size_t* out_length
+) {
+    if (!view.needs_unescape) {
+        if (view.len > destination_length) {
+            return false;
+        }
+        memcpy(destination, view.ptr, view.len);
+        *out_length = view.len;
+        return true;
+    }
+
+    bool full;
+    return json_unescape_buffer(stream, view.ptr, view.len, destination, destination_length, out_length, &full) && full;
+}
+
 const char* json_get_comment(JsonStream* stream, size_t* out_length) {
     const char* out;
     if (json_try_get_comment(stream, &out, out_length)) {
@@ -2436,6 +3074,17 @@ uint8_t json_read_u8(JsonStream* stream) {
     return 0;
 }
 
+// A replayed tape carries the values of its numbers, so they are not parsed again.
+static int64_t json_number_as_i64(const JsonStream* stream) {
+    const JsonTapeToken* token = json_tape_current(stream);
+    return token ? token->integer : strtoll(stream->buffer + stream->token_start, NULL, 10);
+}
+
+static double json_number_as_double(const JsonStream* stream) {
+    const JsonTapeToken* token = json_tape_current(stream);
+    return token ? token->real : atof(stream->buffer + stream->token_start);
+}
+
 bool json_try_get_u8(JsonStream* stream, uint8_t* out_u8) {
     if (stream->token_type != JSON_TYPE_NUMBER) {
         if (stream->error.type == JSON_ERROR_NONE) {
@@ -2500,7 +3149,7 @@ bool json_try_get_i8(JsonStream* stream, int8_t* out_i8) {
         return false;
     }
 
-    int64_t result = strtoll(stream->buffer + stream->token_start, NULL, 10);
+    int64_t result = json_number_as_i64(stream);
     if (result > INT8_MAX || result < INT8_MIN) {
         return false;
     }
@@ -2612,7 +3261,7 @@ bool json_try_get_i16(JsonStream* stream, int16_t* out_i16) {
         return false;
     }
 
-    int64_t result = strtoll(stream->buffer + stream->token_start, NULL, 10);
+    int64_t result = json_number_as_i64(stream);
     if (result > INT16_MAX || result < INT16_MIN) {
         return false;
     }
@@ -2722,7 +3371,7 @@ bool json_try_get_i32(JsonStream* stream, int32_t* out_i32) {
         return false;
     }
 
-    int64_t result = strtoll(stream->buffer + stream->token_start, NULL, 10);
+    int64_t result = json_number_as_i64(stream);
     if (result > INT32_MAX || result < INT32_MIN) {
         return false;
     }
@@ -2833,7 +3482,7 @@ bool json_try_get_i64(JsonStream* stream, int64_t* out_i64) {
         return false;
     }
 
-    int64_t result = strtoll(stream->buffer + stream->token_start, NULL, 10);
+    int64_t result = json_number_as_i64(stream);
 
     *out_i64 = result;
     return true;
@@ -2944,7 +3593,7 @@ bool json_try_get_double(JsonStream* stream, double* out_double) {
         return false;
     }
 
-    double result = atof(stream->buffer + stream->token_start);
+    double result = json_number_as_double(stream);
     if (result == HUGE_VAL) {
         return false;
     }
@@ -3043,6 +3692,330 @@ bool json_try_read_array_end(JsonStream* stream) {
     return true;
 }
 
+typedef enum JsonArrayStep {
+    JSON_ARRAY_STEP_VALUE,
+    JSON_ARRAY_STEP_END,
+    JSON_ARRAY_STEP_OTHER,
+    JSON_ARRAY_STEP_STOP,
+} JsonArrayStep;
+
+static const double json_exact_powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+static size_t json_fast_skip_whitespace(const JsonStream* stream, size_t index, size_t* line, size_t* position) {
+    while (!JSON_STREAM_OUT_OF_BOUNDS(stream, index)) {
+        char c = stream->buffer[index];
+        if (c == JSON_CONSTANT_LINE_FEED) {
+            (*line)++;
+            *position = 0;
+        } else if (c == JSON_CONSTANT_SPACE || c == JSON_CONSTANT_CARRIAGE_RETURN || c == JSON_CONSTANT_TAB) {
+            (*position)++;
+        } else {
+            break;
+        }
+        index++;
+    }
+    return index;
+}
+
+// Returns the end of a valid JSON number starting at index, or index when there is none.
+static size_t json_fast_scan_number(const JsonStream* stream, size_t index) {
+    size_t start = index;
+    if (!JSON_STREAM_OUT_OF_BOUNDS(stream, index) && stream->buffer[index] == JSON_CONSTANT_NEGATIVE) {
+        index++;
+    }
+
+    if (JSON_STREAM_OUT_OF_BOUNDS(stream, index) || !json_helper_is_digit(stream->buffer[index])) {
+        return start;
+    }
+    if (stream->buffer[index++] != '0') {
+        while (!JSON_STREAM_OUT_OF_BOUNDS(stream, index) && json_helper_is_digit(stream->buffer[index])) {
+            index++;
+        }
+    }
+
+    if (!JSON_STREAM_OUT_OF_BOUNDS(stream, index) && stream->buffer[index] == '.') {
+        index++;
+        if (JSON_STREAM_OUT_OF_BOUNDS(stream, index) || !json_helper_is_digit(stream->buffer[index])) {
+            return start;
+        }
+        while (!JSON_STREAM_OUT_OF_BOUNDS(stream, index) && json_helper_is_digit(stream->buffer[index])) {
+            index++;
+        }
+    }
+
+    if (!JSON_STREAM_OUT_OF_BOUNDS(stream, index) && (stream->buffer[index] == 'e' || stream->buffer[index] == 'E')) {
+        index++;
+        if (!JSON_STREAM_OUT_OF_BOUNDS(stream, index)
+            && (stream->buffer[index] == '+' || stream->buffer[index] == JSON_CONSTANT_NEGATIVE))
+        {
+            index++;
+        }
+        if (JSON_STREAM_OUT_OF_BOUNDS(stream, index) || !json_helper_is_digit(stream->buffer[index])) {
+            return start;
+        }
+        while (!JSON_STREAM_OUT_OF_BOUNDS(stream, index) && json_helper_is_digit(stream->buffer[index])) {
+            index++;
+        }
+    }
+
+    return index;
+}
+
+static size_t json_fast_match_literal(const JsonStream* stream, size_t index, const char* literal) {
+    size_t start = index;
+    for (; *literal; literal++, index++) {
+        if (JSON_STREAM_OUT_OF_BOUNDS(stream, index) || stream->buffer[index] != *literal) {
+            return start;
+        }
+    }
+    return index;
+}
+
+// Reads the next value of a flat array of numbers or booleans without going through json_read: whitespace, the
+// separator and a complete value followed by a delimiter. Anything else leaves the stream untouched for json_read.
+static bool json_fast_next_scalar(JsonStream* stream, JsonType type) {
+    if (stream->tape || stream->in_object
+        || (stream->token_type != type && stream->token_type != JSON_TYPE_ARRAY_START)
+        || (stream->validate_utf8 == JSON_UTF8_VALIDATION_BUFFER && !stream->buffer_utf8_validated))
+    {
+        return false;
+    }
+
+    size_t line = stream->line_number;
+    size_t position = stream->byte_position_in_line;
+    size_t index = json_fast_skip_whitespace(stream, stream->consumed, &line, &position);
+    if (stream->token_type == type) {
+        if (JSON_STREAM_OUT_OF_BOUNDS(stream, index) || stream->buffer[index] != JSON_CONSTANT_LIST_SEPARATOR) {
+            return false;
+        }
+        position++;
+        index = json_fast_skip_whitespace(stream, index + 1, &line, &position);
+    }
+
+    size_t start = index;
+    if (type == JSON_TYPE_NUMBER) {
+        index = json_fast_scan_number(stream, index);
+    } else {
+        index = json_fast_match_literal(stream, index, "true");
+        if (index == start) {
+            index = json_fast_match_literal(stream, index, "false");
+        }
+    }
+
+    // The value must be followed by a delimiter in this buffer; a value at its very end is left to json_read.
+    if (index == start || JSON_STREAM_OUT_OF_BOUNDS(stream, index)
+        || strchr(JSON_CONSTANT_DELIMITERS, stream->buffer[index]) == NULL)
+    {
+        return false;
+    }
+
+    stream->token_type = type;
+    stream->token_start = start;
+    stream->token_size = index - start;
+    stream->consumed = index;
+    stream->line_number = line;
+    stream->byte_position_in_line = position + (index - start);
+    stream->value_is_escaped = false;
+    stream->trailing_comma = false;
+    return true;
+}
+
+static JsonArrayStep json_array_step(JsonStream* stream, JsonType type, JsonRollbackState* state) {
+    for (;;) {
+        json_rollback_init(stream, state);
+        if (json_fast_next_scalar(stream, type)) {
+            return JSON_ARRAY_STEP_VALUE;
+        }
+
+        if (!json_read(stream)) {
+            return JSON_ARRAY_STEP_STOP;
+        }
+
+        if (stream->token_type == type) {
+            return JSON_ARRAY_STEP_VALUE;
+        }
+        if (stream->token_type == JSON_TYPE_ARRAY_END) {
+            return JSON_ARRAY_STEP_END;
+        }
+        if (stream->token_type != JSON_TYPE_COMMENT) {
+            return JSON_ARRAY_STEP_OTHER;
+        }
+    }
+}
+
+typedef bool (*JsonArrayStore)(JsonStream* stream, void* values, size_t index);
+
+static bool json_read_array_scalars(
+    JsonStream* stream,
+    JsonType type,
+    JsonErrorType error,
+    JsonArrayStore store,
+    void* values,
+    size_t capacity,
+    size_t* out_count
+) {
+    size_t count = 0;
+    bool result = true;
+    JsonRollbackState state;
+
+    while (count < capacity) {
+        JsonArrayStep step = json_array_step(stream, type, &state);
+        if (step == JSON_ARRAY_STEP_END) {
+            break;
+        }
+        if (step == JSON_ARRAY_STEP_STOP) {
+            result = false;
+            break;
+        }
+        if (step == JSON_ARRAY_STEP_OTHER || !store(stream, values, count)) {
+            if (stream->error.type == JSON_ERROR_NONE) {
+                JsonType token_type = stream->token_type;
+                json_rollback(stream, &state);
+                json_throw_string(stream, error, json_token_type_name(token_type));
+            }
+            result = false;
+            break;
+        }
+        count++;
+    }
+
+    *out_count = count;
+    return result;
+}
+
+// Integers only, without the rounding of strtoll on fractions or its clamping on overflow.
+bool json_parse_i64(const char* text, size_t length, int64_t* out) {
+    bool negative = text[0] == JSON_CONSTANT_NEGATIVE;
+    size_t index = negative ? 1 : 0;
+    uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+    uint64_t value = 0;
+    for (; index < length; index++) {
+        unsigned digit = (unsigned)(text[index] - '0');
+        if (digit > 9 || value > (limit - digit) / 10) {
+            return false;
+        }
+        value = value * 10 + digit;
+    }
+
+    *out = negative ? (int64_t)(0 - value) : (int64_t)value;
+    return true;
+}
+
+// Numbers with at most 19 significant digits and a small exponent are exact in doubles, so one multiplication or
+// division by an exact power of ten rounds correctly. The rest goes to strtod on a NUL-terminated copy.
+bool json_parse_double(JsonStream* stream, const char* text, size_t length, double* out) {
+    size_t index = text[0] == JSON_CONSTANT_NEGATIVE ? 1 : 0;
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int64_t exponent = 0;
+
+    for (; index < length && json_helper_is_digit(text[index]); index++) {
+        if (mantissa != 0 || text[index] != '0') {
+            mantissa = mantissa * 10 + (uint64_t)(text[index] - '0');
+            digits++;
+        }
+    }
+    if (index < length && text[index] == '.') {
+        for (index++; index < length && json_helper_is_digit(text[index]); index++) {
+            if (mantissa != 0 || text[index] != '0') {
+                mantissa = mantissa * 10 + (uint64_t)(text[index] - '0');
+                digits++;
+            }
+            exponent--;
+        }
+    }
+    if (index < length) {
+        index++;
+        bool negative_exponent = text[index] == JSON_CONSTANT_NEGATIVE;
+        if (text[index] == '+' || negative_exponent) {
+            index++;
+        }
+        int64_t value = 0;
+        for (; index < length && value < 100000; index++) {
+            value = value * 10 + (text[index] - '0');
+        }
+        exponent += negative_exponent ? -value : value;
+    }
+
+    if (digits <= 19 && mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+        double value = (double)mantissa;
+        value = exponent < 0 ? value / json_exact_powers_of_ten[-exponent] : value * json_exact_powers_of_ten[exponent];
+        *out = text[0] == JSON_CONSTANT_NEGATIVE ? -value : value;
+        return true;
+    }
+
+    char buffer[64];
+    char* copy = buffer;
+    if (length >= sizeof(buffer)) {
+        if (!json_reserve_scratch(stream, length + 1)) {
+            return false;
+        }
+        copy = stream->scratch;
+    }
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+    // strtod overflows to infinity, which is not the number the text holds.
+    double value = strtod(copy, NULL);
+    if (value == HUGE_VAL || value == -HUGE_VAL) {
+        return false;
+    }
+
+    *out = value;
+    return true;
+}
+
+static bool json_store_i64(JsonStream* stream, void* values, size_t index) {
+    return json_parse_i64(stream->buffer + stream->token_start, stream->token_size, (int64_t*)values + index);
+}
+
+static bool json_store_double(JsonStream* stream, void* values, size_t index) {
+    return json_parse_double(stream, stream->buffer + stream->token_start, stream->token_size, (double*)values + index);
+}
+
+static bool json_store_bool(JsonStream* stream, void* values, size_t index) {
+    ((bool*)values)[index] = stream->buffer[stream->token_start] == 't';
+    return true;
+}
+
+bool json_read_array_i64(JsonStream* stream, int64_t* values, size_t capacity, size_t* out_count) {
+    return json_read_array_scalars(
+        stream,
+        JSON_TYPE_NUMBER,
+        JSON_ERROR_INVALID_OPERATION_EXPECTED_I64,
+        json_store_i64,
+        values,
+        capacity,
+        out_count
+    );
+}
+
+bool json_read_array_double(JsonStream* stream, double* values, size_t capacity, size_t* out_count) {
+    return json_read_array_scalars(
+        stream,
+        JSON_TYPE_NUMBER,
+        JSON_ERROR_INVALID_OPERATION_EXPECTED_DOUBLE,
+        json_store_double,
+        values,
+        capacity,
+        out_count
+    );
+}
+
+bool json_read_array_bool(JsonStream* stream, bool* values, size_t capacity, size_t* out_count) {
+    return json_read_array_scalars(
+        stream,
+        JSON_TYPE_BOOLEAN,
+        JSON_ERROR_INVALID_OPERATION_EXPECTED_BOOL,
+        json_store_bool,
+        values,
+        capacity,
+        out_count
+    );
+}
+
 bool json_read_object_start(JsonStream* stream) {
     JsonRollbackState state;
     json_rollback_init(stream, &state);
@@ -3392,6 +4365,43 @@ bool json_error_get_message(const JsonError* error, char* buffer, size_t buffer_
                 "json_is_final_block is true, or call json_try_skip"
             );
             break;
+        case JSON_ERROR_INVALID_UTF8:
+            result = snprintf(
+                buffer,
+                buffer_length,
+                "Invalid UTF-8 sequence at byte offset %lld",
+                (long long)error->number
+            );
+            break;
+        case JSON_ERROR_INVALID_UTF16_SURROGATE:
+            result = snprintf(
+                buffer,
+                buffer_length,
+                "Cannot read invalid UTF-16 JSON text as string. Invalid surrogate value: '0x%04llX'",
+                (long long)error->number
+            );
+            break;
+        case JSON_ERROR_REQUIRED_PROPERTY_NOT_FOUND:
+            result = snprintf(buffer, buffer_length, "Required property '%s' was not found", error->string);
+            break;
+        case JSON_ERROR_INVALID_SCHEMA:
+            result = snprintf(buffer, buffer_length, "Invalid value for schema keyword '%s'", error->string);
+            break;
+        case JSON_ERROR_SCHEMA_VIOLATION:
+            result = snprintf(buffer, buffer_length, "Value does not satisfy schema keyword '%s'", error->string);
+            break;
+        case JSON_ERROR_INVALID_CHECKPOINT:
+            result = snprintf(buffer, buffer_length, "Invalid or incompatible stream checkpoint");
+            break;
+        case JSON_ERROR_READ_FAILED:
+            result = snprintf(buffer, buffer_length, "Reading the input failed: %s", error->string);
+            break;
+        case JSON_ERROR_WRITE_FAILED:
+            result = snprintf(buffer, buffer_length, "Writing the output failed");
+            break;
+        case JSON_ERROR_INVALID_TAPE:
+            result = snprintf(buffer, buffer_length, "Invalid token tape");
+            break;
         case JSON_ERROR_INVALID_OPERATION_EXPECTED_STRING_COMPARISON:
             result =
                 snprintf(buffer, buffer_length, "Cannot compare the value of a token type '%s' to text", error->string);
@@ -3517,3 +4527,7 @@ const char* json_token_type_name(JsonType type) {
 void json_clear_error(JsonStream* stream) {
     stream->error = (JsonError){0};
 }
+
+void json_raise_error(JsonStream* stream, JsonErrorType type, const char* string) {
+    json_throw_string(stream, type, string);
+}
@@ -0,0 +1,563 @@
+// mmap and open are POSIX, not ISO C.
+#define _GNU_SOURCE
+
+#include "json_tape.h"
+
+#include <assert.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "bit_stack.h"
+#include "json_internal.h"
+
+#define JSON_TAPE_MAGIC "JSTP"
+#define JSON_TAPE_BYTE_ORDER 0x01020304u
+#define JSON_TAPE_TOKEN_STEP 256
+
+typedef struct JsonTapeHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t token_size;
+    uint64_t token_count;
+    uint64_t document_length;
+    uint64_t tokens_offset;
+    uint64_t document_offset;
+} JsonTapeHeader;
+
+static_assert(sizeof(JsonTapeHeader) == JSON_TAPE_HEADER_SIZE, "the tape header is written as is");
+
+// The tokens follow the header and the document follows the tokens, NUL-terminated like a string.
+static size_t json_tape_layout(size_t token_count, size_t document_length, JsonTapeHeader* header) {
+    memset(header, 0, sizeof(JsonTapeHeader));
+    memcpy(header->magic, JSON_TAPE_MAGIC, 4);
+    header->version = JSON_TAPE_VERSION;
+    header->byte_order = JSON_TAPE_BYTE_ORDER;
+    header->token_size = sizeof(JsonTapeToken);
+    header->token_count = token_count;
+    header->document_length = document_length;
+    header->tokens_offset = sizeof(JsonTapeHeader);
+    header->document_offset = header->tokens_offset + token_count * sizeof(JsonTapeToken);
+    return header->document_offset + document_length + 1;
+}
+
+static void json_tape_attach(JsonTape* tape, void* memory, size_t memory_length, bool mapped) {
+    const JsonTapeHeader* header = memory;
+    tape->memory = memory;
+    tape->memory_length = memory_length;
+    tape->mapped = mapped;
+    tape->tokens = (const JsonTapeToken*)((const char*)memory + header->tokens_offset);
+    tape->token_count = header->token_count;
+    tape->document = (const char*)memory + header->document_offset;
+    tape->document_length = header->document_length;
+}
+
+// Appends the token json_read just produced to a growing token array.
+static bool json_tape_push(JsonStream* stream, JsonTapeToken** tokens, size_t* count, size_t* capacity) {
+    if (*count == *capacity) {
+        size_t grown_capacity = *capacity ? *capacity * 2 : JSON_TAPE_TOKEN_STEP;
+        JsonTapeToken* grown = realloc(*tokens, grown_capacity * sizeof(JsonTapeToken));
+        if (!grown) {
+            json_throw(stream, JSON_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+        *tokens = grown;
+        *capacity = grown_capacity;
+    }
+
+    JsonTapeToken* token = &(*tokens)[(*count)++];
+    memset(token, 0, sizeof(JsonTapeToken));
+    token->start = stream->token_start;
+    token->consumed = stream->consumed;
+    token->size = stream->token_size;
+    token->depth = (uint32_t)json_current_depth(stream);
+    token->type = (uint8_t)stream->token_type;
+    token->flags = stream->value_is_escaped ? JSON_TAPE_ESCAPED : 0;
+    if (stream->token_type == JSON_TYPE_NUMBER) {
+        json_try_get_i64(stream, &token->integer);
+        token->real = HUGE_VAL;
+        json_try_get_double(stream, &token->real);
+    }
+    return true;
+}
+
+// Reads the rest of the stream into a growing token array.
+static bool json_tape_record(JsonStream* stream, JsonTapeToken** out_tokens, size_t* out_count) {
+    JsonTapeToken* tokens = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+    while (json_read(stream)) {
+        if (!json_tape_push(stream, &tokens, &count, &capacity)) {
+            break;
+        }
+    }
+
+    if (stream->error.type != JSON_ERROR_NONE) {
+        free(tokens);
+        return false;
+    }
+
+    *out_tokens = tokens;
+    *out_count = count;
+    return true;
+}
+
+// Allocates a tape of token_count tokens holding a copy of the document. The caller fills in the tokens.
+static JsonTapeToken* json_tape_allocate(
+    JsonTape* tape,
+    JsonStream* stream,
+    size_t token_count,
+    const char* document,
+    size_t document_length
+) {
+    JsonTapeHeader header;
+    size_t memory_length = json_tape_layout(token_count, document_length, &header);
+    char* memory = malloc(memory_length);
+    if (!memory) {
+        json_throw(stream, JSON_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    memcpy(memory, &header, sizeof(header));
+    memcpy(memory + header.document_offset, document, document_length);
+    memory[header.document_offset + document_length] = '\0';
+    json_tape_attach(tape, memory, memory_length, false);
+    return (JsonTapeToken*)(memory + header.tokens_offset);
+}
+
+static size_t json_tape_document_length(const JsonStream* stream) {
+    return stream->buffer_size ? stream->buffer_size : strlen(stream->buffer);
+}
+
+bool json_tape_build(JsonTape* tape, JsonStream* stream) {
+    memset(tape, 0, sizeof(JsonTape));
+
+    size_t first = json_total_bytes_consumed(stream);
+    JsonTapeToken* tokens;
+    size_t count;
+    if (!json_tape_record(stream, &tokens, &count)) {
+        return false;
+    }
+
+    JsonTapeToken* stored =
+        json_tape_allocate(tape, stream, count, stream->buffer, json_tape_document_length(stream));
+    if (stored) {
+        memcpy(stored, tokens, count * sizeof(JsonTapeToken));
+        tape->tokenized_length = json_total_bytes_consumed(stream) - first;
+    }
+    free(tokens);
+    return stored != NULL;
+}
+
+// Moves index to the start token of the container holding the token at index. Values of a container are one level
+// deeper than its brackets, and everything between its start and the value is deeper still.
+static bool json_tape_parent(const JsonTapeToken* tokens, size_t* index) {
+    uint32_t depth = tokens[*index].depth;
+    if (depth == 0) {
+        return false;
+    }
+
+    size_t i = *index;
+    while (i > 0) {
+        i--;
+        if (tokens[i].depth == depth - 1) {
+            *index = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// The index of the first token starting at or after offset.
+static size_t json_tape_lower_bound(const JsonTape* tape, size_t offset) {
+    size_t low = 0;
+    size_t high = tape->token_count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (tape->tokens[middle].start < offset) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+// Finds the innermost container whose brackets enclose [offset, end) of the previous document, as the indexes of its
+// start and end tokens. Only the tokens between the edit and the container's brackets are visited.
+static bool json_tape_enclosing(
+    const JsonTape* previous,
+    size_t offset,
+    size_t end,
+    size_t* out_start,
+    size_t* out_end
+) {
+    const JsonTapeToken* tokens = previous->tokens;
+    size_t low = json_tape_lower_bound(previous, offset);
+    if (low == 0) {
+        return false;
+    }
+
+    size_t start = low - 1;
+    JsonType type = (JsonType)tokens[start].type;
+    if (type != JSON_TYPE_OBJECT_START && type != JSON_TYPE_ARRAY_START && !json_tape_parent(tokens, &start)) {
+        return false;
+    }
+
+    size_t next = low;
+    for (;;) {
+        // The first later token at the depth of a start token closes its container.
+        while (next < previous->token_count && tokens[next].depth != tokens[start].depth) {
+            next++;
+        }
+        if (next == previous->token_count) {
+            return false;
+        }
+        if (tokens[next].start >= end) {
+            *out_start = start;
+            *out_end = next;
+            return true;
+        }
+        if (!json_tape_parent(tokens, &start)) {
+            return false;
+        }
+        next++;
+    }
+}
+
+// Whether the token ends a value, after which a container expects a comma or its closing bracket.
+static bool json_tape_ends_value(const JsonTapeToken* token) {
+    switch ((JsonType)token->type) {
+        case JSON_TYPE_OBJECT_END:
+        case JSON_TYPE_ARRAY_END:
+        case JSON_TYPE_STRING:
+        case JSON_TYPE_NUMBER:
+        case JSON_TYPE_BOOLEAN:
+        case JSON_TYPE_NULL:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool json_tape_edit(
+    JsonTape* tape,
+    const JsonTape* previous,
+    JsonStream* stream,
+    size_t offset,
+    size_t removed_length,
+    size_t inserted_length
+) {
+    size_t length = json_tape_document_length(stream);
+    size_t start;
+    size_t end;
+    if (offset > previous->document_length || removed_length > previous->document_length - offset
+        || previous->document_length - removed_length + inserted_length != length
+        || !json_tape_enclosing(previous, offset, offset + removed_length, &start, &end))
+    {
+        return json_tape_build(tape, stream);
+    }
+
+    // Tokenizing resumes after the last element of the container that ends before the edit, or after its opening
+    // bracket; the element's last byte is followed by one the edit left alone, so the token stands.
+    const JsonTapeToken* tokens = previous->tokens;
+    uint32_t depth = tokens[start].depth;
+    size_t resume = json_tape_lower_bound(previous, offset);
+    while (--resume > start) {
+        if (tokens[resume].depth == depth + 1 && tokens[resume].consumed < offset
+            && json_tape_ends_value(&tokens[resume]))
+        {
+            break;
+        }
+    }
+
+    size_t base = tokens[resume].consumed;
+    size_t delta = inserted_length - removed_length;
+    size_t edit_end = offset + removed_length;
+    bool is_object = tokens[start].type == JSON_TYPE_OBJECT_START;
+
+    // The closing bracket moves with the edit and stays after the resume point, unless the tokens were tampered with.
+    size_t close = tokens[end].start + delta;
+    if (close < base || close >= length) {
+        json_throw(stream, JSON_ERROR_INVALID_TAPE);
+        return false;
+    }
+
+    JsonStreamOptions options = json_stream_options_default();
+    options.allow_trailing_commas = stream->allow_trailing_commas;
+    options.comment_handling = stream->comment_handling;
+    options.validate_utf8 = stream->validate_utf8;
+    options.max_depth = stream->max_depth - depth;
+    JsonStream slice;
+    json_stream_init(&slice, stream->buffer + base, close + 1 - base, true, options);
+    if (!json_z_bits_push(&slice.bits, is_object)) {
+        json_stream_free_resources(&slice);
+        json_throw(stream, JSON_ERROR_OUT_OF_MEMORY);
+        return false;
+    }
+    slice.in_object = is_object;
+    slice.token_type = (JsonType)tokens[resume].type;
+
+    // It stops at the first value that lines up with one of previous after the edit: from there on both documents
+    // hold the same bytes in the same state. The container's closing bracket lines up unless the edit broke it.
+    JsonTapeToken* replaced = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+    size_t match = json_tape_lower_bound(previous, edit_end);
+    bool aligned = false;
+    while (!aligned && json_read(&slice)) {
+        if (!json_tape_push(&slice, &replaced, &count, &capacity)) {
+            break;
+        }
+
+        JsonTapeToken* token = &replaced[count - 1];
+        token->start += base;
+        token->consumed += base;
+        token->depth += depth;
+        if (json_z_bits_count(&slice.bits) > 1 || !json_tape_ends_value(token) || token->start < edit_end + delta) {
+            continue;
+        }
+
+        while (match <= end && tokens[match].start + delta < token->start) {
+            match++;
+        }
+        aligned = match <= end && tokens[match].start + delta == token->start
+               && tokens[match].consumed + delta == token->consumed && tokens[match].size == token->size
+               && tokens[match].depth == token->depth && tokens[match].type == token->type;
+    }
+    aligned = aligned && slice.error.type == JSON_ERROR_NONE;
+    size_t tokenized_length = json_total_bytes_consumed(&slice);
+    json_stream_free_resources(&slice);
+    if (!aligned) {
+        free(replaced);
+        return json_tape_build(tape, stream);
+    }
+
+    size_t following = previous->token_count - match - 1;
+    JsonTapeToken* stored = json_tape_allocate(tape, stream, resume + 1 + count + following, stream->buffer, length);
+    if (!stored) {
+        free(replaced);
+        return false;
+    }
+
+    memcpy(stored, tokens, (resume + 1) * sizeof(JsonTapeToken));
+    memcpy(stored + resume + 1, replaced, count * sizeof(JsonTapeToken));
+    for (size_t i = 0; i < following; i++) {
+        JsonTapeToken* token = &stored[resume + 1 + count + i];
+        *token = tokens[match + 1 + i];
+        token->start += delta;
+        token->consumed += delta;
+    }
+    tape->tokenized_length = tokenized_length;
+
+    free(replaced);
+    return true;
+}
+
+bool json_tape_save(const JsonTape* tape, const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+
+    bool result = fwrite(tape->memory, 1, tape->memory_length, file) == tape->memory_length;
+    return fclose(file) == 0 && result;
+}
+
+// Checks a token against the document and the token before it: its bytes lie within the document after the previous
+// token's, and its depth follows from the previous token's depth and type. json_tape_edit indexes the tokens of a tape
+// by these fields without checking them again.
+static bool json_tape_valid_token(const JsonTapeToken* tokens, size_t index, uint64_t document_length) {
+    const JsonTapeToken* token = &tokens[index];
+    if (token->type > JSON_TYPE_COMMENT || token->consumed > document_length || token->start > token->consumed
+        || token->size > token->consumed - token->start)
+    {
+        return false;
+    }
+
+    if (index == 0) {
+        return true;
+    }
+
+    const JsonTapeToken* previous = &tokens[index - 1];
+    uint64_t depth = previous->depth;
+    if (previous->type == JSON_TYPE_OBJECT_START || previous->type == JSON_TYPE_ARRAY_START) {
+        depth++;
+    }
+    if (token->type == JSON_TYPE_OBJECT_END || token->type == JSON_TYPE_ARRAY_END) {
+        if (depth == 0) {
+            return false;
+        }
+        depth--;
+    }
+
+    // A token starts no earlier than the previous one was consumed, so starts increase along with consumed offsets.
+    return token->depth == depth && token->start > previous->start && token->start >= previous->consumed
+        && token->consumed > previous->consumed;
+}
+
+static bool json_tape_valid(const void* memory, size_t length) {
+    if (length < sizeof(JsonTapeHeader)) {
+        return false;
+    }
+
+    const JsonTapeHeader* header = memory;
+    if (memcmp(header->magic, JSON_TAPE_MAGIC, 4) != 0 || header->version != JSON_TAPE_VERSION
+        || header->byte_order != JSON_TAPE_BYTE_ORDER || header->token_size != sizeof(JsonTapeToken)
+        || header->token_count > (length - sizeof(JsonTapeHeader)) / sizeof(JsonTapeToken)
+        || header->document_length >= length)
+    {
+        return false;
+    }
+
+    JsonTapeHeader expected;
+    if (json_tape_layout(header->token_count, header->document_length, &expected) != length
+        || header->tokens_offset != expected.tokens_offset || header->document_offset != expected.document_offset)
+    {
+        return false;
+    }
+
+    if (((const char*)memory)[length - 1] != '\0') {
+        return false;
+    }
+
+    const JsonTapeToken* tokens = (const JsonTapeToken*)((const char*)memory + header->tokens_offset);
+    for (size_t i = 0; i < header->token_count; i++) {
+        if (!json_tape_valid_token(tokens, i, header->document_length)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool json_tape_map(JsonTape* tape, const char* path) {
+    memset(tape, 0, sizeof(JsonTape));
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+
+    size_t length = (size_t)info.st_size;
+    void* memory = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        return false;
+    }
+
+    if (!json_tape_valid(memory, length)) {
+        munmap(memory, length);
+        return false;
+    }
+
+    json_tape_attach(tape, memory, length, true);
+    return true;
+}
+
+void json_tape_free(JsonTape* tape) {
+    if (tape->mapped) {
+        munmap(tape->memory, tape->memory_length);
+    } else {
+        free(tape->memory);
+    }
+    memset(tape, 0, sizeof(JsonTape));
+}
+
+void json_stream_init_tape(JsonStream* stream, const JsonTape* tape, JsonStreamOptions options) {
+    json_stream_init(stream, tape->document, tape->document_length, true, options);
+    stream->tape = tape->tokens;
+    stream->tape_count = tape->token_count;
+}
+
+const JsonTapeToken* json_tape_current(const JsonStream* stream) {
+    if (!stream->tape || stream->tape_index == 0) {
+        return NULL;
+    }
+
+    const JsonTapeToken* token = &stream->tape[stream->tape_index - 1];
+    return token->consumed == stream->consumed ? token : NULL;
+}
+
+// Tokens are stored in document order, so their consumed offsets strictly increase.
+static size_t json_tape_find(const JsonStream* stream) {
+    size_t low = 0;
+    size_t high = stream->tape_count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (stream->tape[middle].consumed <= stream->consumed) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+static bool json_tape_invalid(JsonStream* stream) {
+    json_throw(stream, JSON_ERROR_INVALID_TAPE);
+    return false;
+}
+
+bool json_tape_read(JsonStream* stream) {
+    if (stream->error.type != JSON_ERROR_NONE) {
+        return false;
+    }
+
+    // A rollback moves the stream back behind the token read last.
+    size_t index = stream->tape_index;
+    size_t previous = index > 0 ? stream->tape[index - 1].consumed : 0;
+    if (previous != stream->consumed) {
+        index = json_tape_find(stream);
+    }
+
+    if (index >= stream->tape_count) {
+        stream->token_start = 0;
+        stream->token_size = 0;
+        return false;
+    }
+
+    const JsonTapeToken* token = &stream->tape[index];
+    if (token->start > stream->buffer_size || token->size > stream->buffer_size - token->start
+        || token->consumed > stream->buffer_size || token->type > JSON_TYPE_COMMENT)
+    {
+        return json_tape_invalid(stream);
+    }
+
+    JsonType type = (JsonType)token->type;
+    if (type == JSON_TYPE_OBJECT_START || type == JSON_TYPE_ARRAY_START) {
+        if (!json_z_bits_push(&stream->bits, type == JSON_TYPE_OBJECT_START)) {
+            json_throw(stream, JSON_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+        stream->in_object = type == JSON_TYPE_OBJECT_START;
+    } else if (type == JSON_TYPE_OBJECT_END || type == JSON_TYPE_ARRAY_END) {
+        if (json_z_bits_count(&stream->bits) == 0) {
+            return json_tape_invalid(stream);
+        }
+        stream->in_object = json_z_bits_pop(&stream->bits);
+    }
+
+    if (type == JSON_TYPE_COMMENT && stream->token_type != JSON_TYPE_COMMENT) {
+        stream->previous_token_type = stream->token_type;
+    }
+
+    stream->token_type = type;
+    stream->token_start = token->start;
+    stream->token_size = token->size;
+    stream->consumed = token->consumed;
+    stream->value_is_escaped = token->flags & JSON_TAPE_ESCAPED;
+    stream->trailing_comma = false;
+    stream->tape_index = index + 1;
+    return true;
+}
@@ -0,0 +1,387 @@
+#include "json_transcode.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "json_internal.h"
+
+#define JSON_TRANSCODE_CONTAINER_STEP 16
+
+#define JSON_CBOR_UNSIGNED 0x00
+#define JSON_CBOR_NEGATIVE 0x20
+#define JSON_CBOR_TEXT 0x60
+#define JSON_CBOR_ARRAY_INDEFINITE 0x9F
+#define JSON_CBOR_MAP_INDEFINITE 0xBF
+#define JSON_CBOR_FALSE 0xF4
+#define JSON_CBOR_TRUE 0xF5
+#define JSON_CBOR_NULL 0xF6
+#define JSON_CBOR_DOUBLE 0xFB
+#define JSON_CBOR_BREAK 0xFF
+
+#define JSON_MSGPACK_NIL 0xC0
+#define JSON_MSGPACK_FALSE 0xC2
+#define JSON_MSGPACK_TRUE 0xC3
+#define JSON_MSGPACK_DOUBLE 0xCB
+#define JSON_MSGPACK_MAP32 0xDF
+#define JSON_MSGPACK_ARRAY32 0xDD
+#define JSON_MSGPACK_HEADER_SIZE 5
+
+void json_transcoder_init(
+    JsonTranscoder* transcoder,
+    JsonTranscodeFormat format,
+    JsonTranscodeWrite write,
+    void* context
+) {
+    memset(transcoder, 0, sizeof(JsonTranscoder));
+    transcoder->format = format;
+    transcoder->write = write;
+    transcoder->context = context;
+}
+
+void json_transcoder_free(JsonTranscoder* transcoder) {
+    free(transcoder->output);
+    free(transcoder->containers);
+    transcoder->output = NULL;
+    transcoder->containers = NULL;
+    transcoder->output_length = 0;
+    transcoder->output_capacity = 0;
+    transcoder->depth = 0;
+    transcoder->container_capacity = 0;
+}
+
+static uint8_t* json_transcode_reserve(JsonTranscoder* transcoder, JsonStream* stream, size_t length) {
+    if (transcoder->output_length + length > transcoder->output_capacity) {
+        size_t capacity = transcoder->output_capacity ? transcoder->output_capacity : JSON_TRANSCODE_FLUSH_SIZE;
+        while (capacity < transcoder->output_length + length) {
+            capacity *= 2;
+        }
+
+        uint8_t* output = realloc(transcoder->output, capacity);
+        if (!output) {
+            json_throw(stream, JSON_ERROR_OUT_OF_MEMORY);
+            return NULL;
+        }
+        transcoder->output = output;
+        transcoder->output_capacity = capacity;
+    }
+
+    uint8_t* destination = transcoder->output + transcoder->output_length;
+    transcoder->output_length += length;
+    return destination;
+}
+
+static void json_transcode_store_be(uint8_t* destination, uint64_t value, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        destination[i] = (uint8_t)(value >> (8 * (size - 1 - i)));
+    }
+}
+
+static bool json_transcode_byte(JsonTranscoder* transcoder, JsonStream* stream, uint8_t byte) {
+    uint8_t* destination = json_transcode_reserve(transcoder, stream, 1);
+    if (!destination) {
+        return false;
+    }
+    *destination = byte;
+    return true;
+}
+
+// Writes a lead byte followed by value in size big-endian bytes.
+static bool json_transcode_head(
+    JsonTranscoder* transcoder,
+    JsonStream* stream,
+    uint8_t lead,
+    uint64_t value,
+    size_t size
+) {
+    uint8_t* destination = json_transcode_reserve(transcoder, stream, 1 + size);
+    if (!destination) {
+        return false;
+    }
+    destination[0] = lead;
+    json_transcode_store_be(destination + 1, value, size);
+    return true;
+}
+
+static bool json_transcode_cbor_head(JsonTranscoder* transcoder, JsonStream* stream, uint8_t major, uint64_t value) {
+    if (value < 24) {
+        return json_transcode_byte(transcoder, stream, (uint8_t)(major | value));
+    }
+    if (value <= UINT8_MAX) {
+        return json_transcode_head(transcoder, stream, major | 24, value, 1);
+    }
+    if (value <= UINT16_MAX) {
+        return json_transcode_head(transcoder, stream, major | 25, value, 2);
+    }
+    if (value <= UINT32_MAX) {
+        return json_transcode_head(transcoder, stream, major | 26, value, 4);
+    }
+    return json_transcode_head(transcoder, stream, major | 27, value, 8);
+}
+
+static bool json_transcode_msgpack_unsigned(JsonTranscoder* transcoder, JsonStream* stream, uint64_t value) {
+    if (value < 128) {
+        return json_transcode_byte(transcoder, stream, (uint8_t)value);
+    }
+    if (value <= UINT8_MAX) {
+        return json_transcode_head(transcoder, stream, 0xCC, value, 1);
+    }
+    if (value <= UINT16_MAX) {
+        return json_transcode_head(transcoder, stream, 0xCD, value, 2);
+    }
+    if (value <= UINT32_MAX) {
+        return json_transcode_head(transcoder, stream, 0xCE, value, 4);
+    }
+    return json_transcode_head(transcoder, stream, 0xCF, value, 8);
+}
+
+static bool json_transcode_msgpack_negative(JsonTranscoder* transcoder, JsonStream* stream, int64_t value) {
+    if (value >= -32) {
+        return json_transcode_byte(transcoder, stream, (uint8_t)value);
+    }
+    if (value >= INT8_MIN) {
+        return json_transcode_head(transcoder, stream, 0xD0, (uint8_t)value, 1);
+    }
+    if (value >= INT16_MIN) {
+        return json_transcode_head(transcoder, stream, 0xD1, (uint16_t)value, 2);
+    }
+    if (value >= INT32_MIN) {
+        return json_transcode_head(transcoder, stream, 0xD2, (uint32_t)value, 4);
+    }
+    return json_transcode_head(transcoder, stream, 0xD3, (uint64_t)value, 8);
+}
+
+static bool json_transcode_text(JsonTranscoder* transcoder, JsonStream* stream) {
+    const char* text;
+    size_t length;
+    if (!json_try_get_text(stream, &text, &length)) {
+        return false;
+    }
+
+    bool result;
+    if (transcoder->format == JSON_TRANSCODE_CBOR) {
+        result = json_transcode_cbor_head(transcoder, stream, JSON_CBOR_TEXT, length);
+    } else if (length < 32) {
+        result = json_transcode_byte(transcoder, stream, (uint8_t)(0xA0 | length));
+    } else if (length <= UINT8_MAX) {
+        result = json_transcode_head(transcoder, stream, 0xD9, length, 1);
+    } else if (length <= UINT16_MAX) {
+        result = json_transcode_head(transcoder, stream, 0xDA, length, 2);
+    } else {
+        result = json_transcode_head(transcoder, stream, 0xDB, length, 4);
+    }
+
+    uint8_t* destination = result ? json_transcode_reserve(transcoder, stream, length) : NULL;
+    if (!destination) {
+        return false;
+    }
+    memcpy(destination, text, length);
+    return true;
+}
+
+// Positive integers beyond INT64_MAX still fit the unsigned encodings of both formats.
+static bool json_transcode_parse_u64(const char* text, size_t length, uint64_t* out) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < length; i++) {
+        unsigned digit = (unsigned)(text[i] - '0');
+        if (digit > 9 || value > (UINT64_MAX - digit) / 10) {
+            return false;
+        }
+        value = value * 10 + digit;
+    }
+
+    *out = value;
+    return true;
+}
+
+static bool json_transcode_number(JsonTranscoder* transcoder, JsonStream* stream) {
+    const char* text = stream->buffer + stream->token_start;
+    size_t length = stream->token_size;
+    bool cbor = transcoder->format == JSON_TRANSCODE_CBOR;
+
+    int64_t integer;
+    if (json_parse_i64(text, length, &integer)) {
+        if (integer >= 0) {
+            return cbor ? json_transcode_cbor_head(transcoder, stream, JSON_CBOR_UNSIGNED, (uint64_t)integer)
+                        : json_transcode_msgpack_unsigned(transcoder, stream, (uint64_t)integer);
+        }
+        return cbor ? json_transcode_cbor_head(transcoder, stream, JSON_CBOR_NEGATIVE, (uint64_t)(-1 - integer))
+                    : json_transcode_msgpack_negative(transcoder, stream, integer);
+    }
+
+    uint64_t unsigned_integer;
+    if (json_transcode_parse_u64(text, length, &unsigned_integer)) {
+        return cbor ? json_transcode_cbor_head(transcoder, stream, JSON_CBOR_UNSIGNED, unsigned_integer)
+                    : json_transcode_msgpack_unsigned(transcoder, stream, unsigned_integer);
+    }
+
+    // Neither format has a number wider than a double to hold one beyond its range.
+    double value;
+    if (!json_parse_double(stream, text, length, &value)) {
+        if (stream->error.type == JSON_ERROR_NONE) {
+            json_throw(stream, JSON_ERROR_INVALID_OPERATION_EXPECTED_DOUBLE);
+        }
+        return false;
+    }
+
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return json_transcode_head(transcoder, stream, cbor ? JSON_CBOR_DOUBLE : JSON_MSGPACK_DOUBLE, bits, 8);
+}
+
+static bool json_transcode_open(JsonTranscoder* transcoder, JsonStream* stream, bool is_object) {
+    if (transcoder->format == JSON_TRANSCODE_CBOR) {
+        uint8_t lead = is_object ? JSON_CBOR_MAP_INDEFINITE : JSON_CBOR_ARRAY_INDEFINITE;
+        return json_transcode_byte(transcoder, stream, lead);
+    }
+
+    if (transcoder->depth == transcoder->container_capacity) {
+        size_t capacity = transcoder->container_capacity ? transcoder->container_capacity * 2
+                                                         : JSON_TRANSCODE_CONTAINER_STEP;
+        JsonTranscodeContainer* containers = realloc(transcoder->containers, capacity * sizeof(JsonTranscodeContainer));
+        if (!containers) {
+            json_throw(stream, JSON_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+        transcoder->containers = containers;
+        transcoder->container_capacity = capacity;
+    }
+
+    transcoder->containers[transcoder->depth++] = (JsonTranscodeContainer){
+        .header = transcoder->output_length,
+        .count = 0,
+        .is_object = is_object,
+    };
+    return json_transcode_reserve(transcoder, stream, JSON_MSGPACK_HEADER_SIZE) != NULL;
+}
+
+// Fills in the reserved MessagePack header, moving the contents down when a shorter header suffices.
+static bool json_transcode_close(JsonTranscoder* transcoder, JsonStream* stream) {
+    if (transcoder->format == JSON_TRANSCODE_CBOR) {
+        return json_transcode_byte(transcoder, stream, JSON_CBOR_BREAK);
+    }
+
+    JsonTranscodeContainer* container = &transcoder->containers[--transcoder->depth];
+    uint8_t* header = transcoder->output + container->header;
+    size_t size;
+    if (container->count < 16) {
+        header[0] = (uint8_t)((container->is_object ? 0x80 : 0x90) | container->count);
+        size = 1;
+    } else if (container->count <= UINT16_MAX) {
+        header[0] = container->is_object ? 0xDE : 0xDC;
+        json_transcode_store_be(header + 1, container->count, 2);
+        size = 3;
+    } else {
+        header[0] = container->is_object ? JSON_MSGPACK_MAP32 : JSON_MSGPACK_ARRAY32;
+        json_transcode_store_be(header + 1, container->count, 4);
+        size = JSON_MSGPACK_HEADER_SIZE;
+    }
+
+    if (size < JSON_MSGPACK_HEADER_SIZE) {
+        size_t contents = container->header + JSON_MSGPACK_HEADER_SIZE;
+        memmove(header + size, transcoder->output + contents, transcoder->output_length - contents);
+        transcoder->output_length -= JSON_MSGPACK_HEADER_SIZE - size;
+    }
+
+    return true;
+}
+
+// Writes everything in front of the outermost open MessagePack container, whose header is still to be patched.
+static bool json_transcode_flush(JsonTranscoder* transcoder, JsonStream* stream) {
+    size_t length = transcoder->format == JSON_TRANSCODE_MSGPACK && transcoder->depth > 0
+        ? transcoder->containers[0].header
+        : transcoder->output_length;
+    if (length == 0) {
+        return true;
+    }
+
+    if (!transcoder->write(transcoder->output, length, transcoder->context)) {
+        json_throw(stream, JSON_ERROR_WRITE_FAILED);
+        return false;
+    }
+
+    memmove(transcoder->output, transcoder->output + length, transcoder->output_length - length);
+    transcoder->output_length -= length;
+    for (size_t i = 0; i < transcoder->depth; i++) {
+        transcoder->containers[i].header -= length;
+    }
+    return true;
+}
+
+static bool json_transcode_token(JsonTranscoder* transcoder, JsonStream* stream) {
+    JsonType type = stream->token_type;
+    if (type == JSON_TYPE_COMMENT) {
+        return true;
+    }
+
+    // MessagePack counts the pairs of an object and the values of an array.
+    if (transcoder->depth > 0 && type != JSON_TYPE_OBJECT_END && type != JSON_TYPE_ARRAY_END) {
+        JsonTranscodeContainer* container = &transcoder->containers[transcoder->depth - 1];
+        if (container->is_object == (type == JSON_TYPE_PROPERTY)) {
+            container->count++;
+        }
+    }
+
+    bool cbor = transcoder->format == JSON_TRANSCODE_CBOR;
+    switch (type) {
+        case JSON_TYPE_OBJECT_START:
+            return json_transcode_open(transcoder, stream, true);
+        case JSON_TYPE_ARRAY_START:
+            return json_transcode_open(transcoder, stream, false);
+        case JSON_TYPE_OBJECT_END:
+        case JSON_TYPE_ARRAY_END:
+            return json_transcode_close(transcoder, stream);
+        case JSON_TYPE_PROPERTY:
+        case JSON_TYPE_STRING:
+            return json_transcode_text(transcoder, stream);
+        case JSON_TYPE_NUMBER:
+            return json_transcode_number(transcoder, stream);
+        case JSON_TYPE_BOOLEAN:
+            if (stream->buffer[stream->token_start] == 't') {
+                return json_transcode_byte(transcoder, stream, cbor ? JSON_CBOR_TRUE : JSON_MSGPACK_TRUE);
+            }
+            return json_transcode_byte(transcoder, stream, cbor ? JSON_CBOR_FALSE : JSON_MSGPACK_FALSE);
+        case JSON_TYPE_NULL:
+            return json_transcode_byte(transcoder, stream, cbor ? JSON_CBOR_NULL : JSON_MSGPACK_NIL);
+        default:
+            return true;
+    }
+}
+
+bool json_transcode(JsonTranscoder* transcoder, JsonStream* stream) {
+    while (json_read(stream)) {
+        if (!json_transcode_token(transcoder, stream)) {
+            return false;
+        }
+
+        if (transcoder->output_length >= JSON_TRANSCODE_FLUSH_SIZE && !json_transcode_flush(transcoder, stream)) {
+            return false;
+        }
+    }
+
+    if (stream->error.type != JSON_ERROR_NONE) {
+        return false;
+    }
+
+    return json_transcode_flush(transcoder, stream);
+}
+
+static bool json_transcode_buffer(
+    JsonStream* stream,
+    JsonTranscodeFormat format,
+    JsonTranscodeWrite write,
+    void* context
+) {
+    JsonTranscoder transcoder;
+    json_transcoder_init(&transcoder, format, write, context);
+    bool result = json_transcode(&transcoder, stream);
+    json_transcoder_free(&transcoder);
+    return result;
+}
+
+bool json_transcode_to_cbor(JsonStream* stream, JsonTranscodeWrite write, void* context) {
+    return json_transcode_buffer(stream, JSON_TRANSCODE_CBOR, write, context);
+}
+
+bool json_transcode_to_msgpack(JsonStream* stream, JsonTranscodeWrite write, void* context) {
+    return json_transcode_buffer(stream, JSON_TRANSCODE_MSGPACK, write, context);
+}
@@ -0,0 +1,258 @@
+#include "json_utf8.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define JSON_UTF8_SSSE3
+#include <immintrin.h>
+#endif
+
+#define JSON_UTF8_ASCII_MASK 0x8080808080808080ULL
+
+static bool json_utf8_validate_scalar(const unsigned char* buffer, size_t length, size_t* out_error_index) {
+    size_t index = 0;
+    while (index < length) {
+        if (length - index >= 8) {
+            uint64_t word;
+            memcpy(&word, buffer + index, sizeof(word));
+            if ((word & JSON_UTF8_ASCII_MASK) == 0) {
+                index += 8;
+                continue;
+            }
+        }
+
+        unsigned char lead = buffer[index];
+        if (lead < 0x80) {
+            index++;
+            continue;
+        }
+
+        size_t continuations;
+        unsigned char low = 0x80;
+        unsigned char high = 0xBF;
+
+        if (lead >= 0xC2 && lead <= 0xDF) {
+            continuations = 1;
+        } else if (lead == 0xE0) {
+            continuations = 2;
+            low = 0xA0;
+        } else if (lead == 0xED) {
+            continuations = 2;
+            high = 0x9F;
+        } else if (lead >= 0xE1 && lead <= 0xEF) {
+            continuations = 2;
+        } else if (lead == 0xF0) {
+            continuations = 3;
+            low = 0x90;
+        } else if (lead >= 0xF1 && lead <= 0xF3) {
+            continuations = 3;
+        } else if (lead == 0xF4) {
+            continuations = 3;
+            high = 0x8F;
+        } else {
+            goto error;
+        }
+
+        if (length - index <= continuations) {
+            goto error;
+        }
+
+        // Only the first continuation byte has a restricted range.
+        unsigned char next = buffer[index + 1];
+        if (next < low || next > high) {
+            goto error;
+        }
+
+        for (size_t i = 2; i <= continuations; i++) {
+            if ((buffer[index + i] & 0xC0) != 0x80) {
+                goto error;
+            }
+        }
+
+        index += continuations + 1;
+    }
+
+    return true;
+
+error:
+    *out_error_index = index;
+    return false;
+}
+
+#ifdef JSON_UTF8_SSSE3
+
+// Lookup-table validation from Keiser & Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte".
+// Each table maps a nibble to the set of error classes it can take part in; a byte pair is invalid when
+// the intersection of all three lookups is non-empty.
+#define JSON_UTF8_TOO_SHORT (1 << 0)
+#define JSON_UTF8_TOO_LONG (1 << 1)
+#define JSON_UTF8_OVERLONG_3 (1 << 2)
+#define JSON_UTF8_TOO_LARGE (1 << 3)
+#define JSON_UTF8_SURROGATE (1 << 4)
+#define JSON_UTF8_OVERLONG_2 (1 << 5)
+#define JSON_UTF8_TOO_LARGE_1000 (1 << 6)
+#define JSON_UTF8_OVERLONG_4 (1 << 6)
+#define JSON_UTF8_TWO_CONTS (1 << 7)
+#define JSON_UTF8_CARRY (JSON_UTF8_TOO_SHORT | JSON_UTF8_TOO_LONG | JSON_UTF8_TWO_CONTS)
+
+static const uint8_t json_utf8_byte_1_high[16] = {
+    JSON_UTF8_TOO_LONG,
+    JSON_UTF8_TOO_LONG,
+    JSON_UTF8_TOO_LONG,
+    JSON_UTF8_TOO_LONG,
+    JSON_UTF8_TOO_LONG,
+    JSON_UTF8_TOO_LONG,
+    JSON_UTF8_TOO_LONG,
+    JSON_UTF8_TOO_LONG,
+    JSON_UTF8_TWO_CONTS,
+    JSON_UTF8_TWO_CONTS,
+    JSON_UTF8_TWO_CONTS,
+    JSON_UTF8_TWO_CONTS,
+    JSON_UTF8_TOO_SHORT | JSON_UTF8_OVERLONG_2,
+    JSON_UTF8_TOO_SHORT,
+    JSON_UTF8_TOO_SHORT | JSON_UTF8_OVERLONG_3 | JSON_UTF8_SURROGATE,
+    JSON_UTF8_TOO_SHORT | JSON_UTF8_TOO_LARGE | JSON_UTF8_TOO_LARGE_1000 | JSON_UTF8_OVERLONG_4,
+};
+
+static const uint8_t json_utf8_byte_1_low[16] = {
+    JSON_UTF8_CARRY | JSON_UTF8_OVERLONG_3 | JSON_UTF8_OVERLONG_2 | JSON_UTF8_OVERLONG_4,
+    JSON_UTF8_CARRY | JSON_UTF8_OVERLONG_2,
+    JSON_UTF8_CARRY,
+    JSON_UTF8_CARRY,
+    JSON_UTF8_CARRY | JSON_UTF8_TOO_LARGE,
+    JSON_UTF8_CARRY | JSON_UTF8_TOO_LARGE | JSON_UTF8_TOO_LARGE_1000,
+    JSON_UTF8_CARRY | JSON_UTF8_TOO_LARGE | JSON_UTF8_TOO_LARGE_1000,
+    JSON_UTF8_CARRY | JSON_UTF8_TOO_LARGE | JSON_UTF8_TOO_LARGE_1000,
+    JSON_UTF8_CARRY | JSON_UTF8_TOO_LARGE | JSON_UTF8_TOO_LARGE_1000,
+    JSON_UTF8_CARRY | JSON_UTF8_TOO_LARGE | JSON_UTF8_TOO_LARGE_1000,
+    JSON_UTF8_CARRY | JSON_UTF8_TOO_LARGE | JSON_UTF8_TOO_LARGE_1000,
+    JSON_UTF8_CARRY | JSON_UTF8_TOO_LARGE | JSON_UTF8_TOO_LARGE_1000,
+    JSON_UTF8_CARRY | JSON_UTF8_TOO_LARGE | JSON_UTF8_TOO_LARGE_1000,
+    JSON_UTF8_CARRY | JSON_UTF8_TOO_LARGE | JSON_UTF8_TOO_LARGE_1000 | JSON_UTF8_SURROGATE,
+    JSON_UTF8_CARRY | JSON_UTF8_TOO_LARGE | JSON_UTF8_TOO_LARGE_1000,
+    JSON_UTF8_CARRY | JSON_UTF8_TOO_LARGE | JSON_UTF8_TOO_LARGE_1000,
+};
+
+static const uint8_t json_utf8_byte_2_high[16] = {
+    JSON_UTF8_TOO_SHORT,
+    JSON_UTF8_TOO_SHORT,
+    JSON_UTF8_TOO_SHORT,
+    JSON_UTF8_TOO_SHORT,
+    JSON_UTF8_TOO_SHORT,
+    JSON_UTF8_TOO_SHORT,
+    JSON_UTF8_TOO_SHORT,
+    JSON_UTF8_TOO_SHORT,
+    JSON_UTF8_TOO_LONG | JSON_UTF8_OVERLONG_2 | JSON_UTF8_TWO_CONTS | JSON_UTF8_OVERLONG_3 | JSON_UTF8_TOO_LARGE_1000
+        | JSON_UTF8_OVERLONG_4,
+    JSON_UTF8_TOO_LONG | JSON_UTF8_OVERLONG_2 | JSON_UTF8_TWO_CONTS | JSON_UTF8_OVERLONG_3 | JSON_UTF8_TOO_LARGE,
+    JSON_UTF8_TOO_LONG | JSON_UTF8_OVERLONG_2 | JSON_UTF8_TWO_CONTS | JSON_UTF8_SURROGATE | JSON_UTF8_TOO_LARGE,
+    JSON_UTF8_TOO_LONG | JSON_UTF8_OVERLONG_2 | JSON_UTF8_TWO_CONTS | JSON_UTF8_SURROGATE | JSON_UTF8_TOO_LARGE,
+    JSON_UTF8_TOO_SHORT,
+    JSON_UTF8_TOO_SHORT,
+    JSON_UTF8_TOO_SHORT,
+    JSON_UTF8_TOO_SHORT,
+};
+
+__attribute__((target("ssse3"))) static inline __m128i json_utf8_check_block(
+    __m128i input,
+    __m128i previous_input
+) {
+    const __m128i nibble_mask = _mm_set1_epi8(0x0F);
+    const __m128i byte_1_high_table = _mm_loadu_si128((const __m128i*)json_utf8_byte_1_high);
+    const __m128i byte_1_low_table = _mm_loadu_si128((const __m128i*)json_utf8_byte_1_low);
+    const __m128i byte_2_high_table = _mm_loadu_si128((const __m128i*)json_utf8_byte_2_high);
+
+    __m128i prev1 = _mm_alignr_epi8(input, previous_input, 15);
+    __m128i byte_1_high = _mm_shuffle_epi8(byte_1_high_table, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble_mask));
+    __m128i byte_1_low = _mm_shuffle_epi8(byte_1_low_table, _mm_and_si128(prev1, nibble_mask));
+    __m128i byte_2_high = _mm_shuffle_epi8(byte_2_high_table, _mm_and_si128(_mm_srli_epi16(input, 4), nibble_mask));
+    __m128i special_cases = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+    __m128i prev2 = _mm_alignr_epi8(input, previous_input, 14);
+    __m128i prev3 = _mm_alignr_epi8(input, previous_input, 13);
+    __m128i is_third_byte = _mm_subs_epu8(prev2, _mm_set1_epi8((char)(0xE0 - 0x80)));
+    __m128i is_fourth_byte = _mm_subs_epu8(prev3, _mm_set1_epi8((char)(0xF0 - 0x80)));
+    __m128i must_be_continuation =
+        _mm_and_si128(_mm_or_si128(is_third_byte, is_fourth_byte), _mm_set1_epi8((char)0x80));
+
+    return _mm_xor_si128(must_be_continuation, special_cases);
+}
+
+static inline bool json_utf8_is_zero(__m128i value) {
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(value, _mm_setzero_si128())) == 0xFFFF;
+}
+
+__attribute__((target("ssse3"))) static bool json_utf8_validate_ssse3(
+    const unsigned char* buffer,
+    size_t length,
+    size_t* out_error_index
+) {
+    const __m128i incomplete_max = _mm_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, (char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1)
+    );
+
+    __m128i previous_input = _mm_setzero_si128();
+    __m128i previous_incomplete = _mm_setzero_si128();
+    size_t index = 0;
+
+    for (; length - index >= 16; index += 16) {
+        __m128i input = _mm_loadu_si128((const __m128i*)(buffer + index));
+        __m128i error;
+        if (_mm_movemask_epi8(input) == 0) {
+            // Pure ASCII: only an unfinished sequence from the previous block can be wrong.
+            error = previous_incomplete;
+        } else {
+            error = json_utf8_check_block(input, previous_input);
+        }
+
+        if (!json_utf8_is_zero(error)) {
+            break;
+        }
+
+        previous_incomplete = _mm_subs_epu8(input, incomplete_max);
+        previous_input = input;
+    }
+
+    // Every block before index is valid on its own, but a sequence starting in the last few bytes may run
+    // into the failing block. Back up to its lead byte and let the scalar validator handle the rest, which
+    // also pinpoints the offending byte.
+    size_t start = index;
+    for (size_t i = 1; i <= 3 && i <= index; i++) {
+        unsigned char previous = buffer[index - i];
+        if (previous < 0x80) {
+            break;
+        }
+        if (previous >= 0xC0) {
+            start = index - i;
+            break;
+        }
+    }
+
+    if (start < length && !json_utf8_validate_scalar(buffer + start, length - start, out_error_index)) {
+        *out_error_index += start;
+        return false;
+    }
+
+    return true;
+}
+
+static bool json_utf8_has_ssse3(void) {
+    static int supported = -1;
+    if (supported < 0) {
+        __builtin_cpu_init();
+        supported = __builtin_cpu_supports("ssse3");
+    }
+    return supported;
+}
+
+#endif
+
+bool json_utf8_validate(const char* buffer, size_t length, size_t* out_error_index) {
+#ifdef JSON_UTF8_SSSE3
+    if (length >= 16 && json_utf8_has_ssse3()) {
+        return json_utf8_validate_ssse3((const unsigned char*)buffer, length, out_error_index);
+    }
+#endif
+    return json_utf8_validate_scalar((const unsigned char*)buffer, length, out_error_index);
+}
@@ -0,0 +1,9 @@
+#ifndef JSON_UTF8_H
+#define JSON_UTF8_H
+
+#include <stddef.h>
+
+// On failure, out_error_index is the offset of the first byte of the invalid sequence.
+bool json_utf8_validate(const char* buffer, size_t length, size_t* out_error_index);
+
+#endif // JSON_UTF8_H
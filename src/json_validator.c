@@ -0,0 +1,492 @@
+#include "json_validator.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "json_internal.h"
+
+static bool json_validator_violation(JsonStream* stream, const char* keyword) {
+    json_throw_string(stream, JSON_ERROR_SCHEMA_VIOLATION, keyword);
+    return false;
+}
+
+// Pattern-lite: literals, '.', bracket classes with ranges, \d \w \s (and negations), the '*', '+' and '?'
+// quantifiers and the '^' / '$' anchors. Matching is byte-wise. Patterns using anything else (groups, alternation,
+// counted repetition) are not enforced.
+static bool json_pattern_is_supported(const char* pattern) {
+    for (const char* c = pattern; *c; c++) {
+        if (*c == '\\') {
+            if (!*++c) {
+                return false;
+            }
+        } else if (*c == '[') {
+            c++;
+            while (*c && *c != ']') {
+                if (*c == '\\' && !*++c) {
+                    return false;
+                }
+                c++;
+            }
+            if (!*c) {
+                return false;
+            }
+        } else if (strchr("()|{}", *c)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool json_pattern_match_escape(char escape, unsigned char c) {
+    switch (escape) {
+        case 'd':
+            return c >= '0' && c <= '9';
+        case 'D':
+            return !(c >= '0' && c <= '9');
+        case 'w':
+            return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+        case 'W':
+            return !((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_');
+        case 's':
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+        case 'S':
+            return !(c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v');
+        case 'n':
+            return c == '\n';
+        case 't':
+            return c == '\t';
+        default:
+            return c == (unsigned char)escape;
+    }
+}
+
+static size_t json_pattern_atom_length(const char* pattern) {
+    if (pattern[0] == '\\') {
+        return 2;
+    }
+
+    if (pattern[0] == '[') {
+        const char* c = pattern + 1;
+        while (*c != ']') {
+            c += *c == '\\' ? 2 : 1;
+        }
+        return (size_t)(c - pattern) + 1;
+    }
+
+    return 1;
+}
+
+static bool json_pattern_match_atom(const char* atom, size_t atom_length, unsigned char c) {
+    if (atom[0] == '.') {
+        return true;
+    }
+
+    if (atom[0] == '\\') {
+        return json_pattern_match_escape(atom[1], c);
+    }
+
+    if (atom[0] != '[') {
+        return c == (unsigned char)atom[0];
+    }
+
+    const char* item = atom + 1;
+    const char* end = atom + atom_length - 1;
+    bool negate = *item == '^';
+    if (negate) {
+        item++;
+    }
+
+    bool matched = false;
+    while (item < end && !matched) {
+        if (*item == '\\') {
+            matched = json_pattern_match_escape(item[1], c);
+            item += 2;
+        } else if (item + 2 < end && item[1] == '-') {
+            matched = c >= (unsigned char)item[0] && c <= (unsigned char)item[2];
+            item += 3;
+        } else {
+            matched = c == (unsigned char)*item;
+            item++;
+        }
+    }
+
+    return matched != negate;
+}
+
+static bool json_pattern_match_here(const char* pattern, const char* text, const char* end) {
+    if (pattern[0] == '\0') {
+        return true;
+    }
+
+    if (pattern[0] == '$' && pattern[1] == '\0') {
+        return text == end;
+    }
+
+    size_t atom = json_pattern_atom_length(pattern);
+    char quantifier = pattern[atom];
+    if (quantifier == '*' || quantifier == '+' || quantifier == '?') {
+        size_t minimum = quantifier == '+' ? 1 : 0;
+        size_t maximum = quantifier == '?' ? 1 : SIZE_MAX;
+
+        size_t count = 0;
+        while (count < maximum && text + count < end && json_pattern_match_atom(pattern, atom, text[count])) {
+            count++;
+        }
+
+        // Greedy with backtracking.
+        for (size_t i = count + 1; i-- > minimum;) {
+            if (json_pattern_match_here(pattern + atom + 1, text + i, end)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    if (text < end && json_pattern_match_atom(pattern, atom, *text)) {
+        return json_pattern_match_here(pattern + atom, text + 1, end);
+    }
+
+    return false;
+}
+
+static bool json_pattern_match(const char* pattern, const char* text, size_t length) {
+    if (pattern[0] == '^') {
+        return json_pattern_match_here(pattern + 1, text, text + length);
+    }
+
+    for (size_t i = 0; i <= length; i++) {
+        if (json_pattern_match_here(pattern, text + i, text + length)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Counts code points the way JSON Schema length keywords do, decoding escapes without copying.
+static size_t json_validator_string_length(const char* text, size_t length) {
+    size_t count = 0;
+    for (size_t i = 0; i < length;) {
+        unsigned char c = (unsigned char)text[i];
+        if (c != '\\') {
+            count += (c & 0xC0) != 0x80;
+            i++;
+            continue;
+        }
+
+        count++;
+        if (text[i + 1] != 'u') {
+            i += 2;
+            continue;
+        }
+
+        // A high surrogate followed by an escaped low surrogate is a single code point.
+        bool high = (text[i + 2] == 'd' || text[i + 2] == 'D') && strchr("89abAB", text[i + 3]);
+        i += 6;
+        if (high && i + 1 < length && text[i] == '\\' && text[i + 1] == 'u') {
+            i += 6;
+        }
+    }
+
+    return count;
+}
+
+static bool json_validator_check_pattern(JsonStream* stream, const JsonSchema* schema) {
+    if (!json_pattern_is_supported(schema->pattern)) {
+        return true;
+    }
+
+    const char* text;
+    size_t length;
+    if (!json_try_get_text(stream, &text, &length)) {
+        return false;
+    }
+
+    bool matched = json_pattern_match(schema->pattern, text, length);
+    return matched || json_validator_violation(stream, "pattern");
+}
+
+static bool json_validator_enum_contains(JsonStream* stream, const JsonSchema* schema) {
+    JsonType type = json_token_type(stream);
+    for (size_t i = 0; i < schema->enum_count; i++) {
+        const JsonSchemaEnumValue* value = &schema->enum_values[i];
+        if (value->type != type) {
+            continue;
+        }
+
+        if (type == JSON_TYPE_STRING) {
+            if (json_text_equals(stream, value->text, value->length)) {
+                return true;
+            }
+        } else if (value->length == stream->token_size
+                   && memcmp(value->text, stream->buffer + stream->token_start, value->length) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool json_validator_check_number(JsonStream* stream, const JsonSchema* schema) {
+    double value;
+    if (!json_try_get_double(stream, &value)) {
+        return json_validator_violation(stream, "type");
+    }
+
+    if (!(schema->types & JSON_SCHEMA_NUMBER)) {
+        // Only integers are allowed; 1.0 still counts as one.
+        const char* token = stream->buffer + stream->token_start;
+        bool plain = !memchr(token, '.', stream->token_size) && !memchr(token, 'e', stream->token_size)
+                  && !memchr(token, 'E', stream->token_size);
+        if (!plain && value != trunc(value)) {
+            return json_validator_violation(stream, "type");
+        }
+    }
+
+    if (schema->has_minimum && (value < schema->minimum || (schema->exclusive_minimum && value == schema->minimum))) {
+        return json_validator_violation(stream, schema->exclusive_minimum ? "exclusiveMinimum" : "minimum");
+    }
+
+    if (schema->has_maximum && (value > schema->maximum || (schema->exclusive_maximum && value == schema->maximum))) {
+        return json_validator_violation(stream, schema->exclusive_maximum ? "exclusiveMaximum" : "maximum");
+    }
+
+    return true;
+}
+
+static unsigned json_validator_token_types(JsonType type) {
+    switch (type) {
+        case JSON_TYPE_OBJECT_START:
+            return JSON_SCHEMA_OBJECT;
+        case JSON_TYPE_ARRAY_START:
+            return JSON_SCHEMA_ARRAY;
+        case JSON_TYPE_STRING:
+            return JSON_SCHEMA_STRING;
+        case JSON_TYPE_NUMBER:
+            return JSON_SCHEMA_NUMBER | JSON_SCHEMA_INTEGER;
+        case JSON_TYPE_BOOLEAN:
+            return JSON_SCHEMA_BOOLEAN;
+        case JSON_TYPE_NULL:
+            return JSON_SCHEMA_NULL;
+        default:
+            return 0;
+    }
+}
+
+static bool json_validator_check_value(JsonStream* stream, const JsonSchema* schema) {
+    if (!schema) {
+        return true;
+    }
+
+    JsonType type = json_token_type(stream);
+    if (!(schema->types & json_validator_token_types(type))) {
+        return json_validator_violation(stream, "type");
+    }
+
+    if (schema->enum_count > 0 && !json_validator_enum_contains(stream, schema)) {
+        return json_validator_violation(stream, "enum");
+    }
+
+    if (type == JSON_TYPE_NUMBER) {
+        return json_validator_check_number(stream, schema);
+    }
+
+    if (type == JSON_TYPE_STRING) {
+        if (schema->min_length > 0 || schema->max_length != SIZE_MAX) {
+            size_t length = json_validator_string_length(stream->buffer + stream->token_start, stream->token_size);
+            if (length < schema->min_length) {
+                return json_validator_violation(stream, "minLength");
+            }
+            if (length > schema->max_length) {
+                return json_validator_violation(stream, "maxLength");
+            }
+        }
+
+        if (schema->pattern) {
+            return json_validator_check_pattern(stream, schema);
+        }
+    }
+
+    return true;
+}
+
+static bool json_validator_push(
+    JsonValidator* validator,
+    JsonStream* stream,
+    const JsonSchema* schema,
+    bool is_object
+) {
+    if (validator->depth == validator->capacity) {
+        size_t capacity = validator->capacity ? validator->capacity * 2 : 16;
+        JsonValidatorFrame* frames = realloc(validator->frames, capacity * sizeof(JsonValidatorFrame));
+        if (!frames) {
+            json_throw(stream, JSON_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+        validator->frames = frames;
+        validator->capacity = capacity;
+    }
+
+    size_t words = schema && is_object ? (schema->property_count + 63) / 64 : 0;
+    if (validator->seen_count + words > validator->seen_capacity) {
+        size_t capacity = validator->seen_capacity ? validator->seen_capacity * 2 : 16;
+        while (capacity < validator->seen_count + words) {
+            capacity *= 2;
+        }
+        uint64_t* seen = realloc(validator->seen, capacity * sizeof(uint64_t));
+        if (!seen) {
+            json_throw(stream, JSON_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+        validator->seen = seen;
+        validator->seen_capacity = capacity;
+    }
+
+    memset(validator->seen + validator->seen_count, 0, words * sizeof(uint64_t));
+    validator->frames[validator->depth++] = (JsonValidatorFrame){
+        .schema = schema,
+        .pending = NULL,
+        .is_object = is_object,
+        .count = 0,
+        .seen_offset = validator->seen_count,
+    };
+    validator->seen_count += words;
+    return true;
+}
+
+static bool json_validator_pop(JsonValidator* validator, JsonStream* stream) {
+    JsonValidatorFrame* frame = &validator->frames[--validator->depth];
+    const JsonSchema* schema = frame->schema;
+    validator->seen_count = frame->seen_offset;
+    validator->complete = validator->depth == 0;
+
+    if (!schema) {
+        return true;
+    }
+
+    if (frame->is_object) {
+        const uint64_t* seen = validator->seen + frame->seen_offset;
+        for (size_t i = 0; i < schema->property_count; i++) {
+            if (schema->properties[i].required && !(seen[i / 64] & (1ULL << (i % 64)))) {
+                json_throw_string(stream, JSON_ERROR_REQUIRED_PROPERTY_NOT_FOUND, schema->properties[i].name);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    if (frame->count < schema->min_items) {
+        return json_validator_violation(stream, "minItems");
+    }
+
+    return true;
+}
+
+static bool json_validator_property(JsonValidator* validator, JsonStream* stream) {
+    JsonValidatorFrame* frame = &validator->frames[validator->depth - 1];
+    const JsonSchema* schema = frame->schema;
+    frame->pending = NULL;
+    if (!schema) {
+        return true;
+    }
+
+    size_t index = schema->property_count;
+    if (!json_value_is_escaped(stream)) {
+        const JsonSchemaProperty* property =
+            json_schema_find_property(schema, stream->buffer + stream->token_start, stream->token_size);
+        if (property) {
+            index = (size_t)(property - schema->properties);
+        }
+    } else {
+        for (size_t i = 0; i < schema->property_count && index == schema->property_count; i++) {
+            if (json_text_equals(stream, schema->properties[i].name, schema->properties[i].name_length)) {
+                index = i;
+            }
+        }
+    }
+
+    if (index == schema->property_count) {
+        return schema->additional_properties || json_validator_violation(stream, "additionalProperties");
+    }
+
+    validator->seen[frame->seen_offset + index / 64] |= 1ULL << (index % 64);
+    frame->pending = schema->properties[index].schema;
+    return true;
+}
+
+bool json_validator_next(JsonValidator* validator, JsonStream* stream) {
+    JsonType type = json_token_type(stream);
+    if (type == JSON_TYPE_COMMENT) {
+        return true;
+    }
+
+    if (type == JSON_TYPE_OBJECT_END || type == JSON_TYPE_ARRAY_END) {
+        return json_validator_pop(validator, stream);
+    }
+
+    if (type == JSON_TYPE_PROPERTY) {
+        return json_validator_property(validator, stream);
+    }
+
+    const JsonSchema* schema = validator->schema;
+    bool constrained = true;
+    if (validator->depth > 0) {
+        JsonValidatorFrame* frame = &validator->frames[validator->depth - 1];
+        constrained = frame->schema != NULL;
+        if (frame->is_object) {
+            schema = frame->pending;
+        } else {
+            schema = constrained ? frame->schema->items : NULL;
+            if (constrained && ++frame->count > frame->schema->max_items) {
+                return json_validator_violation(stream, "maxItems");
+            }
+        }
+    }
+
+    if (constrained && !json_validator_check_value(stream, schema)) {
+        return false;
+    }
+
+    if (type == JSON_TYPE_OBJECT_START || type == JSON_TYPE_ARRAY_START) {
+        return json_validator_push(validator, stream, constrained ? schema : NULL, type == JSON_TYPE_OBJECT_START);
+    }
+
+    validator->complete = validator->depth == 0;
+    return true;
+}
+
+void json_validator_init(JsonValidator* validator, const JsonSchema* schema) {
+    memset(validator, 0, sizeof(JsonValidator));
+    validator->schema = schema;
+}
+
+void json_validator_free(JsonValidator* validator) {
+    free(validator->frames);
+    free(validator->seen);
+    validator->frames = NULL;
+    validator->seen = NULL;
+    validator->depth = validator->capacity = 0;
+    validator->seen_count = validator->seen_capacity = 0;
+}
+
+bool json_validate(JsonStream* stream, const JsonSchema* schema) {
+    JsonValidator validator;
+    json_validator_init(&validator, schema);
+
+    bool result = false;
+    while (json_read(stream)) {
+        if (!json_validator_next(&validator, stream)) {
+            break;
+        }
+
+        if (json_validator_is_complete(&validator)) {
+            result = true;
+            break;
+        }
+    }
+
+    json_validator_free(&validator);
+    return result;
+}
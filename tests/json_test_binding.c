@@ -0,0 +1,470 @@
+#include <json_columns.h>
+#include <json_deserialize.h>
+#include <json_property_table.h>
+#include <json_stream.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "json_tests.h"
+#include "profile_schema.h"
+
+static const char* const person_keys[] = {"id", "name", "email", "age", "active", "tags"};
+
+START_TEST(json_property_table_dispatches_keys) {
+    const char* json = "{\"name\":\"a\",\"age\":3,\"nam\":0,\"names\":0,\"tags\":[],\"id\":1,\"missing\":null}";
+    const int expected[] = {1, 3, JSON_PROPERTY_NOT_FOUND, JSON_PROPERTY_NOT_FOUND, 5, 0, JSON_PROPERTY_NOT_FOUND};
+    JsonPropertyTable table;
+    ck_assert(json_property_table_init(&table, person_keys, sizeof(person_keys) / sizeof(person_keys[0])));
+
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, json_stream_options_default());
+
+    size_t count = 0;
+    while (json_read(&stream)) {
+        if (json_token_type(&stream) != JSON_TYPE_PROPERTY) {
+            continue;
+        }
+
+        ck_assert_int_eq(json_match_property(&stream, &table), expected[count++]);
+        ck_assert(json_skip(&stream));
+    }
+
+    ck_assert(expect_success(&stream));
+    ck_assert_uint_eq(count, sizeof(expected) / sizeof(expected[0]));
+    json_stream_free_resources(&stream);
+    json_property_table_free(&table);
+}
+END_TEST
+
+START_TEST(json_property_table_escaped_key) {
+    const char* json = "{\"em\\u0061il\":\"x\",\"\\u0069\":1}";
+    JsonPropertyTable table;
+    ck_assert(json_property_table_init(&table, person_keys, sizeof(person_keys) / sizeof(person_keys[0])));
+
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, json_stream_options_default());
+
+    ck_assert(json_read(&stream));
+    ck_assert(json_read(&stream));
+    ck_assert_int_eq(json_match_property(&stream, &table), 2);
+    ck_assert(json_read(&stream));
+    ck_assert(json_read(&stream));
+    ck_assert_int_eq(json_match_property(&stream, &table), JSON_PROPERTY_NOT_FOUND);
+    ck_assert(expect_success(&stream));
+
+    json_stream_free_resources(&stream);
+    json_property_table_free(&table);
+}
+END_TEST
+
+START_TEST(json_property_table_requires_string) {
+    const char* json = "[1]";
+    JsonPropertyTable table;
+    ck_assert(json_property_table_init(&table, person_keys, sizeof(person_keys) / sizeof(person_keys[0])));
+
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, json_stream_options_default());
+
+    ck_assert(json_read(&stream));
+    ck_assert(json_read(&stream));
+    ck_assert_int_eq(json_match_property(&stream, &table), JSON_PROPERTY_NOT_FOUND);
+    ck_assert(expect_error(&stream, JSON_ERROR_INVALID_OPERATION_EXPECTED_STRING_COMPARISON));
+
+    json_stream_free_resources(&stream);
+    json_property_table_free(&table);
+}
+END_TEST
+
+START_TEST(json_property_table_many_keys) {
+    static char storage[500][8];
+    const char* keys[500];
+    for (size_t i = 0; i < 500; i++) {
+        snprintf(storage[i], sizeof(storage[i]), "k%zu", i);
+        keys[i] = storage[i];
+    }
+
+    JsonPropertyTable table;
+    ck_assert(json_property_table_init(&table, keys, 500));
+    for (size_t i = 0; i < 500; i++) {
+        ck_assert_int_eq(json_property_table_find(&table, keys[i], strlen(keys[i])), (int)i);
+    }
+    ck_assert_int_eq(json_property_table_find(&table, "k500", 4), JSON_PROPERTY_NOT_FOUND);
+    ck_assert_int_eq(json_property_table_find(&table, "", 0), JSON_PROPERTY_NOT_FOUND);
+    json_property_table_free(&table);
+}
+END_TEST
+
+START_TEST(json_property_table_rejects_duplicates) {
+    const char* const keys[] = {"a", "b", "a"};
+    JsonPropertyTable table;
+    ck_assert(!json_property_table_init(&table, keys, 3));
+}
+END_TEST
+
+typedef struct Address {
+    char* city;
+    uint32_t zip;
+} Address;
+
+typedef struct Person {
+    int32_t id;
+    char* name;
+    double score;
+    bool active;
+    uint8_t level;
+    Address address;
+} Person;
+
+static const JsonFieldDescriptor address_fields[] = {
+    {"city", offsetof(Address, city), JSON_FIELD_STRING, true, NULL},
+    {"zip", offsetof(Address, zip), JSON_FIELD_U32, false, NULL},
+};
+
+static JsonObjectDescriptor address_descriptor;
+
+static const JsonFieldDescriptor person_fields[] = {
+    {"id", offsetof(Person, id), JSON_FIELD_I32, true, NULL},
+    {"name", offsetof(Person, name), JSON_FIELD_STRING, false, NULL},
+    {"score", offsetof(Person, score), JSON_FIELD_DOUBLE, false, NULL},
+    {"active", offsetof(Person, active), JSON_FIELD_BOOL, false, NULL},
+    {"level", offsetof(Person, level), JSON_FIELD_U8, false, NULL},
+    {"address", offsetof(Person, address), JSON_FIELD_OBJECT, false, &address_descriptor},
+};
+
+static JsonObjectDescriptor person_descriptor;
+
+static void person_setup(void) {
+    ck_assert(json_object_descriptor_init(&address_descriptor, address_fields, 2));
+    ck_assert(json_object_descriptor_init(&person_descriptor, person_fields, 6));
+}
+
+static void person_teardown(void) {
+    json_object_descriptor_free(&person_descriptor);
+    json_object_descriptor_free(&address_descriptor);
+}
+
+START_TEST(json_deserialize_struct) {
+    const char* json = "{\"unknown\":{\"a\":[1,2,{\"b\":3}]},\"id\":42,\"name\":\"J\\u00f6rg\",\"score\":9.5,"
+                       "\"active\":true,\"level\":7,\"address\":{\"zip\":12345,\"city\":\"Berlin\",\"x\":null}}";
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, json_stream_options_default());
+
+    Person person = {0};
+    ck_assert(json_deserialize(&stream, &person_descriptor, &person));
+    ck_assert(expect_success(&stream));
+    ck_assert_int_eq(person.id, 42);
+    ck_assert_str_eq(person.name, "J\xC3\xB6rg");
+    ck_assert_double_eq(person.score, 9.5);
+    ck_assert(person.active);
+    ck_assert_uint_eq(person.level, 7);
+    ck_assert_str_eq(person.address.city, "Berlin");
+    ck_assert_uint_eq(person.address.zip, 12345);
+    ck_assert(!json_read(&stream));
+
+    json_deserialize_free(&person_descriptor, &person);
+    ck_assert_ptr_null(person.name);
+    json_stream_free_resources(&stream);
+}
+END_TEST
+
+START_TEST(json_deserialize_missing_required) {
+    const char* json = "{\"id\":1,\"address\":{\"zip\":1}}";
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, json_stream_options_default());
+
+    Person person = {0};
+    ck_assert(!json_deserialize(&stream, &person_descriptor, &person));
+    ck_assert(expect_error(&stream, JSON_ERROR_REQUIRED_PROPERTY_NOT_FOUND));
+    ck_assert_str_eq(stream.error.string, "city");
+
+    json_deserialize_free(&person_descriptor, &person);
+    json_stream_free_resources(&stream);
+}
+END_TEST
+
+START_TEST(json_deserialize_type_mismatch) {
+    const char* json = "{\"id\":\"1\"}";
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, json_stream_options_default());
+
+    Person person = {0};
+    ck_assert(!json_deserialize(&stream, &person_descriptor, &person));
+    ck_assert(expect_error(&stream, JSON_ERROR_INVALID_OPERATION_EXPECTED_I32));
+
+    json_deserialize_free(&person_descriptor, &person);
+    json_stream_free_resources(&stream);
+}
+END_TEST
+
+START_TEST(json_deserialize_repeated_string) {
+    const char* json = "{\"name\":\"first\",\"id\":1,\"name\":\"second\"}";
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, json_stream_options_default());
+
+    Person person = {0};
+    ck_assert(json_deserialize(&stream, &person_descriptor, &person));
+    ck_assert_str_eq(person.name, "second");
+
+    json_deserialize_free(&person_descriptor, &person);
+    json_stream_free_resources(&stream);
+}
+END_TEST
+
+START_TEST(json_deserialize_repeated_object) {
+    const char* json = "{\"id\":1,\"address\":{\"city\":\"first\",\"zip\":1},\"address\":{\"city\":\"second\"}}";
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, json_stream_options_default());
+
+    Person person = {0};
+    ck_assert(json_deserialize(&stream, &person_descriptor, &person));
+    ck_assert_str_eq(person.address.city, "second");
+
+    json_deserialize_free(&person_descriptor, &person);
+    json_stream_free_resources(&stream);
+}
+END_TEST
+
+START_TEST(json_generated_reader_full_document) {
+    char* json = read_json_file("full_json_schema.json");
+    ck_assert_ptr_nonnull(json);
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, json_stream_options_default());
+
+    Profile profile = {0};
+    ck_assert(profile_read(&stream, &profile));
+    ck_assert(expect_success(&stream));
+    ck_assert_uint_eq(profile.age, 30);
+    ck_assert_str_eq(profile.first, "John");
+    ck_assert_str_eq(profile.last, "Smith");
+    ck_assert_uint_eq(profile.phoneNumbers_count, 2);
+    ck_assert_str_eq(profile.phoneNumbers[1], "425-000-1213");
+    ck_assert(profile.has_address);
+    ck_assert_str_eq(profile.address.city, "Redmond");
+    ck_assert(profile.address.has_zip);
+    ck_assert_uint_eq(profile.address.zip, 98052);
+    ck_assert_uint_eq(profile.IDs_count, 3);
+    ck_assert_int_eq(profile.IDs[1], -70);
+    ck_assert_int_eq(profile.IDs[2], 9223372036854775000LL);
+    ck_assert(profile.has_boolean);
+    ck_assert(!profile.boolean);
+    ck_assert_ptr_null(profile.null);
+    ck_assert(!profile.has_status);
+
+    profile_free(&profile);
+    json_stream_free_resources(&stream);
+    free(json);
+}
+END_TEST
+
+START_TEST(json_generated_reader_escaped_enum) {
+    const char* json = "{\"age\":1,\"first\":\"a\",\"last\":\"b\",\"st\\u0061tus\":\"b\\u0061nned\"}";
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, json_stream_options_default());
+
+    Profile profile = {0};
+    ck_assert(profile_read(&stream, &profile));
+    ck_assert(profile.has_status);
+    ck_assert_int_eq(profile.status, PROFILE_STATUS_BANNED);
+
+    profile_free(&profile);
+    json_stream_free_resources(&stream);
+}
+END_TEST
+
+START_TEST(json_generated_reader_errors) {
+    const char* jsons[] = {
+        "{\"age\":1,\"first\":\"a\",\"last\":\"b\",\"status\":\"deleted\"}",
+        "{\"age\":1,\"first\":\"a\"}",
+        "{\"age\":300,\"first\":\"a\",\"last\":\"b\"}",
+    };
+    const JsonErrorType errors[] = {
+        JSON_ERROR_SCHEMA_VIOLATION,
+        JSON_ERROR_REQUIRED_PROPERTY_NOT_FOUND,
+        JSON_ERROR_INVALID_OPERATION_EXPECTED_U8,
+    };
+
+    for (size_t i = 0; i < sizeof(jsons) / sizeof(jsons[0]); i++) {
+        JsonStream stream;
+        json_stream_init(&stream, jsons[i], strlen(jsons[i]), true, json_stream_options_default());
+
+        Profile profile = {0};
+        ck_assert(!profile_read(&stream, &profile));
+        ck_assert(expect_error(&stream, errors[i]));
+
+        profile_free(&profile);
+        json_stream_free_resources(&stream);
+    }
+}
+END_TEST
+
+static const JsonColumnDescriptor record_columns[] = {
+    {"id", JSON_COLUMN_I64},
+    {"name", JSON_COLUMN_STRING},
+    {"score", JSON_COLUMN_DOUBLE},
+    {"active", JSON_COLUMN_BOOL},
+};
+
+static void assert_string_cell(const JsonColumn* column, size_t row, const char* expected) {
+    const size_t* offsets = column->values;
+    ck_assert_uint_eq(offsets[row + 1] - offsets[row], strlen(expected));
+    ck_assert_mem_eq(column->data + offsets[row], expected, strlen(expected));
+}
+
+START_TEST(json_columns_fill_struct_of_arrays) {
+    const char* json = "[{\"id\":1,\"name\":\"a\",\"score\":0.5,\"active\":true},\n"
+                       " {\"extra\":{\"x\":[1,{}]},\"score\":-2,\"id\":2,\"name\":null},\n"
+                       " {},\n"
+                       " {\"name\":\"first\",\"id\":4,\"name\":\"J\\u00f6rg\",\"active\":false}]";
+    JsonColumns columns;
+    ck_assert(json_columns_init(&columns, record_columns, 4));
+
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, json_stream_options_default());
+    ck_assert(json_columns_read(&stream, &columns));
+    ck_assert_int_eq(json_token_type(&stream), JSON_TYPE_ARRAY_END);
+    ck_assert(!json_read(&stream));
+    ck_assert(expect_success(&stream));
+    ck_assert_uint_eq(columns.row_count, 4);
+
+    const JsonColumn* id = &columns.columns[0];
+    const int64_t* ids = id->values;
+    ck_assert(ids[0] == 1 && ids[1] == 2 && ids[2] == 0 && ids[3] == 4);
+    ck_assert(json_column_is_valid(id, 0) && json_column_is_valid(id, 1));
+    ck_assert(!json_column_is_valid(id, 2) && json_column_is_valid(id, 3));
+    ck_assert_uint_eq(id->null_count, 1);
+
+    const JsonColumn* name = &columns.columns[1];
+    assert_string_cell(name, 0, "a");
+    assert_string_cell(name, 1, "");
+    assert_string_cell(name, 2, "");
+    assert_string_cell(name, 3, "J\xC3\xB6rg");
+    ck_assert_uint_eq(name->data_length, 6);
+    ck_assert(!json_column_is_valid(name, 1) && !json_column_is_valid(name, 2));
+    ck_assert_uint_eq(name->null_count, 2);
+
+    const JsonColumn* score = &columns.columns[2];
+    const double* scores = score->values;
+    ck_assert_double_eq(scores[0], 0.5);
+    ck_assert_double_eq(scores[1], -2);
+    ck_assert_uint_eq(score->null_count, 2);
+
+    const JsonColumn* active = &columns.columns[3];
+    const bool* flags = active->values;
+    ck_assert(flags[0] && !flags[3]);
+    ck_assert(json_column_is_valid(active, 3) && !json_column_is_valid(active, 1));
+    ck_assert_uint_eq(active->null_count, 2);
+
+    json_stream_free_resources(&stream);
+    json_columns_free(&columns);
+}
+END_TEST
+
+START_TEST(json_columns_grow_and_clear) {
+    char json[16384];
+    size_t length = 0;
+    for (size_t i = 0; i < 300; i++) {
+        length += (size_t)snprintf(
+            json + length,
+            sizeof(json) - length,
+            "{\"id\":%zu,\"name\":\"row%zu\",\"active\":%s}\n",
+            i,
+            i,
+            i % 3 ? "true" : "null"
+        );
+    }
+
+    JsonColumns columns;
+    ck_assert(json_columns_init(&columns, record_columns, 4));
+    JsonStreamOptions options = json_stream_options_default();
+    options.allow_multiple_values = true;
+
+    for (size_t round = 0; round < 2; round++) {
+        JsonStream stream;
+        json_stream_init(&stream, json, length, true, options);
+        json_columns_clear(&columns);
+        while (json_columns_read_row(&stream, &columns)) {
+        }
+        ck_assert(expect_success(&stream));
+        ck_assert_uint_eq(columns.row_count, 300);
+
+        const int64_t* ids = columns.columns[0].values;
+        for (size_t i = 0; i < 300; i++) {
+            char expected[16];
+            snprintf(expected, sizeof(expected), "row%zu", i);
+            ck_assert_int_eq(ids[i], (int64_t)i);
+            assert_string_cell(&columns.columns[1], i, expected);
+            ck_assert(json_column_is_valid(&columns.columns[3], i) == (i % 3 != 0));
+        }
+        ck_assert_uint_eq(columns.columns[2].null_count, 300);
+        ck_assert_uint_eq(columns.columns[3].null_count, 100);
+        json_stream_free_resources(&stream);
+    }
+
+    json_columns_free(&columns);
+}
+END_TEST
+
+START_TEST(json_columns_type_mismatch) {
+    JsonColumns columns;
+    ck_assert(json_columns_init(&columns, record_columns, 4));
+
+    const char* json = "[{\"id\":1,\"name\":\"kept\"},{\"name\":\"dropped\",\"id\":\"2\"}]";
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, json_stream_options_default());
+    ck_assert(!json_columns_read(&stream, &columns));
+    ck_assert(expect_error(&stream, JSON_ERROR_INVALID_OPERATION_EXPECTED_I64));
+    ck_assert_uint_eq(columns.row_count, 1);
+    ck_assert_uint_eq(columns.columns[1].data_length, 4);
+    json_stream_free_resources(&stream);
+
+    json_stream_init(&stream, "[{}, 1]", 7, true, json_stream_options_default());
+    ck_assert(!json_columns_read(&stream, &columns));
+    ck_assert(expect_error(&stream, JSON_ERROR_INVALID_OPERATION_EXPECTED_OBJECT_START));
+    ck_assert_uint_eq(columns.row_count, 2);
+    json_stream_free_resources(&stream);
+
+    json_stream_init(&stream, "{}", 2, true, json_stream_options_default());
+    ck_assert(!json_columns_read(&stream, &columns));
+    ck_assert(expect_error(&stream, JSON_ERROR_INVALID_OPERATION_EXPECTED_ARRAY_START));
+    json_stream_free_resources(&stream);
+
+    json_columns_free(&columns);
+}
+END_TEST
+
+Suite* json_binding_suite(void) {
+    Suite* suite = suite_create("binding");
+
+    TCase* properties = tcase_create("properties");
+    tcase_add_test(properties, json_property_table_dispatches_keys);
+    tcase_add_test(properties, json_property_table_escaped_key);
+    tcase_add_test(properties, json_property_table_requires_string);
+    tcase_add_test(properties, json_property_table_many_keys);
+    tcase_add_test(properties, json_property_table_rejects_duplicates);
+
+    TCase* deserialize = tcase_create("deserialize");
+    tcase_add_checked_fixture(deserialize, person_setup, person_teardown);
+    tcase_add_test(deserialize, json_deserialize_struct);
+    tcase_add_test(deserialize, json_deserialize_missing_required);
+    tcase_add_test(deserialize, json_deserialize_type_mismatch);
+    tcase_add_test(deserialize, json_deserialize_repeated_string);
+    tcase_add_test(deserialize, json_deserialize_repeated_object);
+
+    TCase* generated = tcase_create("generated");
+    tcase_add_test(generated, json_generated_reader_full_document);
+    tcase_add_test(generated, json_generated_reader_escaped_enum);
+    tcase_add_test(generated, json_generated_reader_errors);
+
+    TCase* columns = tcase_create("columns");
+    tcase_add_test(columns, json_columns_fill_struct_of_arrays);
+    tcase_add_test(columns, json_columns_grow_and_clear);
+    tcase_add_test(columns, json_columns_type_mismatch);
+
+    suite_add_tcase(suite, properties);
+    suite_add_tcase(suite, deserialize);
+    suite_add_tcase(suite, generated);
+    suite_add_tcase(suite, columns);
+
+    return suite;
+}
@@ -2,10 +2,742 @@
 // Created by Chris Kramer on 2/12/25.
 //
 
+#include <json_checkpoint.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include "json_tests.h"
 
+static const char* checkpoint_json = "{\n  \"name\": \"stream\",\n"
+                                     "  \"values\": [1, -2.5e3, true, null, \"a\\u00e9\"],\n"
+                                     "  \"nested\": {\"empty\": {}, \"list\": [[], [{}]]},\n  \"last\": false\n}";
+
+static size_t record_chunked(
+    const char* json,
+    size_t length,
+    size_t window,
+    JsonStreamOptions options,
+    TokenRecord* records,
+    size_t capacity
+) {
+    size_t end = window < length ? window : length;
+    JsonStream stream;
+    json_stream_init(&stream, json, end, end == length, options);
+    size_t count = 0;
+    for (;;) {
+        count = record_tokens(&stream, records, count, capacity);
+        ck_assert(expect_success(&stream));
+        if (end == length) {
+            break;
+        }
+        size_t offset = json_total_bytes_consumed(&stream);
+        end = end + window < length ? end + window : length;
+        json_stream_continue(&stream, &stream, json + offset, end - offset, end == length);
+    }
+    ck_assert_uint_eq(json_total_bytes_consumed(&stream), length);
+    json_stream_free_resources(&stream);
+    return count;
+}
+
+static void build_long_string_json(char* json, size_t* out_length) {
+    static const char* pieces[] = {"plain text ", "\\n", "\\\"", "\\u00e9", "\\/", "more plain text"};
+    size_t length = 0;
+    memcpy(json, "[\"", 2);
+    length += 2;
+    for (size_t i = 0; i < 60; i++) {
+        size_t piece_length = strlen(pieces[i % 6]);
+        memcpy(json + length, pieces[i % 6], piece_length);
+        length += piece_length;
+    }
+    memcpy(json + length, "\", 12345]", 9);
+    length += 9;
+    json[length] = '\0';
+    *out_length = length;
+}
+
+START_TEST(json_checkpoint_resumes_after_every_token) {
+    size_t length = strlen(checkpoint_json);
+    TokenRecord expected[64];
+    JsonStream stream;
+    json_stream_init(&stream, checkpoint_json, length, true, json_stream_options_default());
+    size_t expected_count = record_tokens(&stream, expected, 0, 64);
+    ck_assert(expect_success(&stream));
+    json_stream_free_resources(&stream);
+
+    for (size_t stop = 0; stop <= expected_count; stop++) {
+        json_stream_init(&stream, checkpoint_json, length, true, json_stream_options_default());
+        for (size_t i = 0; i < stop; i++) {
+            ck_assert(json_read(&stream));
+        }
+
+        unsigned char checkpoint[128];
+        size_t size = json_stream_checkpoint(&stream, checkpoint, sizeof(checkpoint));
+        ck_assert_uint_le(size, sizeof(checkpoint));
+        ck_assert_uint_eq(json_stream_checkpoint(&stream, NULL, 0), size);
+        size_t line = stream.line_number;
+        size_t column = stream.byte_position_in_line;
+        json_stream_free_resources(&stream);
+
+        JsonStream resumed;
+        json_stream_init(&resumed, NULL, 0, false, json_stream_options_default());
+        ck_assert(json_stream_restore(&resumed, checkpoint, size));
+        size_t offset = json_total_bytes_consumed(&resumed);
+        ck_assert_uint_eq(resumed.line_number, line);
+        ck_assert_uint_eq(resumed.byte_position_in_line, column);
+        json_stream_continue(&resumed, &resumed, checkpoint_json + offset, length - offset, true);
+
+        TokenRecord actual[64];
+        size_t count = record_tokens(&resumed, actual, 0, 64);
+        ck_assert(expect_success(&resumed));
+        compare_tokens(actual, count, expected + stop, expected_count - stop, 64, false);
+        json_stream_free_resources(&resumed);
+    }
+}
+END_TEST
+
+START_TEST(json_checkpoint_deep_nesting_and_options) {
+    char json[512];
+    size_t length = 0;
+    for (size_t i = 0; i < 150; i++) {
+        json[length++] = i % 3 == 0 ? '{' : '[';
+        if (i % 3 == 0) {
+            memcpy(json + length, "\"k\":", 4);
+            length += 4;
+        }
+    }
+    for (size_t i = 150; i-- > 0;) {
+        json[length++] = i % 3 == 0 ? '}' : ']';
+    }
+
+    JsonStreamOptions options = json_stream_options_default();
+    options.max_depth = 200;
+    options.allow_trailing_commas = true;
+    options.comment_handling = JSON_COMMENT_SKIP;
+
+    JsonStream stream;
+    json_stream_init(&stream, json, length, true, options);
+    while (json_current_depth(&stream) < 100 && json_read(&stream)) {
+    }
+    ck_assert(expect_success(&stream));
+
+    unsigned char checkpoint[128];
+    size_t size = json_stream_checkpoint(&stream, checkpoint, sizeof(checkpoint));
+    ck_assert_uint_eq(size, JSON_CHECKPOINT_HEADER_SIZE + (json_z_bits_count(&stream.bits) + 7) / 8);
+    json_stream_free_resources(&stream);
+
+    JsonStream resumed;
+    json_stream_init(&resumed, NULL, 0, false, json_stream_options_default());
+    ck_assert(json_stream_restore(&resumed, checkpoint, size));
+    ck_assert_uint_eq(resumed.max_depth, 200);
+    ck_assert(resumed.allow_trailing_commas);
+    ck_assert_int_eq(resumed.comment_handling, JSON_COMMENT_SKIP);
+
+    size_t offset = json_total_bytes_consumed(&resumed);
+    json_stream_continue(&resumed, &resumed, json + offset, length - offset, true);
+    while (json_read(&resumed)) {
+    }
+    ck_assert(expect_success(&resumed));
+    ck_assert_uint_eq(json_total_bytes_consumed(&resumed), length);
+    json_stream_free_resources(&resumed);
+}
+END_TEST
+
+START_TEST(json_checkpoint_rejects_invalid) {
+    const char* json = "[{\"a\":1}]";
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, json_stream_options_default());
+    ck_assert(json_read(&stream));
+    ck_assert(json_read(&stream));
+
+    unsigned char checkpoint[128];
+    size_t size = json_stream_checkpoint(&stream, checkpoint, sizeof(checkpoint));
+    json_stream_free_resources(&stream);
+
+    JsonStream resumed;
+    json_stream_init(&resumed, NULL, 0, false, json_stream_options_default());
+    ck_assert(!json_stream_restore(&resumed, checkpoint, size - 1));
+    ck_assert(expect_error(&resumed, JSON_ERROR_INVALID_CHECKPOINT));
+
+    json_clear_error(&resumed);
+    checkpoint[0] = 'X';
+    ck_assert(!json_stream_restore(&resumed, checkpoint, size));
+    ck_assert(expect_error(&resumed, JSON_ERROR_INVALID_CHECKPOINT));
+
+    // The innermost container recorded in the bits must agree with in_object.
+    json_clear_error(&resumed);
+    checkpoint[0] = 'J';
+    checkpoint[JSON_CHECKPOINT_HEADER_SIZE] ^= 2;
+    ck_assert(!json_stream_restore(&resumed, checkpoint, size));
+    ck_assert(expect_error(&resumed, JSON_ERROR_INVALID_CHECKPOINT));
+    json_stream_free_resources(&resumed);
+}
+END_TEST
+
+// Reads the document in windows of the given size, feeding each token to the index when there is one.
+static size_t read_windows(
+    JsonStream* stream,
+    const char* json,
+    size_t offset,
+    size_t window,
+    JsonSeekIndex* index,
+    size_t* ends,
+    size_t capacity
+) {
+    size_t length = strlen(json);
+    size_t count = 0;
+    for (;;) {
+        while (json_read(stream)) {
+            ck_assert_uint_lt(count, capacity);
+            ends[count++] = json_total_bytes_consumed(stream);
+            if (index) {
+                ck_assert(json_seek_index_update(index, stream));
+            }
+        }
+        ck_assert(expect_success(stream));
+        if (stream->is_final_block) {
+            return count;
+        }
+        size_t consumed = json_total_bytes_consumed(stream);
+        size_t end = offset + window < length ? offset + window : length;
+        offset = end;
+        json_stream_continue(stream, stream, json + consumed, end - consumed, end == length);
+    }
+}
+
+START_TEST(json_seek_index_resumes_at_elements) {
+    char* json = read_json_file("400KB.json");
+    ck_assert_ptr_nonnull(json);
+    size_t length = strlen(json);
+    size_t capacity = length / 2;
+    size_t* ends = malloc(capacity * sizeof(size_t));
+    size_t* resumed_ends = malloc(capacity * sizeof(size_t));
+    ck_assert_ptr_nonnull(ends);
+    ck_assert_ptr_nonnull(resumed_ends);
+
+    JsonStream stream;
+    json_stream_init(&stream, json, 4096, false, json_stream_options_default());
+    JsonSeekIndex index;
+    ck_assert(json_seek_index_init(&index, &stream, 16384, 1));
+    size_t count = read_windows(&stream, json, 4096, 4096, &index, ends, capacity);
+    json_stream_free_resources(&stream);
+
+    ck_assert_uint_gt(index.point_count, length / 16384 / 2);
+    ck_assert_uint_eq(index.points[0].offset, 0);
+    for (size_t i = 1; i < index.point_count; i++) {
+        // Every later point follows a whole element of the top-level array.
+        size_t offset = index.points[i].offset;
+        ck_assert_uint_ge(offset, index.points[i - 1].offset + 16384);
+        ck_assert(json[offset - 1] == '}');
+    }
+
+    size_t targets[] = {0, 1, 16384, 100000, length / 2, length - 2, length + 10};
+    for (size_t t = 0; t < sizeof(targets) / sizeof(targets[0]); t++) {
+        JsonStream resumed;
+        json_stream_init(&resumed, NULL, 0, false, json_stream_options_default());
+        ck_assert(json_stream_seek(&resumed, &index, targets[t]));
+        size_t offset = json_total_bytes_consumed(&resumed);
+        ck_assert_uint_le(offset, targets[t]);
+
+        size_t skipped = 0;
+        while (skipped < count && ends[skipped] <= offset) {
+            skipped++;
+        }
+        size_t end = offset + 1000 < length ? offset + 1000 : length;
+        json_stream_continue(&resumed, &resumed, json + offset, end - offset, end == length);
+        size_t resumed_count = read_windows(&resumed, json, end, 1000, NULL, resumed_ends, capacity);
+        ck_assert_uint_eq(resumed_count, count - skipped);
+        ck_assert_mem_eq(resumed_ends, ends + skipped, resumed_count * sizeof(size_t));
+        json_stream_free_resources(&resumed);
+    }
+
+    json_seek_index_free(&index);
+    free(resumed_ends);
+    free(ends);
+    free(json);
+}
+END_TEST
+
+START_TEST(json_seek_index_respects_depth) {
+    const char* json = "[[1, 2], [3, [4, 5]], {\"a\": [6]}, 7] [8]";
+    JsonStreamOptions options = json_stream_options_default();
+    options.allow_multiple_values = true;
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, options);
+    JsonSeekIndex index;
+    ck_assert(json_seek_index_init(&index, &stream, 0, 0));
+    while (json_read(&stream)) {
+        ck_assert(json_seek_index_update(&index, &stream));
+    }
+    ck_assert(expect_success(&stream));
+    json_stream_free_resources(&stream);
+
+    // Depth 0 leaves only the ends of the top-level values.
+    ck_assert_uint_eq(index.point_count, 3);
+    ck_assert_uint_eq(index.points[1].offset, 36);
+    ck_assert_uint_eq(index.points[2].offset, strlen(json));
+
+    JsonStream resumed;
+    json_stream_init(&resumed, NULL, 0, false, options);
+    ck_assert(json_stream_seek(&resumed, &index, 38));
+    ck_assert_uint_eq(json_total_bytes_consumed(&resumed), 36);
+    json_stream_continue(&resumed, &resumed, json + 36, strlen(json) - 36, true);
+    ck_assert(json_read(&resumed));
+    ck_assert_int_eq(json_token_type(&resumed), JSON_TYPE_ARRAY_START);
+    ck_assert(json_read(&resumed));
+    ck_assert_int_eq(json_get_i32(&resumed), 8);
+    ck_assert(json_read(&resumed));
+    ck_assert(!json_read(&resumed));
+    ck_assert(expect_success(&resumed));
+    json_stream_free_resources(&resumed);
+    json_seek_index_free(&index);
+}
+END_TEST
+
+START_TEST(json_continue_matches_whole_buffer) {
+    char long_json[1024];
+    size_t long_length;
+    build_long_string_json(long_json, &long_length);
+    const char* documents[] = {checkpoint_json, long_json, "[1, 2 , \"a\" ,\n {\"b\" : [true,false ]} , null]"};
+
+    for (size_t d = 0; d < sizeof(documents) / sizeof(documents[0]); d++) {
+        size_t length = strlen(documents[d]);
+        TokenRecord expected[64];
+        JsonStream stream;
+        json_stream_init(&stream, documents[d], length, true, json_stream_options_default());
+        size_t expected_count = record_tokens(&stream, expected, 0, 64);
+        ck_assert(expect_success(&stream));
+        json_stream_free_resources(&stream);
+
+        for (size_t window = 1; window <= 17; window++) {
+            TokenRecord actual[64];
+            size_t count = record_chunked(documents[d], length, window, json_stream_options_default(), actual, 64);
+            compare_tokens(actual, count, expected, expected_count, 64, false);
+        }
+    }
+}
+END_TEST
+
+START_TEST(json_continue_resumes_string_scan) {
+    char json[1024];
+    size_t length;
+    build_long_string_json(json, &length);
+
+    JsonStream stream;
+    json_stream_init(&stream, json, 16, false, json_stream_options_default());
+    ck_assert(json_read(&stream));
+    ck_assert_int_eq(json_token_type(&stream), JSON_TYPE_ARRAY_START);
+
+    // Each continue hands the reader 16 more bytes; the scan picks up where the previous buffer ran out instead of
+    // starting again at the opening quote.
+    size_t end = 16;
+    size_t previous = 0;
+    size_t resumes = 0;
+    while (!json_read(&stream)) {
+        ck_assert(expect_success(&stream));
+        ck_assert_uint_eq(stream.partial_string_start, 1);
+        ck_assert_uint_ge(stream.partial_string_scanned, previous);
+        ck_assert_uint_le(stream.partial_string_scanned, end - 2);
+        previous = stream.partial_string_scanned;
+        resumes++;
+
+        size_t offset = json_total_bytes_consumed(&stream);
+        end = end + 16 < length ? end + 16 : length;
+        json_stream_continue(&stream, &stream, json + offset, end - offset, end == length);
+    }
+    ck_assert_uint_gt(resumes, 10);
+    ck_assert_int_eq(json_token_type(&stream), JSON_TYPE_STRING);
+    ck_assert_uint_eq(stream.partial_string_start, SIZE_MAX);
+    ck_assert_uint_eq(json_token_start(&stream) + json_token_size(&stream) + 1, json_bytes_consumed(&stream));
+    ck_assert_uint_eq(json_total_bytes_consumed(&stream), length - 8);
+    json_stream_free_resources(&stream);
+
+    // A buffer that ends inside an escape or a \u sequence must not be mistaken for an error.
+    const char* escaped = "\"\\u00e9\\\"\"";
+    size_t escaped_length = strlen(escaped);
+    for (size_t split = 1; split < escaped_length; split++) {
+        json_stream_init(&stream, escaped, split, false, json_stream_options_default());
+        ck_assert(!json_read(&stream));
+        ck_assert(expect_success(&stream));
+        size_t offset = json_total_bytes_consumed(&stream);
+        json_stream_continue(&stream, &stream, escaped + offset, escaped_length - offset, true);
+        ck_assert(json_read(&stream));
+        ck_assert_int_eq(json_token_type(&stream), JSON_TYPE_STRING);
+        ck_assert_uint_eq(json_token_size(&stream), escaped_length - 2);
+        json_stream_free_resources(&stream);
+    }
+}
+END_TEST
+
+START_TEST(json_continue_reports_unterminated_string) {
+    const char* json = "[\"never closed";
+    JsonStream stream;
+    json_stream_init(&stream, json, 8, false, json_stream_options_default());
+    ck_assert(json_read(&stream));
+    ck_assert(!json_read(&stream));
+    ck_assert(expect_success(&stream));
+    size_t offset = json_total_bytes_consumed(&stream);
+    json_stream_continue(&stream, &stream, json + offset, strlen(json) - offset, true);
+    ck_assert(!json_read(&stream));
+    ck_assert(expect_error(&stream, JSON_ERROR_END_OF_STRING_NOT_FOUND));
+    json_stream_free_resources(&stream);
+}
+END_TEST
+
+START_TEST(json_comments_match_whole_buffer) {
+    // The comments are long enough for the vectorized scans, and put "*/", CR LF and the end of the comment at
+    // varying offsets from the 16-byte blocks.
+    const char* documents[] = {
+        "// leading comment that runs well past a single sixteen byte block\r\n"
+        "[1, /* a multi-line comment\n spanning * three ** lines\n with stars **/ 2,\r"
+        "  // a comment ending with a lone carriage return\r"
+        "  \"x\" /**/, /***/ null] // trailing comment without a line feed",
+        "{\"a\": /* short */ true, // line\n\"b\": [/* x */]} /* followed by a comment that is long enough */",
+        "[\n// \xE2\x82\xAC sign and \xE2\x80\xA0 dagger are not separators\n0]",
+    };
+    JsonCommentHandling handlings[] = {JSON_COMMENT_ALLOW, JSON_COMMENT_SKIP};
+
+    for (size_t h = 0; h < 2; h++) {
+        JsonStreamOptions options = json_stream_options_default();
+        options.comment_handling = handlings[h];
+        for (size_t d = 0; d < sizeof(documents) / sizeof(documents[0]); d++) {
+            size_t length = strlen(documents[d]);
+            TokenRecord expected[64];
+            JsonStream stream;
+            json_stream_init(&stream, documents[d], length, true, options);
+            size_t expected_count = record_tokens(&stream, expected, 0, 64);
+            ck_assert(expect_success(&stream));
+            json_stream_free_resources(&stream);
+
+            TokenRecord actual[64];
+            json_stream_init(&stream, documents[d], 0, true, options);
+            ck_assert_uint_eq(record_tokens(&stream, actual, 0, 64), expected_count);
+            ck_assert(expect_success(&stream));
+            ck_assert_uint_eq(json_bytes_consumed(&stream), length);
+            json_stream_free_resources(&stream);
+
+            for (size_t window = 1; window <= 40; window++) {
+                size_t count = record_chunked(documents[d], length, window, options, actual, 64);
+                compare_tokens(actual, count, expected, expected_count, 64, true);
+            }
+        }
+    }
+}
+END_TEST
+
+START_TEST(json_comments_track_lines) {
+    JsonStreamOptions options = json_stream_options_default();
+    options.comment_handling = JSON_COMMENT_ALLOW;
+    const char* json = "/* one\ntwo\nthree */ // four\r\n[]";
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, options);
+    ck_assert(json_read(&stream));
+    ck_assert_int_eq(json_token_type(&stream), JSON_TYPE_COMMENT);
+    ck_assert_uint_eq(json_token_size(&stream), 15);
+    ck_assert_uint_eq(stream.line_number, 2);
+    ck_assert_uint_eq(stream.byte_position_in_line, 8);
+    ck_assert(json_read(&stream));
+    ck_assert_int_eq(json_token_type(&stream), JSON_TYPE_COMMENT);
+    ck_assert_uint_eq(json_token_size(&stream), 5);
+    ck_assert_uint_eq(stream.line_number, 3);
+    ck_assert_uint_eq(stream.byte_position_in_line, 0);
+    ck_assert(json_read(&stream));
+    ck_assert_int_eq(json_token_type(&stream), JSON_TYPE_ARRAY_START);
+    json_stream_free_resources(&stream);
+}
+END_TEST
+
+START_TEST(json_comments_report_errors) {
+    JsonStreamOptions options = json_stream_options_default();
+    options.comment_handling = JSON_COMMENT_SKIP;
+
+    // U+2028 must not end a single-line comment, wherever it falls relative to the scanned blocks.
+    char json[64];
+    for (size_t padding = 0; padding < 20; padding++) {
+        size_t length = 0;
+        json[length++] = '[';
+        json[length++] = '/';
+        json[length++] = '/';
+        memset(json + length, 'c', padding);
+        length += padding;
+        memcpy(json + length, "\xE2\x80\xA8 1\n1]", 7);
+        length += 7;
+        for (size_t window = 1; window <= length; window++) {
+            size_t end = window;
+            JsonStream stream;
+            json_stream_init(&stream, json, end, end == length, options);
+            for (;;) {
+                while (json_read(&stream)) {
+                }
+                if (stream.error.type != JSON_ERROR_NONE || end == length) {
+                    break;
+                }
+                size_t offset = json_total_bytes_consumed(&stream);
+                end = end + window < length ? end + window : length;
+                json_stream_continue(&stream, &stream, json + offset, end - offset, end == length);
+            }
+            ck_assert(expect_error(&stream, JSON_ERROR_UNEXPECTED_END_OF_LINE_SEPARATOR));
+            json_stream_free_resources(&stream);
+        }
+    }
+
+    const char* unterminated = "[1 /* no end, though a star * and a slash / appear on the way";
+    size_t length = strlen(unterminated);
+    for (size_t split = 1; split < length; split += 7) {
+        JsonStream stream;
+        json_stream_init(&stream, unterminated, split, false, options);
+        while (json_read(&stream)) {
+        }
+        ck_assert(expect_success(&stream));
+        size_t offset = json_total_bytes_consumed(&stream);
+        json_stream_continue(&stream, &stream, unterminated + offset, length - offset, true);
+        while (json_read(&stream)) {
+        }
+        ck_assert(expect_error(&stream, JSON_ERROR_END_OF_COMMENT_NOT_FOUND));
+        json_stream_free_resources(&stream);
+    }
+}
+END_TEST
+
+START_TEST(json_reset_reuses_allocations) {
+    char deep[1024];
+    size_t length = 0;
+    for (size_t i = 0; i < 300; i++) {
+        deep[length++] = '[';
+    }
+    for (size_t i = 0; i < 300; i++) {
+        deep[length++] = ']';
+    }
+
+    JsonStreamOptions options = json_stream_options_default();
+    options.max_depth = 400;
+    options.allow_trailing_commas = true;
+    JsonStream stream;
+    json_stream_init(&stream, deep, length, true, options);
+    while (json_read(&stream)) {
+    }
+    ck_assert(expect_success(&stream));
+    uint64_t* array = stream.bits.array;
+    size_t capacity = stream.bits.capacity;
+    ck_assert_ptr_nonnull(array);
+
+    // A failed document leaves nothing behind for the next one.
+    json_stream_reset(&stream, "[1, }", 5, true);
+    while (json_read(&stream)) {
+    }
+    ck_assert(!expect_success(&stream));
+
+    for (size_t round = 0; round < 3; round++) {
+        size_t checkpoint_length = strlen(checkpoint_json);
+        TokenRecord expected[64];
+        JsonStream fresh;
+        json_stream_init(&fresh, checkpoint_json, checkpoint_length, true, options);
+        size_t expected_count = record_tokens(&fresh, expected, 0, 64);
+        json_stream_free_resources(&fresh);
+
+        json_stream_reset(&stream, checkpoint_json, checkpoint_length, true);
+        ck_assert_uint_eq(json_current_depth(&stream), 0);
+        TokenRecord actual[64];
+        size_t count = record_tokens(&stream, actual, 0, 64);
+        ck_assert(expect_success(&stream));
+        compare_tokens(actual, count, expected, expected_count, 64, false);
+
+        json_stream_reset(&stream, deep, length, true);
+        while (json_read(&stream)) {
+        }
+        ck_assert(expect_success(&stream));
+        ck_assert_ptr_eq(stream.bits.array, array);
+        ck_assert_uint_eq(stream.bits.capacity, capacity);
+    }
+
+    ck_assert_uint_eq(stream.max_depth, 400);
+    ck_assert(stream.allow_trailing_commas);
+    json_stream_free_resources(&stream);
+}
+END_TEST
+
+static const char* array_numbers_json =
+    "[0, -0, 1, -1, 0.1, 1e23, 2.5E-3, 123456789012345678901, 9007199254740993,\n"
+    " 2.2250738585072014e-308, 1.7976931348623157e308, 4e-320, -9223372036854775808,\n"
+    " 9223372036854775807, 1E+2, 3.14159265358979323846, 100000000000000000000000]";
+
+START_TEST(json_arrays_match_element_reads) {
+    size_t length = strlen(array_numbers_json);
+    JsonStream stream;
+    json_stream_init(&stream, array_numbers_json, length, true, json_stream_options_default());
+    ck_assert(json_read(&stream));
+    double values[32];
+    size_t count;
+    ck_assert(json_read_array_double(&stream, values, 32, &count));
+    ck_assert_int_eq(json_token_type(&stream), JSON_TYPE_ARRAY_END);
+    size_t line = stream.line_number;
+    size_t position = stream.byte_position_in_line;
+    ck_assert(!json_read(&stream));
+    ck_assert(expect_success(&stream));
+    json_stream_free_resources(&stream);
+
+    json_stream_init(&stream, array_numbers_json, length, true, json_stream_options_default());
+    ck_assert(json_read(&stream));
+    size_t expected = 0;
+    while (json_read(&stream) && json_token_type(&stream) == JSON_TYPE_NUMBER) {
+        char text[64];
+        memcpy(text, array_numbers_json + json_token_start(&stream), json_token_size(&stream));
+        text[json_token_size(&stream)] = '\0';
+        double value = strtod(text, NULL);
+        ck_assert_mem_eq(&values[expected], &value, sizeof(value));
+        expected++;
+    }
+    ck_assert_uint_eq(count, expected);
+    ck_assert_uint_eq(stream.line_number, line);
+    ck_assert_uint_eq(stream.byte_position_in_line, position);
+    json_stream_free_resources(&stream);
+
+    const char* integers = "[ 7 ,-12,\t0 ,\n 9223372036854775807 ]";
+    int64_t i64_values[4];
+    json_stream_init(&stream, integers, 0, true, json_stream_options_default());
+    ck_assert(json_read(&stream));
+    ck_assert(json_read_array_i64(&stream, i64_values, 4, &count));
+    ck_assert_uint_eq(count, 4);
+    ck_assert(json_read_array_i64(&stream, i64_values, 4, &count));
+    ck_assert_uint_eq(count, 0);
+    ck_assert_int_eq(json_token_type(&stream), JSON_TYPE_ARRAY_END);
+    ck_assert(i64_values[0] == 7 && i64_values[1] == -12 && i64_values[2] == 0 && i64_values[3] == INT64_MAX);
+    json_stream_free_resources(&stream);
+
+    JsonStreamOptions options = json_stream_options_default();
+    options.comment_handling = JSON_COMMENT_ALLOW;
+    const char* booleans = "[true, /* skipped */ false,\n// also skipped\ntrue]";
+    bool bool_values[4];
+    json_stream_init(&stream, booleans, strlen(booleans), true, options);
+    ck_assert(json_read(&stream));
+    ck_assert(json_read_array_bool(&stream, bool_values, 4, &count));
+    ck_assert_uint_eq(count, 3);
+    ck_assert(bool_values[0] && !bool_values[1] && bool_values[2]);
+    ck_assert_uint_eq(stream.line_number, 2);
+    ck_assert(!json_read(&stream));
+    ck_assert(expect_success(&stream));
+    json_stream_free_resources(&stream);
+}
+END_TEST
+
+START_TEST(json_arrays_resume_partial_buffers) {
+    const char* json = "{\"values\": [10, 20, 30, 40, 50, 60, 70, 80, 90, 100, 110, 120], \"next\": true}";
+    size_t length = strlen(json);
+
+    for (size_t window = 1; window <= length; window++) {
+        size_t end = window;
+        JsonStream stream;
+        json_stream_init(&stream, json, end, end == length, json_stream_options_default());
+
+        int64_t values[15];
+        size_t seen = 0;
+        while (json_token_type(&stream) != JSON_TYPE_ARRAY_END) {
+            JsonType type = json_token_type(&stream);
+            size_t count = 0;
+            bool result = type == JSON_TYPE_NUMBER || type == JSON_TYPE_ARRAY_START
+                ? json_read_array_i64(&stream, values + seen, 3, &count)
+                : json_read(&stream);
+            seen += count;
+            if (!result) {
+                ck_assert(expect_success(&stream));
+                size_t offset = json_total_bytes_consumed(&stream);
+                end = end + window < length ? end + window : length;
+                json_stream_continue(&stream, &stream, json + offset, end - offset, end == length);
+            }
+        }
+        ck_assert_uint_eq(seen, 12);
+        for (size_t i = 0; i < 12; i++) {
+            ck_assert_int_eq(values[i], (int64_t)(i + 1) * 10);
+        }
+        json_stream_free_resources(&stream);
+    }
+}
+END_TEST
+
+START_TEST(json_arrays_reject_mismatches) {
+    const char* cases[] = {"[1, 2.5]", "[1, 99999999999999999999]", "[1, \"2\"]", "[1, [2]]", "[1, null]"};
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        JsonStream stream;
+        json_stream_init(&stream, cases[i], strlen(cases[i]), true, json_stream_options_default());
+        ck_assert(json_read(&stream));
+        int64_t values[4];
+        size_t count;
+        ck_assert(!json_read_array_i64(&stream, values, 4, &count));
+        ck_assert_uint_eq(count, 1);
+        ck_assert_int_eq(values[0], 1);
+        ck_assert(expect_error(&stream, JSON_ERROR_INVALID_OPERATION_EXPECTED_I64));
+        ck_assert_int_eq(json_token_type(&stream), JSON_TYPE_NUMBER);
+        ck_assert_uint_eq(json_bytes_consumed(&stream), 2);
+        json_stream_free_resources(&stream);
+    }
+
+    JsonStream stream;
+    json_stream_init(&stream, "[true, 0]", 9, true, json_stream_options_default());
+    ck_assert(json_read(&stream));
+    bool values[4];
+    size_t count;
+    ck_assert(!json_read_array_bool(&stream, values, 4, &count));
+    ck_assert_uint_eq(count, 1);
+    ck_assert(expect_error(&stream, JSON_ERROR_INVALID_OPERATION_EXPECTED_BOOL));
+    json_stream_free_resources(&stream);
+
+    // A number that overflows a double is not read as infinity.
+    double doubles[4];
+    const char* overflows[] = {"[1, 1e400]", "[1, -1e400]", "[1, 18e307]"};
+    for (size_t i = 0; i < sizeof(overflows) / sizeof(overflows[0]); i++) {
+        json_stream_init(&stream, overflows[i], strlen(overflows[i]), true, json_stream_options_default());
+        ck_assert(json_read(&stream));
+        ck_assert(!json_read_array_double(&stream, doubles, 4, &count));
+        ck_assert_uint_eq(count, 1);
+        ck_assert_double_eq(doubles[0], 1);
+        ck_assert(expect_error(&stream, JSON_ERROR_INVALID_OPERATION_EXPECTED_DOUBLE));
+        ck_assert_uint_eq(json_bytes_consumed(&stream), 2);
+        json_stream_free_resources(&stream);
+    }
+
+    // Malformed numbers are left to the tokenizer, which reports them as usual.
+    json_stream_init(&stream, "[1, 01]", 7, true, json_stream_options_default());
+    ck_assert(json_read(&stream));
+    ck_assert(!json_read_array_double(&stream, doubles, 4, &count));
+    ck_assert_uint_eq(count, 1);
+    ck_assert(!expect_success(&stream));
+    ck_assert(!expect_error(&stream, JSON_ERROR_INVALID_OPERATION_EXPECTED_DOUBLE));
+    json_stream_free_resources(&stream);
+}
+END_TEST
+
 Suite* json_buffered_suite(void) {
     Suite* suite = suite_create("buffered");
 
+    TCase* checkpoint = tcase_create("checkpoint");
+    tcase_add_test(checkpoint, json_checkpoint_resumes_after_every_token);
+    tcase_add_test(checkpoint, json_checkpoint_deep_nesting_and_options);
+    tcase_add_test(checkpoint, json_checkpoint_rejects_invalid);
+    tcase_add_test(checkpoint, json_seek_index_resumes_at_elements);
+    tcase_add_test(checkpoint, json_seek_index_respects_depth);
+
+    TCase* tc_continue = tcase_create("continue");
+    tcase_add_test(tc_continue, json_continue_matches_whole_buffer);
+    tcase_add_test(tc_continue, json_continue_resumes_string_scan);
+    tcase_add_test(tc_continue, json_continue_reports_unterminated_string);
+
+    TCase* comments = tcase_create("comments");
+    tcase_add_test(comments, json_comments_match_whole_buffer);
+    tcase_add_test(comments, json_comments_track_lines);
+    tcase_add_test(comments, json_comments_report_errors);
+
+    TCase* reset = tcase_create("reset");
+    tcase_add_test(reset, json_reset_reuses_allocations);
+
+    TCase* arrays = tcase_create("arrays");
+    tcase_add_test(arrays, json_arrays_match_element_reads);
+    tcase_add_test(arrays, json_arrays_resume_partial_buffers);
+    tcase_add_test(arrays, json_arrays_reject_mismatches);
+
+    suite_add_tcase(suite, checkpoint);
+    suite_add_tcase(suite, tc_continue);
+    suite_add_tcase(suite, comments);
+    suite_add_tcase(suite, reset);
+    suite_add_tcase(suite, arrays);
+
     return suite;
 }
@@ -0,0 +1,223 @@
+#include <json_decompress.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(JSON_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+
+#if defined(JSON_HAVE_ZSTD)
+#include <zstd.h>
+#endif
+
+#include "json_tests.h"
+
+enum { token_capacity = 4096 };
+
+static size_t tokenize_buffer(const char* json, size_t length, TokenRecord* tokens) {
+    JsonStream stream;
+    json_stream_init(&stream, json, length, true, json_stream_options_default());
+    size_t count = record_tokens(&stream, tokens, 0, token_capacity);
+    ck_assert(expect_success(&stream));
+    json_stream_free_resources(&stream);
+    return count;
+}
+
+static void compare_decompressed(const char* path, const char* json, size_t window_size, size_t thread_threshold) {
+    static TokenRecord expected[token_capacity];
+    static TokenRecord actual[token_capacity];
+    size_t expected_count = tokenize_buffer(json, strlen(json), expected);
+
+    JsonDecompressor decompressor;
+    ck_assert(json_decompressor_init(&decompressor, window_size, thread_threshold));
+    ck_assert(json_decompressor_open(&decompressor, path));
+    ck_assert(decompressor.threaded == (thread_threshold == 0));
+
+    JsonStream stream;
+    json_stream_init(&stream, NULL, 0, false, json_stream_options_default());
+    size_t count = 0;
+    while (json_decompressor_next(&decompressor, &stream)) {
+        ck_assert_uint_le(decompressor.blocks[decompressor.current].length, window_size);
+        count = record_tokens(&stream, actual, count, token_capacity);
+    }
+    ck_assert(expect_success(&stream));
+    ck_assert_uint_eq(json_total_bytes_consumed(&stream), strlen(json));
+    compare_tokens(actual, count, expected, expected_count, token_capacity, false);
+    json_stream_free_resources(&stream);
+    json_decompressor_free(&decompressor);
+}
+
+START_TEST(json_decompress_passes_plain_files_through) {
+    char* json = read_json_file("400KB.json");
+    ck_assert_ptr_nonnull(json);
+    compare_decompressed("400KB.json", json, 4096, SIZE_MAX);
+    compare_decompressed("400KB.json", json, 4096, 0);
+    free(json);
+}
+END_TEST
+
+#if defined(JSON_HAVE_ZLIB)
+static void write_gzip_member(FILE* file, const char* data, size_t length) {
+    z_stream z;
+    memset(&z, 0, sizeof(z));
+    ck_assert_int_eq(deflateInit2(&z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY), Z_OK);
+    unsigned char out[16384];
+    z.next_in = (unsigned char*)data;
+    z.avail_in = (uInt)length;
+    int result;
+    do {
+        z.next_out = out;
+        z.avail_out = sizeof(out);
+        result = deflate(&z, Z_FINISH);
+        fwrite(out, 1, sizeof(out) - z.avail_out, file);
+    } while (result == Z_OK);
+    ck_assert_int_eq(result, Z_STREAM_END);
+    deflateEnd(&z);
+}
+
+START_TEST(json_decompress_gzip) {
+    char* json = read_json_file("400KB.json");
+    ck_assert_ptr_nonnull(json);
+    const char* path = "decompress_400KB.json.gz";
+    FILE* file = fopen(path, "wb");
+    ck_assert_ptr_nonnull(file);
+    write_gzip_member(file, json, strlen(json));
+    fclose(file);
+
+    compare_decompressed(path, json, 61, SIZE_MAX);
+    compare_decompressed(path, json, 4096, SIZE_MAX);
+    compare_decompressed(path, json, 4096, 0);
+    compare_decompressed(path, json, 65536, 0);
+    remove(path);
+    free(json);
+}
+END_TEST
+
+START_TEST(json_decompress_gzip_members_and_truncation) {
+    const char* path = "decompress_members.json.gz";
+    FILE* file = fopen(path, "wb");
+    ck_assert_ptr_nonnull(file);
+    write_gzip_member(file, "[\"first\", 1", 11);
+    write_gzip_member(file, ", 2, \"second\"]", 14);
+    fclose(file);
+    compare_decompressed(path, "[\"first\", 1, 2, \"second\"]", 4, SIZE_MAX);
+    compare_decompressed(path, "[\"first\", 1, 2, \"second\"]", 4, 0);
+
+    // Cut the file in the middle of the compressed data.
+    file = fopen(path, "wb");
+    ck_assert_ptr_nonnull(file);
+    char json[2048];
+    size_t length = 0;
+    json[length++] = '[';
+    for (size_t i = 0; i < 300; i++) {
+        length += (size_t)snprintf(json + length, sizeof(json) - length, "%s%zu", i ? "," : "", i);
+    }
+    json[length++] = ']';
+    write_gzip_member(file, json, length);
+    fclose(file);
+    unsigned char compressed[2048];
+    file = fopen(path, "rb");
+    ck_assert_ptr_nonnull(file);
+    size_t size = fread(compressed, 1, sizeof(compressed), file);
+    fclose(file);
+    file = fopen(path, "wb");
+    ck_assert_ptr_nonnull(file);
+    fwrite(compressed, 1, size / 2, file);
+    fclose(file);
+
+    for (size_t threaded = 0; threaded < 2; threaded++) {
+        JsonDecompressor decompressor;
+        ck_assert(json_decompressor_init(&decompressor, 64, threaded ? 0 : SIZE_MAX));
+        ck_assert(json_decompressor_open(&decompressor, path));
+        JsonStream stream;
+        json_stream_init(&stream, NULL, 0, false, json_stream_options_default());
+        while (json_decompressor_next(&decompressor, &stream)) {
+            while (json_read(&stream)) {
+            }
+        }
+        ck_assert(expect_error(&stream, JSON_ERROR_READ_FAILED));
+        json_stream_free_resources(&stream);
+        json_decompressor_free(&decompressor);
+    }
+    remove(path);
+}
+END_TEST
+#endif
+
+#if defined(JSON_HAVE_ZSTD)
+static void write_zstd_frame(FILE* file, const char* data, size_t length) {
+    size_t capacity = ZSTD_compressBound(length);
+    void* compressed = malloc(capacity);
+    ck_assert_ptr_nonnull(compressed);
+    size_t size = ZSTD_compress(compressed, capacity, data, length, 3);
+    ck_assert(!ZSTD_isError(size));
+    fwrite(compressed, 1, size, file);
+    free(compressed);
+}
+
+START_TEST(json_decompress_zstd) {
+    char* json = read_json_file("400KB.json");
+    ck_assert_ptr_nonnull(json);
+    const char* path = "decompress_400KB.json.zst";
+    FILE* file = fopen(path, "wb");
+    ck_assert_ptr_nonnull(file);
+    write_zstd_frame(file, json, strlen(json));
+    fclose(file);
+
+    compare_decompressed(path, json, 61, SIZE_MAX);
+    compare_decompressed(path, json, 4096, SIZE_MAX);
+    compare_decompressed(path, json, 4096, 0);
+    compare_decompressed(path, json, 65536, 0);
+
+    // Concatenated frames decompress to the concatenated data.
+    file = fopen(path, "wb");
+    ck_assert_ptr_nonnull(file);
+    write_zstd_frame(file, "[\"first\", 1", 11);
+    write_zstd_frame(file, ", 2, \"second\"]", 14);
+    fclose(file);
+    compare_decompressed(path, "[\"first\", 1, 2, \"second\"]", 4, SIZE_MAX);
+    compare_decompressed(path, "[\"first\", 1, 2, \"second\"]", 4, 0);
+
+    remove(path);
+    free(json);
+}
+END_TEST
+#endif
+
+START_TEST(json_decompress_stops_early) {
+    // Closing with windows still being produced must stop the thread.
+    JsonDecompressor decompressor;
+    ck_assert(json_decompressor_init(&decompressor, 256, 0));
+    ck_assert(json_decompressor_open(&decompressor, "400KB.json"));
+    JsonStream stream;
+    json_stream_init(&stream, NULL, 0, false, json_stream_options_default());
+    ck_assert(json_decompressor_next(&decompressor, &stream));
+    ck_assert(json_read(&stream));
+    json_decompressor_close(&decompressor);
+    ck_assert(!json_decompressor_next(&decompressor, &stream));
+    json_stream_free_resources(&stream);
+    json_decompressor_free(&decompressor);
+
+    ck_assert(!json_decompressor_open(&decompressor, "does_not_exist.json.gz"));
+}
+END_TEST
+
+Suite* json_decompress_suite(void) {
+    Suite* suite = suite_create("decompress");
+
+    TCase* windows = tcase_create("windows");
+    tcase_add_test(windows, json_decompress_passes_plain_files_through);
+#if defined(JSON_HAVE_ZLIB)
+    tcase_add_test(windows, json_decompress_gzip);
+    tcase_add_test(windows, json_decompress_gzip_members_and_truncation);
+#endif
+#if defined(JSON_HAVE_ZSTD)
+    tcase_add_test(windows, json_decompress_zstd);
+#endif
+    tcase_add_test(windows, json_decompress_stops_early);
+
+    suite_add_tcase(suite, windows);
+
+    return suite;
+}
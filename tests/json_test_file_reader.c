@@ -0,0 +1,124 @@
+#include <json_file_reader.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "json_tests.h"
+
+static size_t read_whole_file(const char* path, TokenRecord* tokens, size_t capacity) {
+    char* json = read_json_file(path);
+    ck_assert_ptr_nonnull(json);
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, json_stream_options_default());
+    size_t count = record_tokens(&stream, tokens, 0, capacity);
+    ck_assert(expect_success(&stream));
+    json_stream_free_resources(&stream);
+    free(json);
+    return count;
+}
+
+static size_t read_in_chunks(JsonFileReader* reader, const char* path, TokenRecord* tokens, size_t capacity) {
+    ck_assert(json_file_reader_open(reader, path));
+    JsonStream stream;
+    json_stream_init(&stream, NULL, 0, false, json_stream_options_default());
+    size_t count = 0;
+    while (json_file_reader_next(reader, &stream)) {
+        count = record_tokens(&stream, tokens, count, capacity);
+    }
+    ck_assert(expect_success(&stream));
+    json_file_reader_close(reader);
+    json_stream_free_resources(&stream);
+    return count;
+}
+
+static void compare_file(const char* path, size_t chunk_size, size_t depth, bool use_io_uring) {
+    enum { capacity = 4096 };
+    static TokenRecord expected[capacity];
+    static TokenRecord actual[capacity];
+    size_t expected_count = read_whole_file(path, expected, capacity);
+
+    JsonFileReader reader;
+    ck_assert(json_file_reader_init(&reader, chunk_size, depth, use_io_uring));
+    size_t count = read_in_chunks(&reader, path, actual, capacity);
+    compare_tokens(actual, count, expected, expected_count, capacity, false);
+    json_file_reader_free(&reader);
+}
+
+START_TEST(json_file_reader_matches_whole_buffer) {
+    const char* files[] = {"basic_json.json", "lots_of_strings.json", "lots_of_numbers.json", "400KB.json"};
+    const size_t chunk_sizes[] = {61, 4096, 65536};
+    for (size_t f = 0; f < sizeof(files) / sizeof(files[0]); f++) {
+        for (size_t c = 0; c < sizeof(chunk_sizes) / sizeof(chunk_sizes[0]); c++) {
+            compare_file(files[f], chunk_sizes[c], 2, true);
+            compare_file(files[f], chunk_sizes[c], 3, true);
+            compare_file(files[f], chunk_sizes[c], 3, false);
+        }
+    }
+}
+END_TEST
+
+START_TEST(json_file_reader_token_longer_than_chunk) {
+    const char* path = "file_reader_long_token.json";
+    FILE* file = fopen(path, "w");
+    ck_assert_ptr_nonnull(file);
+    fputs("{\"long\": \"", file);
+    for (size_t i = 0; i < 5000; i++) {
+        fputc('a' + (int)(i % 26), file);
+    }
+    fputs("\", \"after\": [1, 2, 3]}", file);
+    fclose(file);
+
+    compare_file(path, 16, 2, true);
+    compare_file(path, 16, 3, false);
+    remove(path);
+}
+END_TEST
+
+START_TEST(json_file_reader_reuse_and_errors) {
+    JsonFileReader reader;
+    ck_assert(json_file_reader_init(&reader, 128, 3, true));
+    TokenRecord tokens[512];
+    ck_assert_uint_gt(read_in_chunks(&reader, "basic_json.json", tokens, 512), 0);
+    ck_assert_uint_gt(read_in_chunks(&reader, "hello_world.json", tokens, 512), 0);
+
+    ck_assert(!json_file_reader_open(&reader, "does_not_exist.json"));
+
+    const char* path = "file_reader_empty.json";
+    FILE* file = fopen(path, "w");
+    ck_assert_ptr_nonnull(file);
+    fclose(file);
+    ck_assert(json_file_reader_open(&reader, path));
+    JsonStream stream;
+    json_stream_init(&stream, NULL, 0, false, json_stream_options_default());
+    ck_assert(json_file_reader_next(&reader, &stream));
+    ck_assert(!json_read(&stream));
+    ck_assert(expect_error(&stream, JSON_ERROR_EXPECTED_JSON_TOKENS));
+    ck_assert(!json_file_reader_next(&reader, &stream));
+    json_stream_free_resources(&stream);
+    json_file_reader_close(&reader);
+    remove(path);
+
+    // Stopping early leaves reads in flight; closing waits for them.
+    ck_assert(json_file_reader_open(&reader, "400KB.json"));
+    json_stream_init(&stream, NULL, 0, false, json_stream_options_default());
+    ck_assert(json_file_reader_next(&reader, &stream));
+    ck_assert(json_read(&stream));
+    json_stream_free_resources(&stream);
+    json_file_reader_free(&reader);
+
+    ck_assert(!json_file_reader_init(&reader, 128, 1, false));
+    json_file_reader_free(&reader);
+}
+END_TEST
+
+Suite* json_file_reader_suite(void) {
+    Suite* suite = suite_create("file_reader");
+
+    TCase* chunks = tcase_create("chunks");
+    tcase_add_test(chunks, json_file_reader_matches_whole_buffer);
+    tcase_add_test(chunks, json_file_reader_token_longer_than_chunk);
+    tcase_add_test(chunks, json_file_reader_reuse_and_errors);
+
+    suite_add_tcase(suite, chunks);
+
+    return suite;
+}
@@ -0,0 +1,365 @@
+#include <json_path.h>
+#include <json_stream.h>
+#include <string.h>
+
+#include "json_tests.h"
+
+typedef struct PathMatches {
+    char text[256];
+    size_t length;
+    size_t limit;
+    bool consume;
+} PathMatches;
+
+static bool collect_match(JsonStream* stream, void* context) {
+    PathMatches* matches = context;
+    const char* token;
+    size_t size;
+    json_token(stream, &token, &size);
+
+    if (matches->length > 0) {
+        matches->text[matches->length++] = ',';
+    }
+    memcpy(matches->text + matches->length, token, size);
+    matches->length += size;
+    matches->text[matches->length] = '\0';
+
+    if (matches->consume && !json_skip(stream)) {
+        return false;
+    }
+
+    return matches->limit == 0 || --matches->limit > 0;
+}
+
+static bool extract(const char* json, const JsonPath* path, PathMatches* matches, size_t chunk_size) {
+    size_t length = strlen(json);
+    size_t end = chunk_size && chunk_size < length ? chunk_size : length;
+    JsonStream stream;
+    json_stream_init(&stream, json, end, end == length, json_stream_options_default());
+
+    JsonPathMatcher matcher;
+    json_path_matcher_init(&matcher, path, collect_match, matches);
+
+    size_t offset = 0;
+    bool result;
+    while ((result = json_path_extract(&matcher, &stream)) && !json_is_final_block(&stream)) {
+        offset += json_bytes_consumed(&stream);
+        end = end + chunk_size < length ? end + chunk_size : length;
+        json_stream_continue(&stream, &stream, json + offset, end - offset, end == length);
+    }
+
+    json_path_matcher_free(&matcher);
+    json_stream_free_resources(&stream);
+    return result;
+}
+
+static const char* items_json =
+    "{\"meta\":{\"id\":-1,\"items\":[{\"id\":-2}]},\"items\":[{\"id\":1,\"x\":{\"id\":9}},"
+    "{\"name\":\"n\",\"id\":\"two\"},{\"name\":\"none\"},{\"id\":[3,{\"id\":4}]},7,{\"\\u0069d\":true}],\"id\":0}";
+
+START_TEST(json_path_compile_steps) {
+    JsonPath path;
+    ck_assert(json_path_compile("$.items[*].id['a.b'][12]", &path));
+    ck_assert_uint_eq(path.step_count, 5);
+    ck_assert_str_eq(path.steps[0].name, "items");
+    ck_assert(path.steps[1].wildcard);
+    ck_assert_str_eq(path.steps[2].name, "id");
+    ck_assert_str_eq(path.steps[3].name, "a.b");
+    ck_assert_ptr_null(path.steps[4].name);
+    ck_assert_uint_eq(path.steps[4].index, 12);
+    json_path_free(&path);
+
+    ck_assert(json_path_compile("$", &path));
+    ck_assert_uint_eq(path.step_count, 0);
+    json_path_free(&path);
+
+    ck_assert(json_path_compile("$[\"say \\\"hi\\\"\"].*", &path));
+    ck_assert_uint_eq(path.step_count, 2);
+    ck_assert_str_eq(path.steps[0].name, "say \"hi\"");
+    ck_assert(path.steps[1].wildcard);
+    json_path_free(&path);
+
+    const char* invalid[] = {"items", "$..id", "$.", "$[", "$[x]", "$['open]", "$[1", "$[99999999999999999999]"};
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        ck_assert(!json_path_compile(invalid[i], &path));
+        ck_assert_ptr_null(path.steps);
+    }
+}
+END_TEST
+
+START_TEST(json_pointer_compile_steps) {
+    JsonPath path;
+    ck_assert(json_pointer_compile("/a~1b/0/~01/01/-/", &path));
+    ck_assert_uint_eq(path.step_count, 6);
+    ck_assert_str_eq(path.steps[0].name, "a/b");
+    ck_assert_uint_eq(path.steps[0].index, JSON_PATH_NO_INDEX);
+    ck_assert_str_eq(path.steps[1].name, "0");
+    ck_assert_uint_eq(path.steps[1].index, 0);
+    ck_assert_str_eq(path.steps[2].name, "~1");
+    ck_assert_uint_eq(path.steps[3].index, JSON_PATH_NO_INDEX);
+    ck_assert_uint_eq(path.steps[4].index, JSON_PATH_NO_INDEX);
+    ck_assert_uint_eq(path.steps[5].name_length, 0);
+    json_path_free(&path);
+
+    ck_assert(json_pointer_compile("", &path));
+    ck_assert_uint_eq(path.step_count, 0);
+    json_path_free(&path);
+
+    ck_assert(!json_pointer_compile("a", &path));
+    ck_assert(!json_pointer_compile("/~2", &path));
+    ck_assert(!json_pointer_compile("/a~", &path));
+}
+END_TEST
+
+START_TEST(json_path_extract_wildcard) {
+    JsonPath path;
+    ck_assert(json_path_compile("$.items[*].id", &path));
+
+    PathMatches matches = {0};
+    ck_assert(extract(items_json, &path, &matches, 0));
+    ck_assert_str_eq(matches.text, "1,two,[,true");
+    json_path_free(&path);
+}
+END_TEST
+
+START_TEST(json_path_extract_index_and_root) {
+    JsonPath path;
+    ck_assert(json_path_compile("$.items[3].id[1]", &path));
+    PathMatches matches = {0};
+    ck_assert(extract(items_json, &path, &matches, 0));
+    ck_assert_str_eq(matches.text, "{");
+    json_path_free(&path);
+
+    ck_assert(json_path_compile("$", &path));
+    matches = (PathMatches){0};
+    ck_assert(extract("[1,2]", &path, &matches, 0));
+    ck_assert_str_eq(matches.text, "[");
+    json_path_free(&path);
+}
+END_TEST
+
+START_TEST(json_pointer_extract) {
+    JsonPath path;
+    ck_assert(json_pointer_compile("/items/1/id", &path));
+    PathMatches matches = {0};
+    ck_assert(extract(items_json, &path, &matches, 0));
+    ck_assert_str_eq(matches.text, "two");
+    json_path_free(&path);
+
+    // A numeric reference token names an array element or an object member, whichever is found.
+    ck_assert(json_pointer_compile("/0/0", &path));
+    matches = (PathMatches){0};
+    ck_assert(extract("[{\"0\":\"member\",\"1\":0},[\"element\"]]", &path, &matches, 0));
+    ck_assert_str_eq(matches.text, "member");
+    json_path_free(&path);
+}
+END_TEST
+
+START_TEST(json_path_extract_across_chunks) {
+    JsonPath path;
+    ck_assert(json_path_compile("$.items[*].id", &path));
+
+    for (size_t chunk_size = 1; chunk_size < 24; chunk_size++) {
+        PathMatches matches = {0};
+        ck_assert(extract(items_json, &path, &matches, chunk_size));
+        ck_assert_str_eq(matches.text, "1,two,[,true");
+    }
+
+    json_path_free(&path);
+}
+END_TEST
+
+START_TEST(json_path_callback_consumes_and_stops) {
+    JsonPath path;
+    ck_assert(json_path_compile("$.items[*]", &path));
+
+    PathMatches matches = {.consume = true};
+    ck_assert(extract(items_json, &path, &matches, 0));
+    ck_assert_str_eq(matches.text, "{,{,{,{,7,{");
+
+    matches = (PathMatches){.limit = 2};
+    ck_assert(!extract(items_json, &path, &matches, 0));
+    ck_assert_str_eq(matches.text, "{,{");
+    json_path_free(&path);
+}
+END_TEST
+
+START_TEST(json_path_extract_reports_stream_errors) {
+    JsonPath path;
+    ck_assert(json_path_compile("$.a", &path));
+
+    JsonStream stream;
+    const char* json = "{\"b\":[1,2,}],\"a\":1}";
+    json_stream_init(&stream, json, strlen(json), true, json_stream_options_default());
+
+    PathMatches matches = {0};
+    JsonPathMatcher matcher;
+    json_path_matcher_init(&matcher, &path, collect_match, &matches);
+    ck_assert(!json_path_extract(&matcher, &stream));
+    ck_assert(!expect_success(&stream));
+    ck_assert_uint_eq(matcher.match_count, 0);
+
+    json_path_matcher_free(&matcher);
+    json_stream_free_resources(&stream);
+    json_path_free(&path);
+}
+END_TEST
+
+static bool collect_query_match(JsonStream* stream, size_t query, void* context) {
+    PathMatches* matches = context;
+    return collect_match(stream, &matches[query]);
+}
+
+static const char* const set_queries[] = {
+    "$.items[*].id",
+    "$.items[0].x.id",
+    "$.meta.id",
+    "/items/1/name",
+    "$.items[1]['name']",
+    "$.*.id",
+    "$.id",
+    "$.missing",
+    "$.items",
+    "/items/0",
+    "$.items[0]",
+    "$.meta.id",
+};
+
+static const char* const set_expected[] = {"1,two,[,true", "9", "-1", "n", "n", "-1", "0", "", "[", "{", "{", "-1"};
+
+#define SET_QUERY_COUNT (sizeof(set_queries) / sizeof(set_queries[0]))
+
+static void extract_set(const JsonPathSet* set, PathMatches* matches, size_t chunk_size) {
+    size_t length = strlen(items_json);
+    size_t end = chunk_size && chunk_size < length ? chunk_size : length;
+    JsonStream stream;
+    json_stream_init(&stream, items_json, end, end == length, json_stream_options_default());
+
+    JsonPathSetMatcher matcher;
+    json_path_set_matcher_init(&matcher, set, collect_query_match, matches);
+
+    size_t offset = 0;
+    while (json_path_set_extract(&matcher, &stream) && !json_is_final_block(&stream)) {
+        offset += json_bytes_consumed(&stream);
+        end = end + chunk_size < length ? end + chunk_size : length;
+        json_stream_continue(&stream, &stream, items_json + offset, end - offset, end == length);
+    }
+
+    ck_assert(expect_success(&stream));
+    json_path_set_matcher_free(&matcher);
+    json_stream_free_resources(&stream);
+}
+
+START_TEST(json_path_set_single_pass) {
+    JsonPath paths[SET_QUERY_COUNT];
+    for (size_t i = 0; i < SET_QUERY_COUNT; i++) {
+        bool pointer = set_queries[i][0] == '/';
+        ck_assert(
+            pointer ? json_pointer_compile(set_queries[i], &paths[i]) : json_path_compile(set_queries[i], &paths[i])
+        );
+    }
+
+    JsonPathSet set;
+    ck_assert(json_path_set_init(&set, paths, SET_QUERY_COUNT));
+
+    for (size_t chunk_size = 0; chunk_size < 24; chunk_size++) {
+        PathMatches matches[SET_QUERY_COUNT] = {0};
+        extract_set(&set, matches, chunk_size);
+        for (size_t i = 0; i < SET_QUERY_COUNT; i++) {
+            ck_assert_str_eq(matches[i].text, set_expected[i]);
+        }
+    }
+
+    json_path_set_free(&set);
+    for (size_t i = 0; i < SET_QUERY_COUNT; i++) {
+        json_path_free(&paths[i]);
+    }
+}
+END_TEST
+
+START_TEST(json_path_set_shares_prefixes) {
+    JsonPath paths[3];
+    ck_assert(json_path_compile("$.a.b", &paths[0]));
+    ck_assert(json_path_compile("$.a.c", &paths[1]));
+    ck_assert(json_path_compile("$.a[*]", &paths[2]));
+
+    JsonPathSet set;
+    ck_assert(json_path_set_init(&set, paths, 3));
+    ck_assert_uint_eq(set.node_count, 5);
+    ck_assert_uint_eq(set.nodes[0].child_count, 1);
+    ck_assert_uint_eq(set.nodes[1].child_count, 3);
+    ck_assert_uint_eq(set.nodes[1].name_count, 2);
+    ck_assert_uint_ne(set.nodes[1].wildcard, JSON_PATH_NO_NODE);
+
+    json_path_set_free(&set);
+    for (size_t i = 0; i < 3; i++) {
+        json_path_free(&paths[i]);
+    }
+}
+END_TEST
+
+START_TEST(json_path_set_consumed_value_skips_later_queries) {
+    const char* queries[] = {"$.items", "$.*", "$.items[0].id"};
+    JsonPath paths[3];
+    for (size_t i = 0; i < 3; i++) {
+        ck_assert(json_path_compile(queries[i], &paths[i]));
+    }
+
+    JsonPathSet set;
+    ck_assert(json_path_set_init(&set, paths, 3));
+
+    // Both of the first two queries match the items array, and query order decides which sees it first. A consumed
+    // array is not descended into; consumer 2 only matches a number, which leaves the array to the third query.
+    for (size_t consumer = 0; consumer < 3; consumer++) {
+        PathMatches matches[3] = {0};
+        matches[consumer].consume = true;
+        JsonStream stream;
+        json_stream_init(&stream, items_json, strlen(items_json), true, json_stream_options_default());
+        JsonPathSetMatcher matcher;
+        json_path_set_matcher_init(&matcher, &set, collect_query_match, matches);
+        ck_assert(json_path_set_extract(&matcher, &stream));
+        ck_assert(expect_success(&stream));
+
+        ck_assert_str_eq(matches[0].text, "[");
+        ck_assert_str_eq(matches[1].text, consumer == 0 ? "{,0" : "{,[,0");
+        ck_assert_str_eq(matches[2].text, consumer == 2 ? "1" : "");
+        ck_assert_uint_eq(matcher.skipped_count, consumer == 0 ? 1 : 0);
+        ck_assert_uint_eq(matcher.match_count, consumer == 0 ? 3 : consumer == 1 ? 4 : 5);
+
+        json_path_set_matcher_free(&matcher);
+        json_stream_free_resources(&stream);
+    }
+
+    json_path_set_free(&set);
+    for (size_t i = 0; i < 3; i++) {
+        json_path_free(&paths[i]);
+    }
+}
+END_TEST
+
+Suite* json_path_suite(void) {
+    Suite* suite = suite_create("path");
+
+    TCase* compile = tcase_create("compile");
+    tcase_add_test(compile, json_path_compile_steps);
+    tcase_add_test(compile, json_pointer_compile_steps);
+
+    TCase* extract = tcase_create("extract");
+    tcase_add_test(extract, json_path_extract_wildcard);
+    tcase_add_test(extract, json_path_extract_index_and_root);
+    tcase_add_test(extract, json_pointer_extract);
+    tcase_add_test(extract, json_path_extract_across_chunks);
+    tcase_add_test(extract, json_path_callback_consumes_and_stops);
+    tcase_add_test(extract, json_path_extract_reports_stream_errors);
+
+    TCase* set = tcase_create("set");
+    tcase_add_test(set, json_path_set_single_pass);
+    tcase_add_test(set, json_path_set_shares_prefixes);
+    tcase_add_test(set, json_path_set_consumed_value_skips_later_queries);
+
+    suite_add_tcase(suite, compile);
+    suite_add_tcase(suite, extract);
+    suite_add_tcase(suite, set);
+
+    return suite;
+}
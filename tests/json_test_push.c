@@ -0,0 +1,227 @@
+#include <json_push.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "json_tests.h"
+
+static const char* push_json = "{\"name\": \"push \\\"parser\\\"\",\n"
+                               "  \"values\": [1, -2.5e3, true, false, null, [], {}],\n"
+                               "  \"nested\": {\"text\": \"a\\u00e9b\", \"count\": 12345678}}";
+
+typedef struct PushLog {
+    char text[8192];
+    size_t length;
+    size_t max_tail;
+    size_t stop_after;
+    size_t events;
+} PushLog;
+
+static bool log_token(JsonStream* stream, void* context) {
+    PushLog* log = context;
+    const char* token;
+    size_t size;
+    json_token(stream, &token, &size);
+    int written = snprintf(
+        log->text + log->length,
+        sizeof(log->text) - log->length,
+        "%s:%.*s\n",
+        json_token_type_name(json_token_type(stream)),
+        (int)size,
+        token
+    );
+    ck_assert_int_gt(written, 0);
+    log->length += (size_t)written;
+    ck_assert_uint_lt(log->length, sizeof(log->text));
+    log->events++;
+    return log->stop_after == 0 || log->events < log->stop_after;
+}
+
+static const JsonPushCallbacks log_callbacks = {
+    .on_object_start = log_token,
+    .on_object_end = log_token,
+    .on_array_start = log_token,
+    .on_array_end = log_token,
+    .on_property = log_token,
+    .on_string = log_token,
+    .on_number = log_token,
+    .on_boolean = log_token,
+    .on_null = log_token,
+    .on_comment = log_token,
+};
+
+static void log_whole_buffer(const char* json, PushLog* log) {
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, json_stream_options_default());
+    while (json_read(&stream)) {
+        log_token(&stream, log);
+    }
+    ck_assert(expect_success(&stream));
+    json_stream_free_resources(&stream);
+}
+
+// Pushes json in fragments of fragment_length bytes, each copied into a scratch buffer that is clobbered afterwards so
+// that nothing can keep pointing into it.
+static void log_fragments(const char* json, size_t fragment_length, PushLog* log) {
+    JsonPushParser parser;
+    json_push_init(&parser, log_callbacks, log, json_stream_options_default());
+    size_t length = strlen(json);
+    char fragment[64];
+    for (size_t offset = 0; offset < length; offset += fragment_length) {
+        size_t size = length - offset < fragment_length ? length - offset : fragment_length;
+        memcpy(fragment, json + offset, size);
+        ck_assert(json_push_feed(&parser, fragment, size));
+        memset(fragment, '#', sizeof(fragment));
+        if (parser.tail_length > log->max_tail) {
+            log->max_tail = parser.tail_length;
+        }
+    }
+    ck_assert(json_push_finish(&parser));
+    ck_assert(expect_success(&parser.stream));
+    ck_assert_uint_eq(json_total_bytes_consumed(&parser.stream), length);
+    json_push_free(&parser);
+}
+
+START_TEST(json_push_matches_pull_reader) {
+    PushLog expected = {0};
+    log_whole_buffer(push_json, &expected);
+
+    for (size_t fragment_length = 1; fragment_length <= 64; fragment_length++) {
+        PushLog actual = {0};
+        log_fragments(push_json, fragment_length, &actual);
+        ck_assert_uint_eq(actual.events, expected.events);
+        ck_assert_str_eq(actual.text, expected.text);
+    }
+}
+END_TEST
+
+START_TEST(json_push_buffers_only_the_tail) {
+    // The longest token is the "push \"parser\"" string; a fragment never leaves more than that behind.
+    PushLog log = {0};
+    log_fragments(push_json, 7, &log);
+    ck_assert_uint_le(log.max_tail, strlen("\"push \\\"parser\\\"\""));
+
+    char json[4096];
+    size_t length = 0;
+    json[length++] = '[';
+    for (size_t i = 0; i < 300; i++) {
+        length += (size_t)snprintf(json + length, sizeof(json) - length, "%s%zu", i ? "," : "", i * 7919);
+    }
+    json[length++] = ']';
+    json[length] = '\0';
+
+    PushLog numbers = {0};
+    log_fragments(json, 13, &numbers);
+    ck_assert_uint_eq(numbers.events, 302);
+    ck_assert_uint_le(numbers.max_tail, 8);
+}
+END_TEST
+
+START_TEST(json_push_long_token_across_fragments) {
+    char json[2048];
+    size_t length = 0;
+    memcpy(json, "{\"key\":\"", 8);
+    length += 8;
+    for (size_t i = 0; i < 200; i++) {
+        memcpy(json + length, i % 10 == 0 ? "\\n" : "ab", 2);
+        length += 2;
+    }
+    memcpy(json + length, "\"}", 3);
+
+    PushLog expected = {0};
+    log_whole_buffer(json, &expected);
+    PushLog actual = {0};
+    log_fragments(json, 3, &actual);
+    ck_assert_str_eq(actual.text, expected.text);
+    ck_assert_uint_ge(actual.max_tail, 400);
+}
+END_TEST
+
+START_TEST(json_push_finish_flushes_number) {
+    PushLog log = {0};
+    JsonPushParser parser;
+    json_push_init(&parser, log_callbacks, &log, json_stream_options_default());
+    ck_assert(json_push_feed(&parser, "  12", 4));
+    ck_assert(json_push_feed(&parser, "34", 2));
+    ck_assert_uint_eq(log.events, 0);
+    ck_assert(json_push_finish(&parser));
+    ck_assert_str_eq(log.text, "JSON_TYPE_NUMBER:1234\n");
+    json_push_free(&parser);
+}
+END_TEST
+
+START_TEST(json_push_reports_errors) {
+    PushLog log = {0};
+    JsonPushParser parser;
+    json_push_init(&parser, log_callbacks, &log, json_stream_options_default());
+    ck_assert(json_push_feed(&parser, "[1, 2", 5));
+    ck_assert(!json_push_finish(&parser));
+    ck_assert(expect_error(&parser.stream, JSON_ERROR_EXPECTED_END_OF_DIGIT_NOT_FOUND));
+    json_push_free(&parser);
+
+    json_push_init(&parser, log_callbacks, &log, json_stream_options_default());
+    ck_assert(json_push_feed(&parser, "[tr", 3));
+    ck_assert(!json_push_feed(&parser, "ux]", 3));
+    ck_assert(expect_error(&parser.stream, JSON_ERROR_EXPECTED_TRUE));
+    json_push_free(&parser);
+
+    json_push_init(&parser, log_callbacks, &log, json_stream_options_default());
+    ck_assert(!json_push_feed(&parser, "[1 2]", 5));
+    ck_assert(expect_error(&parser.stream, JSON_ERROR_FOUND_INVALID_CHARACTER));
+    ck_assert(!json_push_feed(&parser, "[", 1));
+    json_push_free(&parser);
+}
+END_TEST
+
+START_TEST(json_push_callback_stops) {
+    PushLog log = {.stop_after = 3};
+    JsonPushParser parser;
+    json_push_init(&parser, log_callbacks, &log, json_stream_options_default());
+    ck_assert(!json_push_feed(&parser, "[1, 2, 3, 4]", 12));
+    ck_assert(parser.stopped);
+    ck_assert(expect_success(&parser.stream));
+    ck_assert_uint_eq(log.events, 3);
+    ck_assert(!json_push_feed(&parser, "5", 1));
+    ck_assert(!json_push_finish(&parser));
+    ck_assert_uint_eq(log.events, 3);
+    json_push_free(&parser);
+}
+END_TEST
+
+START_TEST(json_push_reset_between_documents) {
+    PushLog log = {0};
+    JsonPushParser parser;
+    json_push_init(&parser, log_callbacks, &log, json_stream_options_default());
+    ck_assert(json_push_feed(&parser, "{\"a\": \"unfinished", 17));
+    ck_assert_uint_gt(parser.tail_length, 0);
+    char* tail = parser.tail;
+
+    json_push_reset(&parser);
+    log = (PushLog){0};
+    ck_assert(json_push_feed(&parser, "[true, \"x", 9));
+    ck_assert(json_push_feed(&parser, "\"]", 2));
+    ck_assert(json_push_finish(&parser));
+    ck_assert_str_eq(
+        log.text,
+        "JSON_TYPE_ARRAY_START:[\nJSON_TYPE_BOOLEAN:true\nJSON_TYPE_STRING:x\nJSON_TYPE_ARRAY_END:]\n"
+    );
+    ck_assert_ptr_eq(parser.tail, tail);
+    json_push_free(&parser);
+}
+END_TEST
+
+Suite* json_push_suite(void) {
+    Suite* suite = suite_create("push");
+
+    TCase* feed = tcase_create("feed");
+    tcase_add_test(feed, json_push_matches_pull_reader);
+    tcase_add_test(feed, json_push_buffers_only_the_tail);
+    tcase_add_test(feed, json_push_long_token_across_fragments);
+    tcase_add_test(feed, json_push_finish_flushes_number);
+    tcase_add_test(feed, json_push_reports_errors);
+    tcase_add_test(feed, json_push_callback_stops);
+    tcase_add_test(feed, json_push_reset_between_documents);
+
+    suite_add_tcase(suite, feed);
+
+    return suite;
+}
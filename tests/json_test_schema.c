@@ -0,0 +1,174 @@
+#include <json_schema.h>
+#include <json_validator.h>
+#include <string.h>
+
+#include "json_tests.h"
+
+static const char* person_schema_json =
+    "{"
+    "  \"type\": \"object\","
+    "  \"required\": [\"id\", \"name\"],"
+    "  \"additionalProperties\": false,"
+    "  \"properties\": {"
+    "    \"id\": {\"type\": \"integer\", \"minimum\": 1},"
+    "    \"name\": {\"type\": \"string\", \"maxLength\": 4},"
+    "    \"code\": {\"type\": \"string\", \"pattern\": \"^(unsupported)$\"},"
+    "    \"zip\": {\"type\": \"string\", \"pattern\": \"^\\\\d\\\\d\\\\d+$\"},"
+    "    \"ratio\": {\"type\": \"number\", \"exclusiveMaximum\": 1},"
+    "    \"color\": {\"enum\": [\"red\", \"green\", null, 7]},"
+    "    \"tags\": {\"type\": \"array\", \"minItems\": 1, \"maxItems\": 2, \"items\": {\"type\": \"string\"}},"
+    "    \"extra\": {\"type\": [\"object\", \"null\"]}"
+    "  }"
+    "}";
+
+static JsonSchema* parse_schema(const char* json) {
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, json_stream_options_default());
+
+    JsonSchema* schema;
+    bool result = json_schema_parse(&stream, &schema);
+    json_stream_free_resources(&stream);
+    return result ? schema : NULL;
+}
+
+static bool validate(const JsonSchema* schema, const char* json, JsonError* out_error) {
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, json_stream_options_default());
+
+    bool result = json_validate(&stream, schema);
+    *out_error = stream.error;
+    json_stream_free_resources(&stream);
+    return result;
+}
+
+START_TEST(json_schema_valid_documents) {
+    JsonSchema* schema = parse_schema(person_schema_json);
+    ck_assert_ptr_nonnull(schema);
+
+    const char* jsons[] = {
+        "{\"id\":1,\"name\":\"ab\"}",
+        "{\"name\":\"\\u00e9\\u00e9\\u00e9\\u00e9\",\"id\":2.0,\"color\":null}",
+        "{\"id\":3,\"name\":\"x\",\"code\":\"ignored\",\"zip\":\"12345\","
+        "\"ratio\":0.5,\"color\":7,\"tags\":[\"a\",\"b\"]}",
+        "{\"id\":4,\"name\":\"x\",\"color\":\"gr\\u0065en\",\"extra\":{\"anything\":[1,{\"goes\":true}]}}",
+    };
+
+    for (size_t i = 0; i < sizeof(jsons) / sizeof(jsons[0]); i++) {
+        JsonError error;
+        ck_assert_msg(validate(schema, jsons[i], &error), "document %zu", i);
+    }
+
+    json_schema_free(schema);
+}
+END_TEST
+
+START_TEST(json_schema_violations) {
+    JsonSchema* schema = parse_schema(person_schema_json);
+    ck_assert_ptr_nonnull(schema);
+
+    const struct {
+        const char* json;
+        JsonErrorType type;
+        const char* keyword;
+    } cases[] = {
+        {"{\"id\":\"1\",\"name\":\"a\"}", JSON_ERROR_SCHEMA_VIOLATION, "type"},
+        {"{\"id\":1.5,\"name\":\"a\"}", JSON_ERROR_SCHEMA_VIOLATION, "type"},
+        {"{\"id\":0,\"name\":\"a\"}", JSON_ERROR_SCHEMA_VIOLATION, "minimum"},
+        {"{\"id\":1,\"name\":\"abcde\"}", JSON_ERROR_SCHEMA_VIOLATION, "maxLength"},
+        {"{\"id\":1,\"name\":\"a\",\"zip\":\"12a\"}", JSON_ERROR_SCHEMA_VIOLATION, "pattern"},
+        {"{\"id\":1,\"name\":\"a\",\"ratio\":1}", JSON_ERROR_SCHEMA_VIOLATION, "exclusiveMaximum"},
+        {"{\"id\":1,\"name\":\"a\",\"color\":\"blue\"}", JSON_ERROR_SCHEMA_VIOLATION, "enum"},
+        {"{\"id\":1,\"name\":\"a\",\"tags\":[]}", JSON_ERROR_SCHEMA_VIOLATION, "minItems"},
+        {"{\"id\":1,\"name\":\"a\",\"tags\":[\"a\",\"b\",\"c\"]}", JSON_ERROR_SCHEMA_VIOLATION, "maxItems"},
+        {"{\"id\":1,\"name\":\"a\",\"tags\":[1]}", JSON_ERROR_SCHEMA_VIOLATION, "type"},
+        {"{\"id\":1,\"name\":\"a\",\"other\":1}", JSON_ERROR_SCHEMA_VIOLATION, "additionalProperties"},
+        {"{\"id\":1}", JSON_ERROR_REQUIRED_PROPERTY_NOT_FOUND, "name"},
+        {"[]", JSON_ERROR_SCHEMA_VIOLATION, "type"},
+    };
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        JsonError error;
+        ck_assert_msg(!validate(schema, cases[i].json, &error), "case %zu", i);
+        ck_assert_int_eq(error.type, cases[i].type);
+        ck_assert_str_eq(error.string, cases[i].keyword);
+    }
+
+    json_schema_free(schema);
+}
+END_TEST
+
+START_TEST(json_schema_violation_position) {
+    JsonSchema* schema = parse_schema(person_schema_json);
+    ck_assert_ptr_nonnull(schema);
+
+    JsonError error;
+    ck_assert(!validate(schema, "{\n  \"id\": 1,\n  \"name\": 42\n}", &error));
+    ck_assert_int_eq(error.type, JSON_ERROR_SCHEMA_VIOLATION);
+    ck_assert_uint_eq(error.line, 2);
+    ck_assert_uint_eq(error.column, 12);
+
+    json_schema_free(schema);
+}
+END_TEST
+
+START_TEST(json_schema_validate_while_reading) {
+    JsonSchema* schema = parse_schema(person_schema_json);
+    ck_assert_ptr_nonnull(schema);
+
+    const char* json = "{\"id\":7,\"name\":\"abc\",\"tags\":[\"x\"]}";
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, json_stream_options_default());
+    JsonValidator validator;
+    json_validator_init(&validator, schema);
+
+    int64_t id = 0;
+    size_t strings = 0;
+    while (json_read(&stream) && json_validator_next(&validator, &stream)) {
+        if (json_token_type(&stream) == JSON_TYPE_NUMBER) {
+            id = json_get_i64(&stream);
+        } else if (json_token_type(&stream) == JSON_TYPE_STRING) {
+            strings++;
+        }
+    }
+
+    ck_assert(expect_success(&stream));
+    ck_assert(json_validator_is_complete(&validator));
+    ck_assert_int_eq(id, 7);
+    ck_assert_uint_eq(strings, 2);
+
+    json_validator_free(&validator);
+    json_stream_free_resources(&stream);
+    json_schema_free(schema);
+}
+END_TEST
+
+START_TEST(json_schema_invalid_schema) {
+    const char* jsons[] = {"{\"type\":\"text\"}", "{\"required\":[1]}", "{\"maxLength\":-1}", "[]"};
+
+    for (size_t i = 0; i < sizeof(jsons) / sizeof(jsons[0]); i++) {
+        JsonStream stream;
+        json_stream_init(&stream, jsons[i], strlen(jsons[i]), true, json_stream_options_default());
+
+        JsonSchema* schema;
+        ck_assert(!json_schema_parse(&stream, &schema));
+        ck_assert_ptr_null(schema);
+        ck_assert(expect_error(&stream, JSON_ERROR_INVALID_SCHEMA));
+        json_stream_free_resources(&stream);
+    }
+}
+END_TEST
+
+Suite* json_schema_suite(void) {
+    Suite* suite = suite_create("schema");
+
+    TCase* validator = tcase_create("validator");
+    tcase_add_test(validator, json_schema_valid_documents);
+    tcase_add_test(validator, json_schema_violations);
+    tcase_add_test(validator, json_schema_violation_position);
+    tcase_add_test(validator, json_schema_validate_while_reading);
+    tcase_add_test(validator, json_schema_invalid_schema);
+
+    suite_add_tcase(suite, validator);
+
+    return suite;
+}
@@ -0,0 +1,162 @@
+#include <json_split.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "json_tests.h"
+
+typedef struct SplitSpans {
+    size_t starts[4096];
+    size_t ends[4096];
+    size_t count;
+    size_t stop_after;
+} SplitSpans;
+
+static bool collect_span(size_t start, size_t end, void* context) {
+    SplitSpans* spans = context;
+    ck_assert_uint_lt(spans->count, 4096);
+    spans->starts[spans->count] = start;
+    spans->ends[spans->count] = end;
+    spans->count++;
+    return spans->count != spans->stop_after;
+}
+
+// The spans a stream reading the buffer with allow_multiple_values sees.
+static size_t stream_spans(const char* json, size_t length, size_t* starts, size_t* ends) {
+    JsonStreamOptions options = json_stream_options_default();
+    options.allow_multiple_values = true;
+    JsonStream stream;
+    json_stream_init(&stream, json, length, true, options);
+    size_t count = 0;
+    while (json_read(&stream)) {
+        if (json_current_depth(&stream) != 0) {
+            continue;
+        }
+        JsonType type = json_token_type(&stream);
+        if (type == JSON_TYPE_OBJECT_START || type == JSON_TYPE_ARRAY_START) {
+            starts[count] = json_token_start(&stream);
+            continue;
+        }
+        if (type == JSON_TYPE_STRING) {
+            starts[count] = json_token_start(&stream) - 1;
+        } else if (type != JSON_TYPE_OBJECT_END && type != JSON_TYPE_ARRAY_END) {
+            starts[count] = json_token_start(&stream);
+        }
+        ends[count++] = json_total_bytes_consumed(&stream);
+    }
+    ck_assert(expect_success(&stream));
+    json_stream_free_resources(&stream);
+    return count;
+}
+
+static void check_split(const char* json, size_t length) {
+    SplitSpans* spans = calloc(1, sizeof(SplitSpans));
+    SplitSpans* expected = calloc(1, sizeof(SplitSpans));
+    ck_assert_ptr_nonnull(spans);
+    ck_assert_ptr_nonnull(expected);
+    expected->count = stream_spans(json, length, expected->starts, expected->ends);
+
+    size_t end = json_split_values(json, length, true, collect_span, spans);
+    ck_assert_uint_eq(spans->count, expected->count);
+    ck_assert_mem_eq(spans->starts, expected->starts, expected->count * sizeof(size_t));
+    ck_assert_mem_eq(spans->ends, expected->ends, expected->count * sizeof(size_t));
+    ck_assert_uint_eq(end, expected->count ? expected->ends[expected->count - 1] : 0);
+    free(expected);
+    free(spans);
+}
+
+START_TEST(json_split_small_values) {
+    const char* json = "{\"a\": \"}]\\\"{\"} [1, [2, {}]] \"str\\\\\" 12 -3.5e2\ttrue null\n"
+                       "{\"b\":\"\\\\\\\"\"}\"x\"[]";
+    SplitSpans spans = {0};
+    ck_assert_uint_eq(json_split_values(json, strlen(json), true, collect_span, &spans), strlen(json));
+    ck_assert_uint_eq(spans.count, 10);
+    const char* values[] = {
+        "{\"a\": \"}]\\\"{\"}", "[1, [2, {}]]", "\"str\\\\\"", "12", "-3.5e2", "true", "null", "{\"b\":\"\\\\\\\"\"}",
+        "\"x\"", "[]",
+    };
+    for (size_t i = 0; i < spans.count; i++) {
+        ck_assert_uint_eq(spans.ends[i] - spans.starts[i], strlen(values[i]));
+        ck_assert_mem_eq(json + spans.starts[i], values[i], strlen(values[i]));
+    }
+    check_split(json, strlen(json));
+}
+END_TEST
+
+START_TEST(json_split_matches_stream) {
+    static const char* files[] = {"400KB.json", "deep_tree.json", "lots_of_strings.json", "broad_tree.json"};
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+        char* json = read_json_file(files[i]);
+        ck_assert_ptr_nonnull(json);
+        check_split(json, strlen(json));
+        free(json);
+    }
+
+    // Records of every size put the escapes, quotes and brackets at every position of a block.
+    static const char filler[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    char* json = malloc(256 * 1024);
+    ck_assert_ptr_nonnull(json);
+    size_t length = 0;
+    for (size_t i = 0; i < 2000; i++) {
+        size_t run = i % 7;
+        length += (size_t)sprintf(json + length, "{\"id\": %zu, \"text\": \"", i);
+        for (size_t j = 0; j < run; j++) {
+            json[length++] = '\\';
+            json[length++] = j % 2 ? '"' : '\\';
+        }
+        length += (size_t)sprintf(json + length, "%.*s\", \"list\": [[%zu], {}]}", (int)(i % 53), filler, i);
+        json[length++] = i % 3 ? '\n' : ' ';
+        if (i % 11 == 0) {
+            length += (size_t)sprintf(json + length, "\"top \\\\\" %zu [\"\\\\\\\\\"] ", i);
+        }
+    }
+    json[length] = '\0';
+    check_split(json, length);
+    free(json);
+}
+END_TEST
+
+START_TEST(json_split_partial_buffers) {
+    const char* json = "[1, 2] {\"a\": \"b\"}  123 \"open";
+    size_t length = strlen(json);
+    SplitSpans spans = {0};
+
+    // Neither the open string nor a number that may go on is reported before the final block.
+    ck_assert_uint_eq(json_split_values(json, length, false, collect_span, &spans), 22);
+    ck_assert_uint_eq(spans.count, 3);
+    spans.count = 0;
+    ck_assert_uint_eq(json_split_values(json, 22, false, collect_span, &spans), 17);
+    ck_assert_uint_eq(spans.count, 2);
+    spans.count = 0;
+    ck_assert_uint_eq(json_split_values(json, 22, true, collect_span, &spans), 22);
+    ck_assert_uint_eq(spans.count, 3);
+    ck_assert_uint_eq(spans.starts[2], 19);
+    spans.count = 0;
+    ck_assert_uint_eq(json_split_values(json, 12, true, collect_span, &spans), 6);
+    ck_assert_uint_eq(spans.count, 1);
+
+    // The callback stops the split.
+    spans.count = 0;
+    spans.stop_after = 1;
+    ck_assert_uint_eq(json_split_values(json, length, true, collect_span, &spans), 6);
+    ck_assert_uint_eq(spans.count, 1);
+
+    spans.count = 0;
+    spans.stop_after = 0;
+    ck_assert_uint_eq(json_split_values("  \n", 3, true, collect_span, &spans), 0);
+    ck_assert_uint_eq(spans.count, 0);
+}
+END_TEST
+
+Suite* json_split_suite(void) {
+    Suite* suite = suite_create("split");
+
+    TCase* values = tcase_create("values");
+    tcase_add_test(values, json_split_small_values);
+    tcase_add_test(values, json_split_matches_stream);
+    tcase_add_test(values, json_split_partial_buffers);
+
+    suite_add_tcase(suite, values);
+
+    return suite;
+}
@@ -0,0 +1,477 @@
+#include <json_stream.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "json_tests.h"
+
+static JsonStreamOptions utf8_options(JsonUtf8Validation validation) {
+    JsonStreamOptions options = json_stream_options_default();
+    options.validate_utf8 = validation;
+    return options;
+}
+
+START_TEST(json_utf8_valid_multibyte_strings) {
+    const char* json = "{\"caf\xC3\xA9\":[\"\xE2\x82\xAC\",\"\xF0\x9F\x98\x80 emoji\"]}";
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, utf8_options(JSON_UTF8_VALIDATION_TOKENS));
+
+    while (json_read(&stream)) {
+    }
+
+    ck_assert(expect_success(&stream));
+    json_stream_free_resources(&stream);
+}
+END_TEST
+
+START_TEST(json_utf8_invalid_string_token) {
+    const char* json = "[\"ok\",\"ab\xC3(\"]";
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, utf8_options(JSON_UTF8_VALIDATION_TOKENS));
+
+    ck_assert(json_read(&stream));
+    ck_assert(json_read(&stream));
+    ck_assert(!json_read(&stream));
+    ck_assert(expect_error(&stream, JSON_ERROR_INVALID_UTF8));
+    ck_assert_int_eq(stream.error.number, 9);
+    ck_assert_uint_eq(stream.error.column, 9);
+    json_stream_free_resources(&stream);
+}
+END_TEST
+
+START_TEST(json_utf8_invalid_property_token) {
+    const char* json = "{\"\xED\xA0\x80\":1}";
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, utf8_options(JSON_UTF8_VALIDATION_TOKENS));
+
+    ck_assert(json_read(&stream));
+    ck_assert(!json_read(&stream));
+    ck_assert(expect_error(&stream, JSON_ERROR_INVALID_UTF8));
+    ck_assert_int_eq(stream.error.number, 2);
+    json_stream_free_resources(&stream);
+}
+END_TEST
+
+START_TEST(json_utf8_invalid_escaped_string_token) {
+    const char* json = "[\"\\n\xFF\"]";
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, utf8_options(JSON_UTF8_VALIDATION_TOKENS));
+
+    ck_assert(json_read(&stream));
+    ck_assert(!json_read(&stream));
+    ck_assert(expect_error(&stream, JSON_ERROR_INVALID_UTF8));
+    ck_assert_int_eq(stream.error.number, 4);
+    json_stream_free_resources(&stream);
+}
+END_TEST
+
+START_TEST(json_utf8_invalid_buffer_up_front) {
+    const char* json = "[\n  1, // \xC0\xAF\n  2\n]";
+    JsonStreamOptions options = utf8_options(JSON_UTF8_VALIDATION_BUFFER);
+    options.comment_handling = JSON_COMMENT_SKIP;
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, options);
+
+    ck_assert(!json_read(&stream));
+    ck_assert(expect_error(&stream, JSON_ERROR_INVALID_UTF8));
+    ck_assert_int_eq(stream.error.number, 10);
+    ck_assert_uint_eq(stream.error.line, 1);
+    ck_assert_uint_eq(stream.error.column, 8);
+    json_stream_free_resources(&stream);
+}
+END_TEST
+
+START_TEST(json_utf8_not_validated_by_default) {
+    const char* json = "[\"\xFF\"]";
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, json_stream_options_default());
+
+    while (json_read(&stream)) {
+    }
+
+    ck_assert(expect_success(&stream));
+    json_stream_free_resources(&stream);
+}
+END_TEST
+
+static bool unescape_first_string(
+    const char* json,
+    char* buffer,
+    size_t buffer_length,
+    char** out,
+    size_t* out_length
+) {
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, json_stream_options_default());
+
+    bool result = json_read(&stream) && json_read(&stream)
+               && json_try_get_string_escaped(&stream, buffer, buffer_length, out, out_length);
+    json_stream_free_resources(&stream);
+    return result;
+}
+
+START_TEST(json_unescape_basic_multilingual_plane) {
+    char* out;
+    size_t length;
+    ck_assert(unescape_first_string("[\"caf\\u00e9 \\u20AC\"]", NULL, 0, &out, &length));
+    ck_assert_uint_eq(length, 9);
+    ck_assert_mem_eq(out, "caf\xC3\xA9 \xE2\x82\xAC", 9);
+    free(out);
+}
+END_TEST
+
+START_TEST(json_unescape_surrogate_pair) {
+    char* out;
+    size_t length;
+    ck_assert(unescape_first_string("[\"\\uD83D\\uDE00!\"]", NULL, 0, &out, &length));
+    ck_assert_uint_eq(length, 5);
+    ck_assert_mem_eq(out, "\xF0\x9F\x98\x80!", 5);
+    free(out);
+}
+END_TEST
+
+START_TEST(json_unescape_simple_escapes) {
+    char* out;
+    size_t length;
+    const char* json = "[\"C:\\\\Program Files\\\\json\\/stream\\t\\\"quoted\\\"\\n\"]";
+    ck_assert(unescape_first_string(json, NULL, 0, &out, &length));
+    ck_assert_str_eq(out, "C:\\Program Files\\json/stream\t\"quoted\"\n");
+    ck_assert_uint_eq(length, strlen(out));
+    free(out);
+}
+END_TEST
+
+START_TEST(json_unescape_long_runs) {
+    char* out;
+    size_t length;
+    const char* json = "[\"0123456789abcdefghijklmnopqrstuvwxyz\\u0041BCDEFGHIJKLMNOPQRSTUVWXYZ0123456789\\n\"]";
+    ck_assert(unescape_first_string(json, NULL, 0, &out, &length));
+    ck_assert_str_eq(out, "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789\n");
+    free(out);
+}
+END_TEST
+
+START_TEST(json_unescape_lone_surrogates) {
+    const char* jsons[] = {"[\"\\uD83D\"]", "[\"\\uD83Dx\"]", "[\"\\uD83D\\u0041\"]", "[\"\\uDE00\"]"};
+    const long long values[] = {0xD83D, 0xD83D, 0xD83D, 0xDE00};
+
+    for (size_t i = 0; i < sizeof(jsons) / sizeof(jsons[0]); i++) {
+        JsonStream stream;
+        json_stream_init(&stream, jsons[i], strlen(jsons[i]), true, json_stream_options_default());
+        ck_assert(json_read(&stream));
+        ck_assert(json_read(&stream));
+
+        char* out;
+        ck_assert(!json_try_get_string_escaped(&stream, NULL, 0, &out, NULL));
+        ck_assert(expect_error(&stream, JSON_ERROR_INVALID_UTF16_SURROGATE));
+        ck_assert_int_eq(stream.error.number, values[i]);
+        json_stream_free_resources(&stream);
+    }
+}
+END_TEST
+
+START_TEST(json_unescape_truncates_to_buffer) {
+    char buffer[6];
+    char* out;
+    size_t length;
+    ck_assert(unescape_first_string("[\"ab\\u00e9\\u20ACcd\"]", buffer, sizeof(buffer), &out, &length));
+    ck_assert_ptr_eq(out, buffer);
+    ck_assert_uint_eq(length, 4);
+    ck_assert_str_eq(out, "ab\xC3\xA9");
+}
+END_TEST
+
+START_TEST(json_text_equals_unescaped) {
+    const char* json = "{\"name\":\"value\"}";
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, json_stream_options_default());
+
+    ck_assert(json_read(&stream));
+    ck_assert(json_read(&stream));
+    ck_assert(json_text_equals(&stream, "name", 4));
+    ck_assert(!json_text_equals(&stream, "nam", 3));
+    ck_assert(!json_text_equals(&stream, "names", 5));
+    ck_assert(!json_text_equals(&stream, "nome", 4));
+    ck_assert(expect_success(&stream));
+    json_stream_free_resources(&stream);
+}
+END_TEST
+
+START_TEST(json_text_equals_escaped) {
+    const char* json = "{\"caf\\u00e9\\n\\uD83D\\uDE00\":1}";
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, json_stream_options_default());
+
+    ck_assert(json_read(&stream));
+    ck_assert(json_read(&stream));
+    ck_assert(json_text_equals(&stream, "caf\xC3\xA9\n\xF0\x9F\x98\x80", 10));
+    ck_assert(!json_text_equals(&stream, "caf\xC3\xA9\n", 6));
+    ck_assert(!json_text_equals(&stream, "caf\xC3\xA9\n\xF0\x9F\x98\x80!", 11));
+    ck_assert(!json_text_equals(&stream, "cafe\n\xF0\x9F\x98\x80", 9));
+    ck_assert(expect_success(&stream));
+    json_stream_free_resources(&stream);
+}
+END_TEST
+
+START_TEST(json_text_equals_requires_string) {
+    const char* json = "[1]";
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, json_stream_options_default());
+
+    ck_assert(json_read(&stream));
+    ck_assert(json_read(&stream));
+    ck_assert(!json_text_equals(&stream, "1", 1));
+    ck_assert(expect_error(&stream, JSON_ERROR_INVALID_OPERATION_EXPECTED_STRING_COMPARISON));
+    json_stream_free_resources(&stream);
+}
+END_TEST
+
+START_TEST(json_text_points_into_buffer) {
+    const char* json = "{\"plain\":\"value\",\"n\":null}";
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, json_stream_options_default());
+
+    const char* text;
+    size_t length;
+    ck_assert(json_read(&stream));
+    ck_assert(json_try_read_text(&stream, &text, &length));
+    ck_assert_ptr_eq(text, json + 2);
+    ck_assert_uint_eq(length, 5);
+    ck_assert(json_try_read_text(&stream, &text, &length));
+    ck_assert_ptr_eq(text, json + 10);
+    ck_assert_uint_eq(length, 5);
+    ck_assert_ptr_eq(json_read_text(&stream, &length), json + 18);
+    ck_assert(json_try_read_text(&stream, &text, &length));
+    ck_assert_ptr_null(text);
+    ck_assert_uint_eq(length, 0);
+    ck_assert_ptr_null(stream.scratch);
+
+    // A token that is not a string is left to be read again.
+    json_stream_reset(&stream, "[1]", 3, true);
+    ck_assert(json_read(&stream));
+    ck_assert(!json_try_read_text(&stream, &text, &length));
+    ck_assert_int_eq(json_token_type(&stream), JSON_TYPE_ARRAY_START);
+    ck_assert_ptr_null(json_get_text(&stream, &length));
+    ck_assert(expect_error(&stream, JSON_ERROR_INVALID_OPERATION_EXPECTED_STRING));
+    json_stream_free_resources(&stream);
+}
+END_TEST
+
+START_TEST(json_text_reuses_scratch) {
+    const char* digits = "0123456789012345678901234567890123456789";
+    char json[2048];
+    size_t length = 0;
+    json[length++] = '[';
+    for (size_t i = 0; i < 40; i++) {
+        length += (size_t)snprintf(
+            json + length,
+            sizeof(json) - length,
+            "%s\"%.*s\\u00e9\"",
+            i ? "," : "",
+            (int)i,
+            digits
+        );
+    }
+    json[length++] = ']';
+
+    JsonStream stream;
+    json_stream_init(&stream, json, length, true, json_stream_options_default());
+    ck_assert(json_read(&stream));
+
+    // Every value fits the first scratch allocation, which is then kept for the next document.
+    const char* text;
+    size_t text_length;
+    size_t capacity = 0;
+    size_t grown = 0;
+    for (size_t i = 0; i < 40; i++) {
+        ck_assert(json_try_read_text(&stream, &text, &text_length));
+        ck_assert_ptr_eq(text, stream.scratch);
+        ck_assert_uint_eq(text_length, i + 2);
+        ck_assert_mem_eq(text, digits, i);
+        ck_assert_str_eq(text + i, "\xC3\xA9");
+        if (stream.scratch_capacity != capacity) {
+            capacity = stream.scratch_capacity;
+            grown++;
+        }
+    }
+    ck_assert_uint_eq(grown, 1);
+
+    char* scratch = stream.scratch;
+    const char* next = "{\"\\n\":\"\\uD83D\\uDE00\"}";
+    json_stream_reset(&stream, next, strlen(next), true);
+    ck_assert(json_read(&stream));
+    ck_assert(json_try_read_text(&stream, &text, &text_length));
+    ck_assert_ptr_eq(text, scratch);
+    ck_assert_str_eq(text, "\n");
+    ck_assert_ptr_eq(json_read_text(&stream, &text_length), scratch);
+    ck_assert_str_eq(scratch, "\xF0\x9F\x98\x80");
+    ck_assert_uint_eq(text_length, 4);
+    json_stream_free_resources(&stream);
+    ck_assert_ptr_null(stream.scratch);
+}
+END_TEST
+
+START_TEST(json_text_reports_invalid_escapes) {
+    const char* json = "[\"\\uDE00\"]";
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, json_stream_options_default());
+    ck_assert(json_read(&stream));
+    ck_assert(json_read(&stream));
+
+    const char* text;
+    size_t length;
+    ck_assert(!json_try_get_text(&stream, &text, &length));
+    ck_assert(expect_error(&stream, JSON_ERROR_INVALID_UTF16_SURROGATE));
+    json_stream_free_resources(&stream);
+}
+END_TEST
+
+START_TEST(json_string_view_flags_escapes) {
+    const char* json = "{\"key\":\"a\\tb\",\"n\":null}";
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, json_stream_options_default());
+    ck_assert(json_read(&stream));
+
+    JsonStringView view = json_read_string_view(&stream);
+    ck_assert_ptr_eq(view.ptr, json + 2);
+    ck_assert_uint_eq(view.len, 3);
+    ck_assert(!view.needs_unescape);
+
+    ck_assert(json_try_read_string_view(&stream, &view));
+    ck_assert_uint_eq(view.len, 4);
+    ck_assert(view.needs_unescape);
+    char buffer[8];
+    size_t length;
+    ck_assert(!json_string_view_unescape(&stream, view, buffer, 2, &length));
+    ck_assert(json_string_view_unescape(&stream, view, buffer, sizeof(buffer), &length));
+    ck_assert_uint_eq(length, 3);
+    ck_assert_mem_eq(buffer, "a\tb", 3);
+
+    ck_assert(json_try_read_string_view(&stream, &view));
+    ck_assert(json_try_read_string_view(&stream, &view));
+    ck_assert_ptr_null(view.ptr);
+    ck_assert(!view.needs_unescape);
+
+    view = json_read_string_view(&stream);
+    ck_assert_ptr_null(view.ptr);
+    ck_assert(expect_error(&stream, JSON_ERROR_INVALID_OPERATION_EXPECTED_STRING));
+    json_stream_free_resources(&stream);
+}
+END_TEST
+
+START_TEST(json_string_views_fill_array) {
+    const char* json = "{\"column\":[\"a\", \"b\\\"c\", null, \"\", \"last\"],\"mixed\":[\"x\", 1]}";
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, json_stream_options_default());
+    ck_assert(json_read(&stream));
+    ck_assert(json_read(&stream));
+    ck_assert(json_read(&stream));
+    ck_assert_int_eq(json_token_type(&stream), JSON_TYPE_ARRAY_START);
+
+    // Two calls: the first stops at capacity, the second after the end of the array.
+    JsonStringView views[3];
+    size_t count;
+    ck_assert(json_try_read_string_views(&stream, views, 3, &count));
+    ck_assert_uint_eq(count, 3);
+    ck_assert_int_ne(json_token_type(&stream), JSON_TYPE_ARRAY_END);
+    ck_assert_uint_eq(views[0].len, 1);
+    ck_assert_mem_eq(views[0].ptr, "a", 1);
+    ck_assert(views[1].needs_unescape);
+    ck_assert_uint_eq(views[1].len, 4);
+    ck_assert_ptr_null(views[2].ptr);
+
+    ck_assert(json_try_read_string_views(&stream, views, 3, &count));
+    ck_assert_uint_eq(count, 2);
+    ck_assert_int_eq(json_token_type(&stream), JSON_TYPE_ARRAY_END);
+    ck_assert_uint_eq(views[0].len, 0);
+    ck_assert_ptr_nonnull(views[0].ptr);
+    ck_assert_mem_eq(views[1].ptr, "last", 4);
+
+    // A number stops the batch and is left to be read.
+    ck_assert(json_read(&stream));
+    ck_assert(json_read(&stream));
+    ck_assert(!json_try_read_string_views(&stream, views, 3, &count));
+    ck_assert(expect_success(&stream));
+    ck_assert_uint_eq(count, 1);
+    ck_assert(json_read(&stream));
+    ck_assert_int_eq(json_token_type(&stream), JSON_TYPE_NUMBER);
+    json_stream_free_resources(&stream);
+}
+END_TEST
+
+START_TEST(json_string_views_resume_partial_buffers) {
+    const char* json = "[\"one\", \"two\", \"three\", \"four\", \"five\", \"six\"]";
+    const char* expected[] = {"one", "two", "three", "four", "five", "six"};
+    size_t length = strlen(json);
+
+    for (size_t window = 4; window <= length; window += 5) {
+        size_t end = window;
+        JsonStream stream;
+        json_stream_init(&stream, json, end, end == length, json_stream_options_default());
+        ck_assert(json_read(&stream));
+
+        size_t seen = 0;
+        while (json_token_type(&stream) != JSON_TYPE_ARRAY_END) {
+            JsonStringView views[6];
+            size_t count;
+            bool result = json_try_read_string_views(&stream, views, 6, &count);
+            for (size_t i = 0; i < count; i++) {
+                ck_assert_uint_eq(views[i].len, strlen(expected[seen]));
+                ck_assert_mem_eq(views[i].ptr, expected[seen], views[i].len);
+                seen++;
+            }
+            if (!result) {
+                ck_assert(expect_success(&stream));
+                size_t offset = json_total_bytes_consumed(&stream);
+                end = end + window < length ? end + window : length;
+                json_stream_continue(&stream, &stream, json + offset, end - offset, end == length);
+            }
+        }
+        ck_assert_uint_eq(seen, 6);
+        json_stream_free_resources(&stream);
+    }
+}
+END_TEST
+
+Suite* json_strings_suite(void) {
+    Suite* suite = suite_create("strings");
+
+    TCase* utf8 = tcase_create("utf8");
+    tcase_add_test(utf8, json_utf8_valid_multibyte_strings);
+    tcase_add_test(utf8, json_utf8_invalid_string_token);
+    tcase_add_test(utf8, json_utf8_invalid_property_token);
+    tcase_add_test(utf8, json_utf8_invalid_escaped_string_token);
+    tcase_add_test(utf8, json_utf8_invalid_buffer_up_front);
+    tcase_add_test(utf8, json_utf8_not_validated_by_default);
+
+    TCase* unescape = tcase_create("unescape");
+    tcase_add_test(unescape, json_unescape_basic_multilingual_plane);
+    tcase_add_test(unescape, json_unescape_surrogate_pair);
+    tcase_add_test(unescape, json_unescape_simple_escapes);
+    tcase_add_test(unescape, json_unescape_long_runs);
+    tcase_add_test(unescape, json_unescape_lone_surrogates);
+    tcase_add_test(unescape, json_unescape_truncates_to_buffer);
+
+    TCase* equals = tcase_create("equals");
+    tcase_add_test(equals, json_text_equals_unescaped);
+    tcase_add_test(equals, json_text_equals_escaped);
+    tcase_add_test(equals, json_text_equals_requires_string);
+
+    TCase* text = tcase_create("text");
+    tcase_add_test(text, json_text_points_into_buffer);
+    tcase_add_test(text, json_text_reuses_scratch);
+    tcase_add_test(text, json_text_reports_invalid_escapes);
+
+    TCase* views = tcase_create("views");
+    tcase_add_test(views, json_string_view_flags_escapes);
+    tcase_add_test(views, json_string_views_fill_array);
+    tcase_add_test(views, json_string_views_resume_partial_buffers);
+
+    suite_add_tcase(suite, utf8);
+    suite_add_tcase(suite, unescape);
+    suite_add_tcase(suite, equals);
+    suite_add_tcase(suite, text);
+    suite_add_tcase(suite, views);
+
+    return suite;
+}
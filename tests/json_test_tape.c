@@ -0,0 +1,473 @@
+#include <json_tape.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "json_tests.h"
+
+static const char* tape_files[] = {
+    "400KB.json",
+    "deep_tree.json",
+    "lots_of_numbers.json",
+    "lots_of_strings.json",
+    "special_num_format.json",
+};
+
+static void build_tape(JsonTape* tape, const char* json, JsonStreamOptions options) {
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, options);
+    ck_assert(json_tape_build(tape, &stream));
+    ck_assert(expect_success(&stream));
+    json_stream_free_resources(&stream);
+}
+
+// Reads the document directly and through the tape side by side.
+static void compare_replay(const char* json, const JsonTape* tape, JsonStreamOptions options) {
+    JsonStream direct;
+    json_stream_init(&direct, json, strlen(json), true, options);
+    JsonStream replay;
+    json_stream_init_tape(&replay, tape, options);
+
+    size_t count = 0;
+    while (json_read(&direct)) {
+        ck_assert(json_read(&replay));
+        count++;
+        JsonType type = json_token_type(&direct);
+        ck_assert_int_eq(json_token_type(&replay), type);
+        ck_assert_uint_eq(json_token_start(&replay), json_token_start(&direct));
+        ck_assert_uint_eq(json_token_size(&replay), json_token_size(&direct));
+        ck_assert_uint_eq(json_current_depth(&replay), json_current_depth(&direct));
+        ck_assert_uint_eq(json_total_bytes_consumed(&replay), json_total_bytes_consumed(&direct));
+
+        if (type == JSON_TYPE_NUMBER) {
+            int64_t direct_i64 = 0;
+            int64_t replay_i64 = 0;
+            ck_assert(json_try_get_i64(&replay, &replay_i64) == json_try_get_i64(&direct, &direct_i64));
+            ck_assert_int_eq(replay_i64, direct_i64);
+            double direct_double = 0;
+            double replay_double = 0;
+            ck_assert(json_try_get_double(&replay, &replay_double) == json_try_get_double(&direct, &direct_double));
+            ck_assert(replay_double == direct_double);
+        } else if (type == JSON_TYPE_STRING || type == JSON_TYPE_PROPERTY) {
+            size_t direct_length = 0;
+            size_t replay_length = 0;
+            const char* direct_text = json_get_string(&direct, &direct_length);
+            const char* replay_text = json_get_string(&replay, &replay_length);
+            ck_assert_uint_eq(replay_length, direct_length);
+            ck_assert_mem_eq(replay_text, direct_text, direct_length);
+        }
+    }
+
+    ck_assert_uint_eq(count, tape->token_count);
+    ck_assert(!json_read(&replay));
+    ck_assert(expect_success(&direct));
+    ck_assert(expect_success(&replay));
+    json_stream_free_resources(&direct);
+    json_stream_free_resources(&replay);
+}
+
+START_TEST(json_tape_replays_tokens) {
+    JsonStreamOptions options = json_stream_options_default();
+    for (size_t i = 0; i < sizeof(tape_files) / sizeof(tape_files[0]); i++) {
+        char* json = read_json_file(tape_files[i]);
+        ck_assert_ptr_nonnull(json);
+        JsonTape tape;
+        build_tape(&tape, json, options);
+        ck_assert(!tape.mapped);
+        ck_assert_uint_eq(tape.document_length, strlen(json));
+        compare_replay(json, &tape, options);
+        json_tape_free(&tape);
+        free(json);
+    }
+}
+END_TEST
+
+START_TEST(json_tape_save_and_map) {
+    char* json = read_json_file("400KB.json");
+    ck_assert_ptr_nonnull(json);
+    JsonStreamOptions options = json_stream_options_default();
+    JsonTape tape;
+    build_tape(&tape, json, options);
+
+    const char* path = "tape_400KB.tape";
+    ck_assert(json_tape_save(&tape, path));
+    JsonTape mapped;
+    ck_assert(json_tape_map(&mapped, path));
+    ck_assert(mapped.mapped);
+    ck_assert_uint_eq(mapped.token_count, tape.token_count);
+    ck_assert_uint_eq(mapped.memory_length, tape.memory_length);
+    ck_assert_mem_eq(mapped.memory, tape.memory, tape.memory_length);
+
+    // Any process may map the same file while another replays it.
+    JsonTape shared;
+    ck_assert(json_tape_map(&shared, path));
+    compare_replay(json, &mapped, options);
+    compare_replay(json, &shared, options);
+    json_tape_free(&shared);
+    json_tape_free(&mapped);
+
+    remove(path);
+    json_tape_free(&tape);
+    free(json);
+}
+END_TEST
+
+START_TEST(json_tape_rollback_and_skip) {
+    const char* json =
+        "{\"skipped\": {\"a\": [1, 2, {\"b\": null}]}, \"values\": [7, -3, 2.5, true], \"name\": \"tape\"}";
+    JsonStreamOptions options = json_stream_options_default();
+    JsonTape tape;
+    build_tape(&tape, json, options);
+
+    JsonStream stream;
+    json_stream_init_tape(&stream, &tape, options);
+    ck_assert(json_read(&stream));
+    ck_assert(json_read(&stream));
+    ck_assert(json_text_equals(&stream, "skipped", 7));
+    ck_assert(json_skip(&stream));
+    ck_assert_int_eq(json_token_type(&stream), JSON_TYPE_OBJECT_END);
+    ck_assert_uint_eq(json_current_depth(&stream), 1);
+
+    ck_assert(json_read(&stream));
+    ck_assert(json_text_equals(&stream, "values", 6));
+    ck_assert(json_read(&stream));
+    ck_assert_int_eq(json_token_type(&stream), JSON_TYPE_ARRAY_START);
+
+    // A failed typed read rolls back and the tape resumes from the same token.
+    bool flag = false;
+    ck_assert(!json_try_read_bool(&stream, &flag));
+    int64_t value = 0;
+    ck_assert(json_try_read_i64(&stream, &value));
+    ck_assert_int_eq(value, 7);
+    ck_assert(json_try_read_i64(&stream, &value));
+    ck_assert_int_eq(value, -3);
+    double real = 0;
+    ck_assert(json_try_read_double(&stream, &real));
+    ck_assert(real == 2.5);
+    ck_assert(json_try_read_bool(&stream, &flag));
+    ck_assert(flag);
+    ck_assert(json_read(&stream));
+    ck_assert_int_eq(json_token_type(&stream), JSON_TYPE_ARRAY_END);
+
+    ck_assert(json_read(&stream));
+    ck_assert(json_read(&stream));
+    ck_assert(json_text_equals(&stream, "tape", 4));
+    ck_assert(json_read(&stream));
+    ck_assert_int_eq(json_token_type(&stream), JSON_TYPE_OBJECT_END);
+    ck_assert(!json_read(&stream));
+    ck_assert(expect_success(&stream));
+
+    json_stream_free_resources(&stream);
+    json_tape_free(&tape);
+}
+END_TEST
+
+START_TEST(json_tape_rejects_invalid_files) {
+    const char* json = "[\"first\", 1, {\"second\": 2}]";
+    JsonStreamOptions options = json_stream_options_default();
+    JsonTape tape;
+    build_tape(&tape, json, options);
+
+    const char* path = "tape_invalid.tape";
+    JsonTape mapped;
+    ck_assert(!json_tape_map(&mapped, path));
+
+    FILE* file = fopen(path, "wb");
+    ck_assert_ptr_nonnull(file);
+    fwrite(tape.memory, 1, tape.memory_length - 1, file);
+    fclose(file);
+    ck_assert(!json_tape_map(&mapped, path));
+
+    char* corrupt = malloc(tape.memory_length);
+    ck_assert_ptr_nonnull(corrupt);
+    memcpy(corrupt, tape.memory, tape.memory_length);
+    corrupt[0] = 'X';
+    file = fopen(path, "wb");
+    ck_assert_ptr_nonnull(file);
+    fwrite(corrupt, 1, tape.memory_length, file);
+    fclose(file);
+    ck_assert(!json_tape_map(&mapped, path));
+
+    // Tokens out of the document, out of order or at the wrong depth are rejected when the tape is mapped.
+    for (size_t c = 0; c < 10; c++) {
+        memcpy(corrupt, tape.memory, tape.memory_length);
+        JsonTapeToken* tokens = (JsonTapeToken*)(corrupt + JSON_TAPE_HEADER_SIZE);
+        switch (c) {
+            case 0:
+                tokens[1].type = JSON_TYPE_COMMENT + 1;
+                break;
+            case 1:
+                tokens[1].depth = 2;
+                break;
+            case 2:
+                tokens[0].type = JSON_TYPE_STRING;
+                break;
+            case 3:
+                tokens[2].consumed = tokens[1].consumed;
+                break;
+            case 4:
+                tokens[1].start = UINT64_MAX - 1;
+                break;
+            case 5:
+                tokens[1].size = UINT64_MAX;
+                break;
+            case 6: {
+                uint64_t start = tokens[1].start;
+                tokens[1].start = tokens[2].start;
+                tokens[2].start = start;
+                break;
+            }
+            case 7:
+                tokens[2].start = tokens[1].consumed - 1;
+                break;
+            case 8:
+                tokens[1].size = tokens[1].consumed - tokens[1].start + 1;
+                break;
+            default:
+                tokens[tape.token_count - 1].consumed = tape.document_length + 1;
+                break;
+        }
+        file = fopen(path, "wb");
+        ck_assert_ptr_nonnull(file);
+        fwrite(corrupt, 1, tape.memory_length, file);
+        fclose(file);
+        ck_assert(!json_tape_map(&mapped, path));
+    }
+    free(corrupt);
+
+    // Offsets that increase while the starts go back point a later edit outside the document.
+    const char* short_json = "[1, \"x\"]   ";
+    JsonTape reordered;
+    build_tape(&reordered, short_json, options);
+    corrupt = malloc(reordered.memory_length);
+    ck_assert_ptr_nonnull(corrupt);
+    memcpy(corrupt, reordered.memory, reordered.memory_length);
+    JsonTapeToken* reordered_tokens = (JsonTapeToken*)(corrupt + JSON_TAPE_HEADER_SIZE);
+    for (size_t i = 0; i < 4; i++) {
+        reordered_tokens[i].consumed = 6 + i;
+    }
+    reordered_tokens[3].start = 2;
+    file = fopen(path, "wb");
+    ck_assert_ptr_nonnull(file);
+    fwrite(corrupt, 1, reordered.memory_length, file);
+    fclose(file);
+    ck_assert(!json_tape_map(&mapped, path));
+    json_tape_free(&reordered);
+    remove(path);
+    free(corrupt);
+
+    // Comments and several top-level values keep their depths.
+    options.comment_handling = JSON_COMMENT_ALLOW;
+    options.allow_multiple_values = true;
+    const char* commented = "/* a */ [1, // b\n {\"c\": /* d */ []} /* e */] // f\n 2 [/* g */]";
+    JsonTape with_comments;
+    build_tape(&with_comments, commented, options);
+    ck_assert(json_tape_save(&with_comments, path));
+    ck_assert(json_tape_map(&mapped, path));
+    compare_replay(commented, &mapped, options);
+    json_tape_free(&mapped);
+    json_tape_free(&with_comments);
+    remove(path);
+    options = json_stream_options_default();
+
+    // A token pointing past the document is caught while replaying, also when its end wraps around.
+    JsonTapeToken tokens[2];
+    JsonTape broken = tape;
+    broken.tokens = tokens;
+    broken.token_count = 2;
+    JsonStream stream;
+    for (size_t wrap = 0; wrap < 2; wrap++) {
+        memcpy(tokens, tape.tokens, sizeof(tokens));
+        tokens[1].start = wrap ? UINT64_MAX : tape.document_length;
+        json_stream_init_tape(&stream, &broken, options);
+        ck_assert(json_read(&stream));
+        ck_assert(!json_read(&stream));
+        ck_assert(expect_error(&stream, JSON_ERROR_INVALID_TAPE));
+        json_stream_free_resources(&stream);
+    }
+
+    // A document that does not tokenize gives no tape.
+    json_stream_init(&stream, "[1, 2", 5, true, options);
+    ck_assert(!json_tape_build(&broken, &stream));
+    ck_assert_int_ne(stream.error.type, JSON_ERROR_NONE);
+    json_stream_free_resources(&stream);
+
+    json_tape_free(&tape);
+}
+END_TEST
+
+// Applies an edit to both the tape and the document, and checks the result against a tape of the edited document.
+// Returns the number of bytes the edit tokenized.
+static size_t check_edit(
+    const char* json,
+    const JsonTape* previous,
+    size_t offset,
+    size_t removed_length,
+    const char* inserted,
+    bool incremental
+) {
+    size_t length = strlen(json);
+    size_t inserted_length = strlen(inserted);
+    size_t edited_length = length - removed_length + inserted_length;
+    char* edited = malloc(edited_length + 1);
+    ck_assert_ptr_nonnull(edited);
+    memcpy(edited, json, offset);
+    memcpy(edited + offset, inserted, inserted_length);
+    memcpy(edited + offset + inserted_length, json + offset + removed_length, length - offset - removed_length + 1);
+
+    JsonStreamOptions options = json_stream_options_default();
+    JsonStream stream;
+    json_stream_init(&stream, edited, edited_length, true, options);
+    JsonTape tape;
+    bool result = json_tape_edit(&tape, previous, &stream, offset, removed_length, inserted_length);
+    // The stream is only read when the whole document is tokenized again.
+    ck_assert(incremental == (json_total_bytes_consumed(&stream) == 0));
+
+    JsonStream full_stream;
+    json_stream_init(&full_stream, edited, edited_length, true, options);
+    JsonTape full;
+    ck_assert(result == json_tape_build(&full, &full_stream));
+    ck_assert_int_eq(stream.error.type, full_stream.error.type);
+    size_t tokenized_length = result ? tape.tokenized_length : 0;
+    if (result) {
+        ck_assert_uint_eq(tape.memory_length, full.memory_length);
+        ck_assert_mem_eq(tape.memory, full.memory, full.memory_length);
+        json_tape_free(&full);
+        json_tape_free(&tape);
+    }
+
+    json_stream_free_resources(&stream);
+    json_stream_free_resources(&full_stream);
+    free(edited);
+    return tokenized_length;
+}
+
+static size_t find_token(const JsonTape* tape, JsonType type, size_t skip) {
+    for (size_t i = 0; i < tape->token_count; i++) {
+        if (tape->tokens[i].type == type && skip-- == 0) {
+            return i;
+        }
+    }
+    ck_assert_msg(false, "token not found");
+    return 0;
+}
+
+START_TEST(json_tape_edits_reuse_the_rest) {
+    char* json = read_json_file("400KB.json");
+    ck_assert_ptr_nonnull(json);
+    JsonTape tape;
+    build_tape(&tape, json, json_stream_options_default());
+
+    const JsonTapeToken* number = &tape.tokens[find_token(&tape, JSON_TYPE_NUMBER, 40)];
+    check_edit(json, &tape, number->start, number->size, "-1234.5e3", true);
+    check_edit(json, &tape, number->start, number->size, "9223372036854775808", true);
+
+    const JsonTapeToken* string = &tape.tokens[find_token(&tape, JSON_TYPE_STRING, 100)];
+    check_edit(json, &tape, string->start, string->size, "escaped \\\" \\u00e9", true);
+    check_edit(json, &tape, string->start - 1, string->size + 2, "{\"nested\": [true, null, {}]}", true);
+
+    const JsonTapeToken* property = &tape.tokens[find_token(&tape, JSON_TYPE_PROPERTY, 7)];
+    check_edit(json, &tape, property->start - 1, 0, "\"added\": [1, 2], ", true);
+
+    // Removing a whole element changes only the outer array.
+    size_t element = find_token(&tape, JSON_TYPE_OBJECT_START, 0);
+    for (size_t skip = 3; skip > 0; skip--) {
+        do {
+            element++;
+        } while (tape.tokens[element].type != JSON_TYPE_OBJECT_START || tape.tokens[element].depth != 1);
+    }
+    size_t element_end = element + 1;
+    while (tape.tokens[element_end].depth != tape.tokens[element].depth) {
+        element_end++;
+    }
+    size_t removed = tape.tokens[element_end + 1].start - tape.tokens[element].start;
+    // Only the bytes from the end of the element before to the end of the one after are tokenized.
+    size_t next_end = element_end + 2;
+    while (tape.tokens[next_end].depth != tape.tokens[element].depth) {
+        next_end++;
+    }
+    size_t span = tape.tokens[next_end].consumed - removed - tape.tokens[element - 1].consumed;
+    ck_assert_uint_eq(check_edit(json, &tape, tape.tokens[element].start, removed, "", true), span);
+    ck_assert_uint_lt(span, strlen(json) / 100);
+
+    // Edits that change a container's extent, its brackets or the text outside the root fall back.
+    size_t array_end = find_token(&tape, JSON_TYPE_ARRAY_END, 2);
+    check_edit(json, &tape, tape.tokens[array_end].start, 1, "", false);
+    check_edit(json, &tape, tape.tokens[array_end].start, 0, "], [", false);
+    check_edit(json, &tape, string->start - 1, 1, "", false);
+    check_edit(json, &tape, 0, 0, " ", false);
+    check_edit(json, &tape, strlen(json), 0, " 1", false);
+
+    json_tape_free(&tape);
+    free(json);
+}
+END_TEST
+
+START_TEST(json_tape_edits_small_documents) {
+    const char* json = "{\"a\": [1, [2, 3], {\"b\": \"c\"}], \"d\": 4}";
+    JsonTape tape;
+    build_tape(&tape, json, json_stream_options_default());
+
+    check_edit(json, &tape, 11, 1, "20", true);
+    check_edit(json, &tape, 11, 0, "0, ", true);
+    check_edit(json, &tape, 10, 6, "[]", true);
+    check_edit(json, &tape, 10, 6, "{}", true);
+    check_edit(json, &tape, 23, 3, "\"", true);
+    check_edit(json, &tape, 36, 1, "[4]", true);
+    check_edit(json, &tape, 10, 1, "{", false);
+    check_edit(json, &tape, 29, 1, "", false);
+    check_edit(json, &tape, 0, 1, "[", false);
+    json_tape_free(&tape);
+
+    // Root-level edits tokenize from the element before to the first element after that lines up.
+    json = "[1, 2, 3, {\"a\": [4]}, \"5\"] ";
+    build_tape(&tape, json, json_stream_options_default());
+    ck_assert_uint_eq(check_edit(json, &tape, 7, 1, "30", true), strlen(", 30, {\"a\": [4]}"));
+    ck_assert_uint_eq(check_edit(json, &tape, 7, 1, "3, 3.5", true), strlen(", 3, 3.5, {\"a\": [4]}"));
+    ck_assert_uint_eq(check_edit(json, &tape, 1, 0, "0, ", true), strlen("0, 1"));
+    ck_assert_uint_eq(check_edit(json, &tape, 25, 0, ", null", true), strlen(", \"5\", null]"));
+    ck_assert_uint_eq(check_edit(json, &tape, 17, 1, "5", true), strlen("5]"));
+    check_edit(json, &tape, 22, 1, "", false);
+    check_edit(json, &tape, 7, 1, "3.e5", false);
+    json_tape_free(&tape);
+
+    // Tokens whose starts go back put the closing bracket before the resume point, and the edit must not read there.
+    json = "[1, \"x\"]   ";
+    build_tape(&tape, json, json_stream_options_default());
+    JsonTapeToken tokens[4];
+    memcpy(tokens, tape.tokens, sizeof(tokens));
+    for (size_t i = 0; i < 4; i++) {
+        tokens[i].consumed = 6 + i;
+    }
+    tokens[3].start = 2;
+    JsonTape broken = tape;
+    broken.tokens = tokens;
+    const char* edited = "[2, \"x\"]   ";
+    JsonStream stream;
+    json_stream_init(&stream, edited, strlen(edited), true, json_stream_options_default());
+    JsonTape result;
+    ck_assert(!json_tape_edit(&result, &broken, &stream, 1, 1, 1));
+    ck_assert(expect_error(&stream, JSON_ERROR_INVALID_TAPE));
+    json_stream_free_resources(&stream);
+    json_tape_free(&tape);
+}
+END_TEST
+
+Suite* json_tape_suite(void) {
+    Suite* suite = suite_create("tape");
+
+    TCase* replay = tcase_create("replay");
+    tcase_add_test(replay, json_tape_replays_tokens);
+    tcase_add_test(replay, json_tape_save_and_map);
+    tcase_add_test(replay, json_tape_rollback_and_skip);
+    tcase_add_test(replay, json_tape_rejects_invalid_files);
+
+    TCase* edits = tcase_create("edits");
+    tcase_add_test(edits, json_tape_edits_reuse_the_rest);
+    tcase_add_test(edits, json_tape_edits_small_documents);
+
+    suite_add_tcase(suite, replay);
+    suite_add_tcase(suite, edits);
+
+    return suite;
+}
@@ -0,0 +1,385 @@
+#include <json_transcode.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "json_tests.h"
+
+typedef struct TranscodeOutput {
+    uint8_t* bytes;
+    size_t length;
+    size_t capacity;
+    size_t writes;
+    size_t fail_after;
+} TranscodeOutput;
+
+static bool collect_output(const void* bytes, size_t length, void* context) {
+    TranscodeOutput* output = context;
+    if (output->fail_after && output->writes == output->fail_after) {
+        return false;
+    }
+
+    if (output->length + length > output->capacity) {
+        output->capacity = (output->length + length) * 2;
+        output->bytes = realloc(output->bytes, output->capacity);
+        ck_assert_ptr_nonnull(output->bytes);
+    }
+    memcpy(output->bytes + output->length, bytes, length);
+    output->length += length;
+    output->writes++;
+    return true;
+}
+
+static uint64_t load_be(const uint8_t* bytes, size_t size) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; i++) {
+        value = value << 8 | bytes[i];
+    }
+    return value;
+}
+
+typedef struct Decoded {
+    JsonType type;
+    const char* text;
+    size_t length;
+    double number;
+    // Entries of a MessagePack container; SIZE_MAX marks an indefinite CBOR container.
+    size_t count;
+} Decoded;
+
+static size_t cbor_argument(const uint8_t* bytes, size_t* position) {
+    uint8_t info = bytes[(*position)++] & 0x1F;
+    if (info < 24) {
+        return info;
+    }
+    size_t size = (size_t)1 << (info - 24);
+    uint64_t value = load_be(bytes + *position, size);
+    *position += size;
+    return (size_t)value;
+}
+
+static Decoded decode_cbor(const uint8_t* bytes, size_t* position) {
+    uint8_t lead = bytes[*position];
+    switch (lead) {
+        case 0x9F:
+            (*position)++;
+            return (Decoded){.type = JSON_TYPE_ARRAY_START, .count = SIZE_MAX};
+        case 0xBF:
+            (*position)++;
+            return (Decoded){.type = JSON_TYPE_OBJECT_START, .count = SIZE_MAX};
+        case 0xF4:
+        case 0xF5:
+            (*position)++;
+            return (Decoded){.type = JSON_TYPE_BOOLEAN, .number = lead == 0xF5};
+        case 0xF6:
+            (*position)++;
+            return (Decoded){.type = JSON_TYPE_NULL};
+        case 0xFB: {
+            uint64_t bits = load_be(bytes + *position + 1, 8);
+            *position += 9;
+            double value;
+            memcpy(&value, &bits, sizeof(value));
+            return (Decoded){.type = JSON_TYPE_NUMBER, .number = value};
+        }
+        default:
+            break;
+    }
+
+    uint8_t major = lead >> 5;
+    size_t argument = cbor_argument(bytes, position);
+    if (major == 3) {
+        Decoded text = {.type = JSON_TYPE_STRING, .text = (const char*)bytes + *position, .length = argument};
+        *position += argument;
+        return text;
+    }
+    ck_assert(major == 0 || major == 1);
+    return (Decoded){.type = JSON_TYPE_NUMBER, .number = major == 0 ? (double)argument : -1.0 - (double)argument};
+}
+
+static Decoded decode_msgpack(const uint8_t* bytes, size_t* position) {
+    uint8_t lead = bytes[(*position)++];
+    if (lead < 0x80 || lead >= 0xE0) {
+        return (Decoded){.type = JSON_TYPE_NUMBER, .number = (int8_t)lead};
+    }
+    if ((lead & 0xF0) == 0x80 || (lead & 0xF0) == 0x90) {
+        JsonType type = (lead & 0xF0) == 0x80 ? JSON_TYPE_OBJECT_START : JSON_TYPE_ARRAY_START;
+        return (Decoded){.type = type, .count = lead & 0x0F};
+    }
+
+    size_t size = 0;
+    switch (lead) {
+        case 0xC0:
+            return (Decoded){.type = JSON_TYPE_NULL};
+        case 0xC2:
+        case 0xC3:
+            return (Decoded){.type = JSON_TYPE_BOOLEAN, .number = lead == 0xC3};
+        case 0xCB: {
+            uint64_t bits = load_be(bytes + *position, 8);
+            *position += 8;
+            double value;
+            memcpy(&value, &bits, sizeof(value));
+            return (Decoded){.type = JSON_TYPE_NUMBER, .number = value};
+        }
+        case 0xCC:
+        case 0xCD:
+        case 0xCE:
+        case 0xCF:
+            size = (size_t)1 << (lead - 0xCC);
+            *position += size;
+            return (Decoded){.type = JSON_TYPE_NUMBER, .number = (double)load_be(bytes + *position - size, size)};
+        case 0xD0:
+        case 0xD1:
+        case 0xD2:
+        case 0xD3: {
+            size = (size_t)1 << (lead - 0xD0);
+            uint64_t value = load_be(bytes + *position, size);
+            *position += size;
+            int64_t extended = (int64_t)(value << (64 - 8 * size)) >> (64 - 8 * size);
+            return (Decoded){.type = JSON_TYPE_NUMBER, .number = (double)extended};
+        }
+        case 0xDC:
+        case 0xDE:
+            *position += 2;
+            return (Decoded){
+                .type = lead == 0xDE ? JSON_TYPE_OBJECT_START : JSON_TYPE_ARRAY_START,
+                .count = load_be(bytes + *position - 2, 2),
+            };
+        case 0xDD:
+        case 0xDF:
+            *position += 4;
+            return (Decoded){
+                .type = lead == 0xDF ? JSON_TYPE_OBJECT_START : JSON_TYPE_ARRAY_START,
+                .count = load_be(bytes + *position - 4, 4),
+            };
+        default:
+            break;
+    }
+
+    size_t length;
+    if ((lead & 0xE0) == 0xA0) {
+        length = lead & 0x1F;
+    } else {
+        ck_assert(lead >= 0xD9 && lead <= 0xDB);
+        size = (size_t)1 << (lead - 0xD9);
+        length = load_be(bytes + *position, size);
+        *position += size;
+    }
+    Decoded text = {.type = JSON_TYPE_STRING, .text = (const char*)bytes + *position, .length = length};
+    *position += length;
+    return text;
+}
+
+static void expect_token(JsonStream* stream, JsonType type, const Decoded* decoded) {
+    ck_assert(json_read(stream));
+    ck_assert_int_eq(json_token_type(stream), type);
+    if (type == JSON_TYPE_PROPERTY || type == JSON_TYPE_STRING) {
+        ck_assert(json_text_equals(stream, decoded->text, decoded->length));
+    } else if (type == JSON_TYPE_NUMBER) {
+        double expected = json_get_double(stream);
+        ck_assert(expected == decoded->number || fabs(expected - decoded->number) <= fabs(expected) * 1e-15);
+    } else if (type == JSON_TYPE_BOOLEAN) {
+        ck_assert(json_get_bool(stream) == (decoded->number != 0));
+    }
+}
+
+// Walks one encoded value and checks it against the tokens of the original document.
+static void compare_value(JsonStream* stream, const uint8_t* bytes, size_t* position, bool cbor, bool is_property) {
+    Decoded decoded = cbor ? decode_cbor(bytes, position) : decode_msgpack(bytes, position);
+    JsonType type = is_property ? JSON_TYPE_PROPERTY : decoded.type;
+    expect_token(stream, type, &decoded);
+    if (type != JSON_TYPE_OBJECT_START && type != JSON_TYPE_ARRAY_START) {
+        return;
+    }
+
+    bool is_object = type == JSON_TYPE_OBJECT_START;
+    for (size_t i = 0; i < decoded.count; i++) {
+        if (cbor && bytes[*position] == 0xFF) {
+            (*position)++;
+            break;
+        }
+        if (is_object) {
+            compare_value(stream, bytes, position, cbor, true);
+        }
+        compare_value(stream, bytes, position, cbor, false);
+    }
+    ck_assert(json_read(stream));
+    ck_assert_int_eq(json_token_type(stream), is_object ? JSON_TYPE_OBJECT_END : JSON_TYPE_ARRAY_END);
+}
+
+static void compare_transcoded(const char* json, const TranscodeOutput* output, bool cbor) {
+    JsonStreamOptions options = json_stream_options_default();
+    options.allow_multiple_values = true;
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, options);
+    size_t position = 0;
+    while (position < output->length) {
+        compare_value(&stream, output->bytes, &position, cbor, false);
+    }
+    ck_assert_uint_eq(position, output->length);
+    ck_assert(!json_read(&stream));
+    ck_assert(expect_success(&stream));
+    json_stream_free_resources(&stream);
+}
+
+static TranscodeOutput transcode_chunked(const char* json, JsonTranscodeFormat format, size_t window) {
+    size_t length = strlen(json);
+    JsonStreamOptions options = json_stream_options_default();
+    options.allow_multiple_values = true;
+    TranscodeOutput output = {0};
+    JsonTranscoder transcoder;
+    json_transcoder_init(&transcoder, format, collect_output, &output);
+
+    size_t end = window < length ? window : length;
+    JsonStream stream;
+    json_stream_init(&stream, json, end, end == length, options);
+    for (;;) {
+        ck_assert(json_transcode(&transcoder, &stream));
+        if (end == length) {
+            break;
+        }
+        size_t offset = json_total_bytes_consumed(&stream);
+        end = end + window < length ? end + window : length;
+        json_stream_continue(&stream, &stream, json + offset, end - offset, end == length);
+    }
+    ck_assert_uint_eq(transcoder.depth, 0);
+    ck_assert_uint_eq(transcoder.output_length, 0);
+
+    json_stream_free_resources(&stream);
+    json_transcoder_free(&transcoder);
+    return output;
+}
+
+START_TEST(json_transcode_small_document) {
+    const char* json = "{\"a\": [1, -1, 24, -25, 256, 1.5, true, false, null, \"xy\"], \"b\\u00e9\": {}} // done";
+    JsonStreamOptions options = json_stream_options_default();
+    options.comment_handling = JSON_COMMENT_SKIP;
+
+    static const uint8_t cbor[] = {
+        0xBF, 0x61, 'a', 0x9F, 0x01, 0x20, 0x18, 0x18, 0x38, 0x18, 0x19, 0x01, 0x00, 0xFB, 0x3F, 0xF8, 0, 0, 0, 0, 0, 0,
+        0xF5, 0xF4, 0xF6, 0x62, 'x', 'y', 0xFF, 0x63, 'b', 0xC3, 0xA9, 0xBF, 0xFF, 0xFF,
+    };
+    static const uint8_t msgpack[] = {
+        0x82, 0xA1, 'a', 0x9A, 0x01, 0xFF, 0x18, 0xE7, 0xCD, 0x01, 0x00, 0xCB, 0x3F, 0xF8, 0, 0, 0, 0, 0, 0,
+        0xC3, 0xC2, 0xC0, 0xA2, 'x', 'y', 0xA3, 'b', 0xC3, 0xA9, 0x80,
+    };
+
+    TranscodeOutput output = {0};
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, options);
+    ck_assert(json_transcode_to_cbor(&stream, collect_output, &output));
+    ck_assert_uint_eq(output.length, sizeof(cbor));
+    ck_assert_mem_eq(output.bytes, cbor, sizeof(cbor));
+    json_stream_free_resources(&stream);
+
+    output.length = 0;
+    json_stream_init(&stream, json, strlen(json), true, options);
+    ck_assert(json_transcode_to_msgpack(&stream, collect_output, &output));
+    ck_assert_uint_eq(output.length, sizeof(msgpack));
+    ck_assert_mem_eq(output.bytes, msgpack, sizeof(msgpack));
+    json_stream_free_resources(&stream);
+    free(output.bytes);
+}
+END_TEST
+
+START_TEST(json_transcode_matches_tokens) {
+    const char* files[] = {"400KB.json", "lots_of_numbers.json", "lots_of_strings.json", "deep_tree.json"};
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+        char* json = read_json_file(files[i]);
+        ck_assert_ptr_nonnull(json);
+
+        for (size_t format = 0; format < 2; format++) {
+            bool cbor = format == JSON_TRANSCODE_CBOR;
+            TranscodeOutput whole = transcode_chunked(json, format, SIZE_MAX);
+            compare_transcoded(json, &whole, cbor);
+
+            TranscodeOutput chunked = transcode_chunked(json, format, 997);
+            ck_assert_uint_eq(chunked.length, whole.length);
+            ck_assert_mem_eq(chunked.bytes, whole.bytes, whole.length);
+            if (cbor) {
+                // Indefinite lengths let the output go out while the document is still open.
+                ck_assert_uint_gt(chunked.writes, whole.length / (2 * JSON_TRANSCODE_FLUSH_SIZE));
+            }
+            free(whole.bytes);
+            free(chunked.bytes);
+        }
+        free(json);
+    }
+}
+END_TEST
+
+START_TEST(json_transcode_container_headers) {
+    // Counts past the fixed-size headers take the 16 and 32-bit forms.
+    size_t counts[] = {15, 16, 65535, 65536};
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        size_t count = counts[i];
+        char* json = malloc(count * 2 + 3);
+        ck_assert_ptr_nonnull(json);
+        size_t length = 0;
+        json[length++] = '[';
+        for (size_t j = 0; j < count; j++) {
+            json[length++] = j ? ',' : '7';
+            if (j) {
+                json[length++] = '7';
+            }
+        }
+        json[length++] = ']';
+        json[length] = '\0';
+
+        TranscodeOutput output = transcode_chunked(json, JSON_TRANSCODE_MSGPACK, SIZE_MAX);
+        size_t header = count < 16 ? 1 : count <= 65535 ? 3 : 5;
+        ck_assert_uint_eq(output.length, header + count);
+        compare_transcoded(json, &output, false);
+        free(output.bytes);
+        free(json);
+    }
+}
+END_TEST
+
+START_TEST(json_transcode_reports_failures) {
+    char* json = read_json_file("400KB.json");
+    ck_assert_ptr_nonnull(json);
+    TranscodeOutput output = {.fail_after = 2};
+    JsonStream stream;
+    json_stream_init(&stream, json, strlen(json), true, json_stream_options_default());
+    ck_assert(!json_transcode_to_cbor(&stream, collect_output, &output));
+    ck_assert(expect_error(&stream, JSON_ERROR_WRITE_FAILED));
+    ck_assert_uint_eq(output.writes, 2);
+    json_stream_free_resources(&stream);
+    free(output.bytes);
+    free(json);
+
+    output = (TranscodeOutput){0};
+    json_stream_init(&stream, "[1, \"a\\x\"]", 10, true, json_stream_options_default());
+    ck_assert(!json_transcode_to_msgpack(&stream, collect_output, &output));
+    ck_assert(!expect_success(&stream));
+    ck_assert_uint_eq(output.length, 0);
+    json_stream_free_resources(&stream);
+
+    // A number that overflows a double is not written as infinity.
+    const char* overflows[] = {"[1, 1e400]", "{\"a\": -18e307}", "123456789012345678901234567890e300"};
+    for (size_t i = 0; i < sizeof(overflows) / sizeof(overflows[0]); i++) {
+        for (size_t cbor = 0; cbor < 2; cbor++) {
+            json_stream_init(&stream, overflows[i], strlen(overflows[i]), true, json_stream_options_default());
+            ck_assert(!(cbor ? json_transcode_to_cbor : json_transcode_to_msgpack)(&stream, collect_output, &output));
+            ck_assert(expect_error(&stream, JSON_ERROR_INVALID_OPERATION_EXPECTED_DOUBLE));
+            ck_assert_uint_eq(output.length, 0);
+            json_stream_free_resources(&stream);
+        }
+    }
+    free(output.bytes);
+}
+END_TEST
+
+Suite* json_transcode_suite(void) {
+    Suite* suite = suite_create("transcode");
+
+    TCase* formats = tcase_create("formats");
+    tcase_add_test(formats, json_transcode_small_document);
+    tcase_add_test(formats, json_transcode_matches_tokens);
+    tcase_add_test(formats, json_transcode_container_headers);
+    tcase_add_test(formats, json_transcode_reports_failures);
+
+    suite_add_tcase(suite, formats);
+
+    return suite;
+}
@@ -19,10 +19,30 @@ int main(void) {
     Suite* core_suite = json_core_suite();
     Suite* buffered_suite = json_buffered_suite();
     Suite* files_suite = json_files_suite();
+    Suite* strings_suite = json_strings_suite();
+    Suite* binding_suite = json_binding_suite();
+    Suite* schema_suite = json_schema_suite();
+    Suite* path_suite = json_path_suite();
+    Suite* push_suite = json_push_suite();
+    Suite* file_reader_suite = json_file_reader_suite();
+    Suite* decompress_suite = json_decompress_suite();
+    Suite* transcode_suite = json_transcode_suite();
+    Suite* tape_suite = json_tape_suite();
+    Suite* split_suite = json_split_suite();
     SRunner* runner = srunner_create(core_suite);
 
     srunner_add_suite(runner, buffered_suite);
     srunner_add_suite(runner, files_suite);
+    srunner_add_suite(runner, strings_suite);
+    srunner_add_suite(runner, binding_suite);
+    srunner_add_suite(runner, schema_suite);
+    srunner_add_suite(runner, path_suite);
+    srunner_add_suite(runner, push_suite);
+    srunner_add_suite(runner, file_reader_suite);
+    srunner_add_suite(runner, decompress_suite);
+    srunner_add_suite(runner, transcode_suite);
+    srunner_add_suite(runner, tape_suite);
+    srunner_add_suite(runner, split_suite);
 
     srunner_set_fork_status(runner, CK_NOFORK);
 
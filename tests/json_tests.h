@@ -12,6 +12,16 @@
 Suite* json_core_suite(void);
 Suite* json_files_suite(void);
 Suite* json_buffered_suite(void);
+Suite* json_strings_suite(void);
+Suite* json_binding_suite(void);
+Suite* json_schema_suite(void);
+Suite* json_path_suite(void);
+Suite* json_push_suite(void);
+Suite* json_file_reader_suite(void);
+Suite* json_decompress_suite(void);
+Suite* json_transcode_suite(void);
+Suite* json_tape_suite(void);
+Suite* json_split_suite(void);
 
 bool expect_success(JsonStream* stream);
 bool expect_error(JsonStream* stream, JsonErrorType error);
@@ -19,6 +29,30 @@ bool compare_full_buffer_to_cjson(const char* buffer, JsonStreamOptions options)
 char* read_json_file(const char* filename);
 char* compact_json_file(const char* filename);
 
+// A token as json_read produced it, with start an offset into the whole document rather than the current buffer.
+typedef struct TokenRecord {
+    JsonType type;
+    size_t start;
+    size_t size;
+    size_t line;
+    size_t position;
+} TokenRecord;
+
+// Reads the stream until json_read stops, appending to the count tokens already recorded. Tokens past capacity are
+// counted but not stored. Returns the new count.
+size_t record_tokens(JsonStream* stream, TokenRecord* records, size_t count, size_t capacity);
+
+// Asserts that both recordings hold the same tokens, comparing the stored ones. Line and position are compared only
+// when compare_lines is set.
+void compare_tokens(
+    const TokenRecord* actual,
+    size_t actual_count,
+    const TokenRecord* expected,
+    size_t expected_count,
+    size_t capacity,
+    bool compare_lines
+);
+
 typedef struct CompactTestCase {
   bool compact;
   char* name;
@@ -5,6 +5,7 @@
 #include <cJSON.h>
 #include <check.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "json_tests.h"
 
@@ -29,6 +30,17 @@ static bool compare_array(JsonStream* stream, const cJSON* cjson) {
     return false;
 }
 
+// The property text is not NUL-terminated when it points into the buffer.
+static const cJSON* find_property(const cJSON* cjson, const char* name, size_t length) {
+    const cJSON* item;
+    cJSON_ArrayForEach(item, cjson) {
+        if (item->string && strlen(item->string) == length && memcmp(item->string, name, length) == 0) {
+            return item;
+        }
+    }
+    return NULL;
+}
+
 // NOLINTNEXTLINE(*-no-recursion)
 static bool compare_object(JsonStream* stream, const cJSON* cjson) {
     while (json_read(stream)) {
@@ -36,18 +48,16 @@ static bool compare_object(JsonStream* stream, const cJSON* cjson) {
             return true;
         }
 
-        char* property;
+        const char* property;
         size_t length;
 
         ck_assert(json_token_type(stream) == JSON_TYPE_PROPERTY);
-        ck_assert(json_try_get_string_escaped(stream, NULL, 0, &property, &length));
+        ck_assert(json_try_get_text(stream, &property, &length));
         ck_assert(json_read(stream));
 
-        cJSON* value = cJSON_GetObjectItemCaseSensitive(cjson, property);
+        const cJSON* value = find_property(cjson, property, length);
         ck_assert(value != NULL);
-        bool result = compare_token(stream, value);
-        free(property);
-        if (!result) {
+        if (!compare_token(stream, value)) {
             return false;
         }
     }
@@ -75,14 +85,13 @@ static bool compare_token(JsonStream* stream, const cJSON* cjson) {
             return value == cJSON_GetNumberValue(cjson);
         }
         case JSON_TYPE_STRING: {
-            char* value;
+            const char* value;
             size_t length;
-            ck_assert(json_try_get_string_escaped(stream, NULL, 0, &value, &length));
+            ck_assert(json_try_get_text(stream, &value, &length));
             ck_assert(cJSON_IsString(cjson));
-            char* cjson_string = cJSON_GetStringValue(cjson);
-            bool result = strcmp(cjson_string, value) == 0;
-            ck_assert_str_eq(cjson_string, value);
-            free(value);
+            const char* cjson_string = cJSON_GetStringValue(cjson);
+            bool result = strlen(cjson_string) == length && memcmp(cjson_string, value, length) == 0;
+            ck_assert_msg(result, "Expected \"%s\", got \"%.*s\"", cjson_string, (int)length, value);
             return result;
         }
         case JSON_TYPE_ARRAY_START: {
@@ -115,3 +124,39 @@ bool compare_full_buffer_to_cjson(const char* buffer, JsonStreamOptions options)
 
     return result;
 }
+
+size_t record_tokens(JsonStream* stream, TokenRecord* records, size_t count, size_t capacity) {
+    while (json_read(stream)) {
+        if (count < capacity) {
+            records[count] = (TokenRecord){
+                .type = json_token_type(stream),
+                .start = json_total_bytes_consumed(stream) - json_bytes_consumed(stream) + json_token_start(stream),
+                .size = json_token_size(stream),
+                .line = stream->line_number,
+                .position = stream->byte_position_in_line,
+            };
+        }
+        count++;
+    }
+    return count;
+}
+
+void compare_tokens(
+    const TokenRecord* actual,
+    size_t actual_count,
+    const TokenRecord* expected,
+    size_t expected_count,
+    size_t capacity,
+    bool compare_lines
+) {
+    ck_assert_uint_eq(actual_count, expected_count);
+    for (size_t i = 0; i < actual_count && i < capacity; i++) {
+        ck_assert_int_eq(actual[i].type, expected[i].type);
+        ck_assert_uint_eq(actual[i].start, expected[i].start);
+        ck_assert_uint_eq(actual[i].size, expected[i].size);
+        if (compare_lines) {
+            ck_assert_uint_eq(actual[i].line, expected[i].line);
+            ck_assert_uint_eq(actual[i].position, expected[i].position);
+        }
+    }
+}
@@ -0,0 +1,837 @@
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "json_schema.h"
+#include "json_stream.h"
+
+// Generates C structs and specialized readers from a JSON Schema:
+//
+//     json_codegen <schema.json> <output.h> <output.c> [TypeName]
+//
+// Every object schema becomes a struct with a reader that dispatches keys through a switch on the key length
+// followed by memcmp, so no descriptor is interpreted at runtime. Integer widths come from "format" (int8 ... uint64)
+// or from the minimum/maximum range, "number" maps to double unless "format" is "float", and string enums become C
+// enums. Properties the generator cannot map (arrays of arrays, mixed types) are validated as present but skipped.
+
+typedef enum {
+    CODEGEN_UNSUPPORTED,
+    CODEGEN_BOOL,
+    CODEGEN_INTEGER,
+    CODEGEN_NUMBER,
+    CODEGEN_STRING,
+    CODEGEN_ENUM,
+    CODEGEN_OBJECT,
+    CODEGEN_ARRAY,
+} CodegenKind;
+
+typedef struct CodegenValue {
+    CodegenKind kind;
+    const JsonSchema* schema;
+    bool nullable;
+    // C type of the value, or of one element for arrays.
+    char type[256];
+    const char* getter;
+    // Function prefix of the generated object reader or enum matcher.
+    char prefix[256];
+    struct CodegenValue* item;
+} CodegenValue;
+
+typedef struct Codegen {
+    FILE* header;
+    FILE* source;
+} Codegen;
+
+static const char* const codegen_keywords[] = {
+    "auto",   "bool",     "break",  "case",     "char",   "const",    "continue", "default",  "do",
+    "double", "else",     "enum",   "extern",   "false",  "float",    "for",      "goto",     "if",
+    "inline", "int",      "long",   "register", "return", "short",    "signed",   "sizeof",   "static",
+    "struct", "switch",   "true",   "typedef",  "union",  "unsigned", "void",     "volatile", "while",
+};
+
+static void codegen_identifier(const char* name, char* out, size_t out_size) {
+    size_t length = 0;
+    if (!isalpha((unsigned char)name[0]) && name[0] != '_') {
+        out[length++] = '_';
+    }
+
+    for (const char* c = name; *c && length + 2 < out_size; c++) {
+        out[length++] = isalnum((unsigned char)*c) ? *c : '_';
+    }
+    out[length] = '\0';
+
+    for (size_t i = 0; i < sizeof(codegen_keywords) / sizeof(codegen_keywords[0]); i++) {
+        if (strcmp(out, codegen_keywords[i]) == 0) {
+            out[length++] = '_';
+            out[length] = '\0';
+            break;
+        }
+    }
+}
+
+static void codegen_camel_case(const char* prefix, const char* name, char* out, size_t out_size) {
+    size_t length = strlen(prefix) < out_size - 1 ? strlen(prefix) : out_size - 1;
+    memcpy(out, prefix, length);
+
+    bool upper = true;
+    for (const char* c = name; *c && length + 1 < out_size; c++) {
+        if (!isalnum((unsigned char)*c)) {
+            upper = true;
+            continue;
+        }
+        out[length++] = upper ? (char)toupper((unsigned char)*c) : *c;
+        upper = false;
+    }
+    out[length] = '\0';
+}
+
+static void codegen_snake_case(const char* name, char* out, size_t out_size) {
+    size_t length = 0;
+    for (const char* c = name; *c && length + 2 < out_size; c++) {
+        if (isupper((unsigned char)*c)) {
+            if (length > 0 && out[length - 1] != '_' && !isupper((unsigned char)c[-1])) {
+                out[length++] = '_';
+            }
+            out[length++] = (char)tolower((unsigned char)*c);
+        } else {
+            out[length++] = isalnum((unsigned char)*c) ? *c : '_';
+        }
+    }
+    out[length] = '\0';
+}
+
+static void codegen_upper_case(const char* name, char* out, size_t out_size) {
+    codegen_snake_case(name, out, out_size);
+    for (char* c = out; *c; c++) {
+        *c = (char)toupper((unsigned char)*c);
+    }
+}
+
+// Emits a C string literal. Octal escapes always use three digits so they cannot absorb the next character.
+static void codegen_string_literal(FILE* file, const char* text, size_t length) {
+    fputc('"', file);
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)text[i];
+        if (c == '"' || c == '\\') {
+            fprintf(file, "\\%c", c);
+        } else if (c < 0x20 || c >= 0x7F || c == '?') {
+            fprintf(file, "\\%03o", c);
+        } else {
+            fputc(c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+static void codegen_integer_type(const JsonSchema* schema, CodegenValue* value) {
+    static const struct {
+        const char* format;
+        const char* type;
+        const char* getter;
+        double minimum;
+        double maximum;
+    } widths[] = {
+        {"uint8", "uint8_t", "json_get_u8", 0, 255.0},
+        {"int8", "int8_t", "json_get_i8", -128.0, 127.0},
+        {"uint16", "uint16_t", "json_get_u16", 0, 65535.0},
+        {"int16", "int16_t", "json_get_i16", -32768.0, 32767.0},
+        {"uint32", "uint32_t", "json_get_u32", 0, 4294967295.0},
+        {"int32", "int32_t", "json_get_i32", -2147483648.0, 2147483647.0},
+        {"uint64", "uint64_t", "json_get_u64", 0, 18446744073709551615.0},
+        {"int64", "int64_t", "json_get_i64", -9223372036854775808.0, 9223372036854775807.0},
+    };
+    size_t count = sizeof(widths) / sizeof(widths[0]);
+    size_t selected = count - 1;
+
+    if (schema->format) {
+        for (size_t i = 0; i < count; i++) {
+            if (strcmp(schema->format, widths[i].format) == 0) {
+                selected = i;
+                break;
+            }
+        }
+    } else if (schema->has_minimum && schema->has_maximum) {
+        for (size_t i = 0; i < count; i++) {
+            if (schema->minimum >= widths[i].minimum && schema->maximum <= widths[i].maximum) {
+                selected = i;
+                break;
+            }
+        }
+    } else if (schema->has_minimum && schema->minimum >= 0) {
+        selected = count - 2;
+    }
+
+    snprintf(value->type, sizeof(value->type), "%s", widths[selected].type);
+    value->getter = widths[selected].getter;
+}
+
+static bool codegen_is_string_enum(const JsonSchema* schema) {
+    if (schema->enum_count == 0) {
+        return false;
+    }
+
+    for (size_t i = 0; i < schema->enum_count; i++) {
+        if (schema->enum_values[i].type != JSON_TYPE_STRING) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void codegen_classify(const JsonSchema* schema, const char* type_name, CodegenValue* value) {
+    *value = (CodegenValue){.kind = CODEGEN_UNSUPPORTED, .schema = schema};
+    if (!schema) {
+        return;
+    }
+
+    unsigned types = schema->types;
+    value->nullable = (types & JSON_SCHEMA_NULL) != 0;
+    types &= ~JSON_SCHEMA_NULL;
+    if (types & JSON_SCHEMA_NUMBER) {
+        // Every integer is also a number.
+        types &= ~JSON_SCHEMA_INTEGER;
+    }
+
+    switch (types) {
+        case JSON_SCHEMA_BOOLEAN:
+            value->kind = CODEGEN_BOOL;
+            snprintf(value->type, sizeof(value->type), "bool");
+            value->getter = "json_get_bool";
+            break;
+        case JSON_SCHEMA_INTEGER:
+            value->kind = CODEGEN_INTEGER;
+            codegen_integer_type(schema, value);
+            break;
+        case JSON_SCHEMA_NUMBER: {
+            bool single = schema->format && strcmp(schema->format, "float") == 0;
+            value->kind = CODEGEN_NUMBER;
+            snprintf(value->type, sizeof(value->type), "%s", single ? "float" : "double");
+            value->getter = single ? "json_get_float" : "json_get_double";
+            break;
+        }
+        case JSON_SCHEMA_STRING:
+            if (codegen_is_string_enum(schema)) {
+                value->kind = CODEGEN_ENUM;
+                snprintf(value->type, sizeof(value->type), "%s", type_name);
+                codegen_snake_case(type_name, value->prefix, sizeof(value->prefix));
+            } else {
+                value->kind = CODEGEN_STRING;
+                snprintf(value->type, sizeof(value->type), "char*");
+            }
+            break;
+        case JSON_SCHEMA_OBJECT:
+            value->kind = CODEGEN_OBJECT;
+            snprintf(value->type, sizeof(value->type), "%s", type_name);
+            codegen_snake_case(type_name, value->prefix, sizeof(value->prefix));
+            break;
+        case JSON_SCHEMA_ARRAY: {
+            char item_name[256];
+            snprintf(item_name, sizeof(item_name), "%sItem", type_name);
+
+            CodegenValue* item = malloc(sizeof(CodegenValue));
+            if (!item) {
+                break;
+            }
+            codegen_classify(schema->items, item_name, item);
+            if (item->kind == CODEGEN_UNSUPPORTED || item->kind == CODEGEN_ARRAY) {
+                free(item);
+                break;
+            }
+
+            value->kind = CODEGEN_ARRAY;
+            value->item = item;
+            snprintf(value->type, sizeof(value->type), "%s", item->type);
+            codegen_snake_case(type_name, value->prefix, sizeof(value->prefix));
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static void codegen_release(const CodegenValue* value) {
+    if (value->item) {
+        free(value->item);
+    }
+}
+
+static void codegen_emit_types(Codegen* codegen, const JsonSchema* schema, const char* type_name);
+
+static void codegen_emit_readers(Codegen* codegen, const JsonSchema* schema, const char* type_name, bool root);
+
+static void codegen_emit_enum_type(Codegen* codegen, const CodegenValue* value) {
+    char constant_prefix[256];
+    codegen_upper_case(value->type, constant_prefix, sizeof(constant_prefix));
+
+    fprintf(codegen->header, "typedef enum %s {\n", value->type);
+    for (size_t i = 0; i < value->schema->enum_count; i++) {
+        char constant[256];
+        codegen_upper_case(value->schema->enum_values[i].text, constant, sizeof(constant));
+        char identifier[512];
+        snprintf(identifier, sizeof(identifier), "%s_%s", constant_prefix, constant);
+        codegen_identifier(identifier, constant, sizeof(constant));
+        fprintf(codegen->header, "    %s,\n", constant);
+    }
+    fprintf(codegen->header, "} %s;\n\n", value->type);
+}
+
+static void codegen_emit_enum_reader(Codegen* codegen, const CodegenValue* value) {
+    FILE* out = codegen->source;
+    char constant_prefix[256];
+    codegen_upper_case(value->type, constant_prefix, sizeof(constant_prefix));
+
+    fprintf(out, "static bool %s_read(JsonStream* stream, %s* out) {\n", value->prefix, value->type);
+    fprintf(out, "    if (json_token_type(stream) != JSON_TYPE_STRING) {\n");
+    fprintf(out, "        json_raise_error(\n");
+    fprintf(out, "            stream,\n");
+    fprintf(out, "            JSON_ERROR_INVALID_OPERATION_EXPECTED_STRING,\n");
+    fprintf(out, "            json_token_type_name(json_token_type(stream))\n");
+    fprintf(out, "        );\n");
+    fprintf(out, "        return false;\n");
+    fprintf(out, "    }\n\n");
+    fprintf(out, "    const char* text;\n");
+    fprintf(out, "    size_t length;\n");
+    fprintf(out, "    json_token(stream, &text, &length);\n\n");
+    fprintf(out, "    if (!json_value_is_escaped(stream)) {\n");
+    fprintf(out, "        switch (length) {\n");
+
+    size_t max_length = 0;
+    for (size_t i = 0; i < value->schema->enum_count; i++) {
+        if (value->schema->enum_values[i].length > max_length) {
+            max_length = value->schema->enum_values[i].length;
+        }
+    }
+
+    for (size_t length = 0; length <= max_length; length++) {
+        bool any = false;
+        for (size_t i = 0; i < value->schema->enum_count; i++) {
+            const JsonSchemaEnumValue* option = &value->schema->enum_values[i];
+            if (option->length != length) {
+                continue;
+            }
+            if (!any) {
+                fprintf(out, "            case %zu:\n", length);
+                any = true;
+            }
+
+            char constant[256];
+            char identifier[512];
+            codegen_upper_case(option->text, constant, sizeof(constant));
+            snprintf(identifier, sizeof(identifier), "%s_%s", constant_prefix, constant);
+            codegen_identifier(identifier, constant, sizeof(constant));
+
+            fprintf(out, "                if (memcmp(text, ");
+            codegen_string_literal(out, option->text, option->length);
+            fprintf(out, ", %zu) == 0) {\n", length);
+            fprintf(out, "                    *out = %s;\n", constant);
+            fprintf(out, "                    return true;\n");
+            fprintf(out, "                }\n");
+        }
+        if (any) {
+            fprintf(out, "                break;\n");
+        }
+    }
+
+    fprintf(out, "        }\n");
+    fprintf(out, "    } else {\n");
+    for (size_t i = 0; i < value->schema->enum_count; i++) {
+        const JsonSchemaEnumValue* option = &value->schema->enum_values[i];
+        char constant[256];
+        char identifier[512];
+        codegen_upper_case(option->text, constant, sizeof(constant));
+        snprintf(identifier, sizeof(identifier), "%s_%s", constant_prefix, constant);
+        codegen_identifier(identifier, constant, sizeof(constant));
+
+        fprintf(out, "        if (json_text_equals(stream, ");
+        codegen_string_literal(out, option->text, option->length);
+        fprintf(out, ", %zu)) {\n", option->length);
+        fprintf(out, "            *out = %s;\n", constant);
+        fprintf(out, "            return true;\n");
+        fprintf(out, "        }\n");
+    }
+    fprintf(out, "    }\n\n");
+    fprintf(out, "    if (stream->error.type == JSON_ERROR_NONE) {\n");
+    fprintf(out, "        json_raise_error(stream, JSON_ERROR_SCHEMA_VIOLATION, \"enum\");\n");
+    fprintf(out, "    }\n");
+    fprintf(out, "    return false;\n");
+    fprintf(out, "}\n\n");
+}
+
+// Emits the declarations a value depends on, before the struct that contains it.
+static void codegen_emit_dependencies(Codegen* codegen, const CodegenValue* value, bool readers) {
+    const CodegenValue* target = value->kind == CODEGEN_ARRAY ? value->item : value;
+    if (target->kind == CODEGEN_ENUM) {
+        if (readers) {
+            codegen_emit_enum_reader(codegen, target);
+        } else {
+            codegen_emit_enum_type(codegen, target);
+        }
+    } else if (target->kind == CODEGEN_OBJECT) {
+        if (readers) {
+            codegen_emit_readers(codegen, target->schema, target->type, false);
+        } else {
+            codegen_emit_types(codegen, target->schema, target->type);
+        }
+    }
+}
+
+static bool codegen_has_flag(const CodegenValue* value, const JsonSchemaProperty* property) {
+    return !property->required && value->kind != CODEGEN_STRING && value->kind != CODEGEN_ARRAY;
+}
+
+static void codegen_emit_types(Codegen* codegen, const JsonSchema* schema, const char* type_name) {
+    for (size_t i = 0; i < schema->property_count; i++) {
+        char nested_name[256];
+        codegen_camel_case(type_name, schema->properties[i].name, nested_name, sizeof(nested_name));
+
+        CodegenValue value;
+        codegen_classify(schema->properties[i].schema, nested_name, &value);
+        codegen_emit_dependencies(codegen, &value, false);
+        codegen_release(&value);
+    }
+
+    fprintf(codegen->header, "typedef struct %s {\n", type_name);
+    size_t emitted = 0;
+    for (size_t i = 0; i < schema->property_count; i++) {
+        const JsonSchemaProperty* property = &schema->properties[i];
+        char nested_name[256];
+        char field[256];
+        codegen_camel_case(type_name, property->name, nested_name, sizeof(nested_name));
+        codegen_identifier(property->name, field, sizeof(field));
+
+        CodegenValue value;
+        codegen_classify(property->schema, nested_name, &value);
+        if (value.kind == CODEGEN_UNSUPPORTED) {
+            continue;
+        }
+
+        if (codegen_has_flag(&value, property)) {
+            fprintf(codegen->header, "    bool has_%s;\n", field);
+        }
+
+        if (value.kind == CODEGEN_ARRAY) {
+            fprintf(codegen->header, "    %s* %s;\n", value.type, field);
+            fprintf(codegen->header, "    size_t %s_count;\n", field);
+        } else {
+            fprintf(codegen->header, "    %s %s;\n", value.type, field);
+        }
+        emitted++;
+        codegen_release(&value);
+    }
+
+    if (emitted == 0) {
+        // Empty structs are not valid C.
+        fprintf(codegen->header, "    char unused;\n");
+    }
+    fprintf(codegen->header, "} %s;\n\n", type_name);
+}
+
+static void codegen_emit_free_value(FILE* out, const CodegenValue* value, const char* lvalue, const char* indent) {
+    switch (value->kind) {
+        case CODEGEN_STRING:
+            fprintf(out, "%sfree(%s);\n", indent, lvalue);
+            fprintf(out, "%s%s = NULL;\n", indent, lvalue);
+            break;
+        case CODEGEN_OBJECT:
+            fprintf(out, "%s%s_free(&%s);\n", indent, value->prefix, lvalue);
+            break;
+        case CODEGEN_ARRAY:
+            if (value->item->kind == CODEGEN_STRING || value->item->kind == CODEGEN_OBJECT) {
+                char item[512];
+                char nested_indent[64];
+                snprintf(item, sizeof(item), "%s[i]", lvalue);
+                snprintf(nested_indent, sizeof(nested_indent), "%s    ", indent);
+                fprintf(out, "%sfor (size_t i = 0; i < %s_count; i++) {\n", indent, lvalue);
+                codegen_emit_free_value(out, value->item, item, nested_indent);
+                fprintf(out, "%s}\n", indent);
+            }
+            fprintf(out, "%sfree(%s);\n", indent, lvalue);
+            fprintf(out, "%s%s = NULL;\n", indent, lvalue);
+            fprintf(out, "%s%s_count = 0;\n", indent, lvalue);
+            break;
+        default:
+            break;
+    }
+}
+
+// Emits code that stores the current token into lvalue and returns false from the enclosing function on failure.
+static void codegen_emit_read_value(FILE* out, const CodegenValue* value, const char* lvalue, const char* indent) {
+    switch (value->kind) {
+        case CODEGEN_BOOL:
+        case CODEGEN_INTEGER:
+        case CODEGEN_NUMBER:
+            fprintf(out, "%s%s = %s(stream);\n", indent, lvalue, value->getter);
+            fprintf(out, "%sif (stream->error.type != JSON_ERROR_NONE) {\n", indent);
+            fprintf(out, "%s    return false;\n", indent);
+            fprintf(out, "%s}\n", indent);
+            break;
+        case CODEGEN_STRING:
+            fprintf(out, "%s%s = json_get_string_escaped(stream, NULL, 0, NULL);\n", indent, lvalue);
+            fprintf(out, "%sif (stream->error.type != JSON_ERROR_NONE) {\n", indent);
+            fprintf(out, "%s    return false;\n", indent);
+            fprintf(out, "%s}\n", indent);
+            break;
+        case CODEGEN_ENUM:
+            fprintf(out, "%sif (!%s_read(stream, &%s)) {\n", indent, value->prefix, lvalue);
+            fprintf(out, "%s    return false;\n", indent);
+            fprintf(out, "%s}\n", indent);
+            break;
+        case CODEGEN_OBJECT:
+            fprintf(out, "%sif (!%s_read_object(stream, &%s)) {\n", indent, value->prefix, lvalue);
+            fprintf(out, "%s    return false;\n", indent);
+            fprintf(out, "%s}\n", indent);
+            break;
+        case CODEGEN_ARRAY:
+            fprintf(out, "%sif (!%s_read_array(stream, &%s, &%s_count)) {\n", indent, value->prefix, lvalue, lvalue);
+            fprintf(out, "%s    return false;\n", indent);
+            fprintf(out, "%s}\n", indent);
+            break;
+        default:
+            break;
+    }
+}
+
+static void codegen_emit_array_reader(Codegen* codegen, const CodegenValue* value) {
+    FILE* out = codegen->source;
+    const char* item = value->item->type;
+
+    fprintf(
+        out,
+        "static bool %s_read_array(JsonStream* stream, %s** out_items, size_t* out_count) {\n",
+        value->prefix,
+        item
+    );
+    fprintf(out, "    if (json_token_type(stream) != JSON_TYPE_ARRAY_START) {\n");
+    fprintf(out, "        json_raise_error(\n");
+    fprintf(out, "            stream,\n");
+    fprintf(out, "            JSON_ERROR_INVALID_OPERATION_EXPECTED_ARRAY_START,\n");
+    fprintf(out, "            json_token_type_name(json_token_type(stream))\n");
+    fprintf(out, "        );\n");
+    fprintf(out, "        return false;\n");
+    fprintf(out, "    }\n\n");
+    fprintf(out, "    size_t capacity = 0;\n");
+    fprintf(out, "    while (json_read(stream)) {\n");
+    fprintf(out, "        if (json_token_type(stream) == JSON_TYPE_ARRAY_END) {\n");
+    fprintf(out, "            return true;\n");
+    fprintf(out, "        }\n\n");
+    fprintf(out, "        if (*out_count == capacity) {\n");
+    fprintf(out, "            capacity = capacity ? capacity * 2 : 8;\n");
+    fprintf(out, "            %s* items = realloc(*out_items, capacity * sizeof(%s));\n", item, item);
+    fprintf(out, "            if (!items) {\n");
+    fprintf(out, "                json_raise_error(stream, JSON_ERROR_OUT_OF_MEMORY, NULL);\n");
+    fprintf(out, "                return false;\n");
+    fprintf(out, "            }\n");
+    fprintf(out, "            *out_items = items;\n");
+    fprintf(out, "        }\n\n");
+    fprintf(out, "        %s* item = &(*out_items)[(*out_count)++];\n", item);
+    fprintf(out, "        memset(item, 0, sizeof(%s));\n", item);
+    codegen_emit_read_value(out, value->item, "*item", "        ");
+    fprintf(out, "    }\n\n");
+    fprintf(out, "    return false;\n");
+    fprintf(out, "}\n\n");
+}
+
+static void codegen_emit_key_matcher(Codegen* codegen, const JsonSchema* schema, const char* prefix) {
+    FILE* out = codegen->source;
+    size_t max_length = 0;
+    for (size_t i = 0; i < schema->property_count; i++) {
+        max_length = schema->properties[i].name_length > max_length ? schema->properties[i].name_length : max_length;
+    }
+
+    fprintf(out, "static int %s_match_key(JsonStream* stream) {\n", prefix);
+    fprintf(out, "    const char* key;\n");
+    fprintf(out, "    size_t length;\n");
+    fprintf(out, "    json_token(stream, &key, &length);\n\n");
+    fprintf(out, "    if (!json_value_is_escaped(stream)) {\n");
+    fprintf(out, "        switch (length) {\n");
+    for (size_t length = 0; length <= max_length; length++) {
+        bool any = false;
+        for (size_t i = 0; i < schema->property_count; i++) {
+            const JsonSchemaProperty* property = &schema->properties[i];
+            if (property->name_length != length) {
+                continue;
+            }
+            if (!any) {
+                fprintf(out, "            case %zu:\n", length);
+                any = true;
+            }
+            fprintf(out, "                if (memcmp(key, ");
+            codegen_string_literal(out, property->name, property->name_length);
+            fprintf(out, ", %zu) == 0) {\n", length);
+            fprintf(out, "                    return %zu;\n", i);
+            fprintf(out, "                }\n");
+        }
+        if (any) {
+            fprintf(out, "                break;\n");
+        }
+    }
+    fprintf(out, "        }\n");
+    fprintf(out, "        return -1;\n");
+    fprintf(out, "    }\n\n");
+
+    for (size_t i = 0; i < schema->property_count; i++) {
+        const JsonSchemaProperty* property = &schema->properties[i];
+        fprintf(out, "    if (json_text_equals(stream, ");
+        codegen_string_literal(out, property->name, property->name_length);
+        fprintf(out, ", %zu)) {\n", property->name_length);
+        fprintf(out, "        return %zu;\n", i);
+        fprintf(out, "    }\n");
+    }
+    fprintf(out, "    return -1;\n");
+    fprintf(out, "}\n\n");
+}
+
+static void codegen_emit_readers(Codegen* codegen, const JsonSchema* schema, const char* type_name, bool root) {
+    FILE* out = codegen->source;
+    char prefix[256];
+    codegen_snake_case(type_name, prefix, sizeof(prefix));
+    const char* linkage = root ? "" : "static ";
+
+    bool any_required = false;
+    for (size_t i = 0; i < schema->property_count; i++) {
+        char nested_name[256];
+        codegen_camel_case(type_name, schema->properties[i].name, nested_name, sizeof(nested_name));
+
+        CodegenValue value;
+        codegen_classify(schema->properties[i].schema, nested_name, &value);
+        codegen_emit_dependencies(codegen, &value, true);
+        if (value.kind == CODEGEN_ARRAY) {
+            codegen_emit_array_reader(codegen, &value);
+        }
+        codegen_release(&value);
+        any_required |= schema->properties[i].required;
+    }
+
+    fprintf(out, "%svoid %s_free(%s* value) {\n", linkage, prefix, type_name);
+    long free_start = ftell(out);
+    for (size_t i = 0; i < schema->property_count; i++) {
+        char nested_name[256];
+        char lvalue[512];
+        char field[256];
+        codegen_camel_case(type_name, schema->properties[i].name, nested_name, sizeof(nested_name));
+        codegen_identifier(schema->properties[i].name, field, sizeof(field));
+        snprintf(lvalue, sizeof(lvalue), "value->%s", field);
+
+        CodegenValue value;
+        codegen_classify(schema->properties[i].schema, nested_name, &value);
+        codegen_emit_free_value(out, &value, lvalue, "    ");
+        codegen_release(&value);
+    }
+    if (ftell(out) == free_start) {
+        fprintf(out, "    (void)value;\n");
+    }
+    fprintf(out, "}\n\n");
+
+    codegen_emit_key_matcher(codegen, schema, prefix);
+
+    fprintf(out, "static bool %s_read_object(JsonStream* stream, %s* out) {\n", prefix, type_name);
+    fprintf(out, "    if (json_token_type(stream) != JSON_TYPE_OBJECT_START) {\n");
+    fprintf(out, "        json_raise_error(\n");
+    fprintf(out, "            stream,\n");
+    fprintf(out, "            JSON_ERROR_INVALID_OPERATION_EXPECTED_OBJECT_START,\n");
+    fprintf(out, "            json_token_type_name(json_token_type(stream))\n");
+    fprintf(out, "        );\n");
+    fprintf(out, "        return false;\n");
+    fprintf(out, "    }\n\n");
+    if (any_required) {
+        fprintf(out, "    bool seen[%zu] = {false};\n", schema->property_count);
+    }
+    fprintf(out, "    while (json_read(stream)) {\n");
+    fprintf(out, "        if (json_token_type(stream) == JSON_TYPE_OBJECT_END) {\n");
+    for (size_t i = 0; i < schema->property_count; i++) {
+        const JsonSchemaProperty* property = &schema->properties[i];
+        if (!property->required) {
+            continue;
+        }
+        fprintf(out, "            if (!seen[%zu]) {\n", i);
+        fprintf(out, "                json_raise_error(stream, JSON_ERROR_REQUIRED_PROPERTY_NOT_FOUND, ");
+        codegen_string_literal(out, property->name, property->name_length);
+        fprintf(out, ");\n");
+        fprintf(out, "                return false;\n");
+        fprintf(out, "            }\n");
+    }
+    fprintf(out, "            return true;\n");
+    fprintf(out, "        }\n\n");
+    fprintf(out, "        switch (%s_match_key(stream)) {\n", prefix);
+
+    for (size_t i = 0; i < schema->property_count; i++) {
+        const JsonSchemaProperty* property = &schema->properties[i];
+        char nested_name[256];
+        char field[256];
+        char lvalue[512];
+        codegen_camel_case(type_name, property->name, nested_name, sizeof(nested_name));
+        codegen_identifier(property->name, field, sizeof(field));
+        snprintf(lvalue, sizeof(lvalue), "out->%s", field);
+
+        CodegenValue value;
+        codegen_classify(property->schema, nested_name, &value);
+
+        fprintf(out, "            case %zu:\n", i);
+        if (value.kind == CODEGEN_UNSUPPORTED) {
+            fprintf(out, "                if (!json_skip(stream)) {\n");
+            fprintf(out, "                    return false;\n");
+            fprintf(out, "                }\n");
+        } else {
+            fprintf(out, "                if (!json_read(stream)) {\n");
+            fprintf(out, "                    return false;\n");
+            fprintf(out, "                }\n");
+            if (value.kind == CODEGEN_STRING || value.kind == CODEGEN_OBJECT || value.kind == CODEGEN_ARRAY) {
+                // A repeated key replaces the earlier value.
+                codegen_emit_free_value(out, &value, lvalue, "                ");
+            }
+            if (value.nullable && value.kind != CODEGEN_STRING) {
+                fprintf(out, "                if (json_token_type(stream) == JSON_TYPE_NULL) {\n");
+                if (property->required) {
+                    fprintf(out, "                    seen[%zu] = true;\n", i);
+                }
+                fprintf(out, "                    break;\n");
+                fprintf(out, "                }\n");
+            }
+            codegen_emit_read_value(out, &value, lvalue, "                ");
+            if (codegen_has_flag(&value, property)) {
+                fprintf(out, "                out->has_%s = true;\n", field);
+            }
+        }
+        if (property->required) {
+            fprintf(out, "                seen[%zu] = true;\n", i);
+        }
+        fprintf(out, "                break;\n");
+        codegen_release(&value);
+    }
+
+    fprintf(out, "            default:\n");
+    fprintf(out, "                if (stream->error.type != JSON_ERROR_NONE || !json_skip(stream)) {\n");
+    fprintf(out, "                    return false;\n");
+    fprintf(out, "                }\n");
+    fprintf(out, "                break;\n");
+    fprintf(out, "        }\n");
+    fprintf(out, "    }\n\n");
+    fprintf(out, "    return false;\n");
+    fprintf(out, "}\n\n");
+
+    if (root) {
+        fprintf(out, "bool %s_read(JsonStream* stream, %s* out) {\n", prefix, type_name);
+        fprintf(out, "    if (json_token_type(stream) != JSON_TYPE_OBJECT_START && !json_read(stream)) {\n");
+        fprintf(out, "        return false;\n");
+        fprintf(out, "    }\n\n");
+        fprintf(out, "    return %s_read_object(stream, out);\n", prefix);
+        fprintf(out, "}\n");
+    }
+}
+
+static char* codegen_read_file(const char* path, size_t* out_size) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+
+    char* buffer = NULL;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        long size = ftell(file);
+        if (size >= 0 && fseek(file, 0, SEEK_SET) == 0) {
+            buffer = malloc((size_t)size + 1);
+            if (buffer && fread(buffer, 1, (size_t)size, file) == (size_t)size) {
+                buffer[size] = '\0';
+                *out_size = (size_t)size;
+            } else {
+                free(buffer);
+                buffer = NULL;
+            }
+        }
+    }
+
+    fclose(file);
+    return buffer;
+}
+
+static const char* codegen_base_name(const char* path) {
+    const char* slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 4 || argc > 5) {
+        fprintf(stderr, "usage: %s <schema.json> <output.h> <output.c> [TypeName]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    size_t size;
+    char* buffer = codegen_read_file(argv[1], &size);
+    if (!buffer) {
+        fprintf(stderr, "%s: cannot read schema\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    JsonStream stream;
+    JsonStreamOptions options = json_stream_options_default();
+    options.comment_handling = JSON_COMMENT_SKIP;
+    json_stream_init(&stream, buffer, size, true, options);
+
+    JsonSchema* schema;
+    if (!json_schema_parse(&stream, &schema)) {
+        char message[256];
+        json_error_get_message(&stream.error, message, sizeof(message));
+        fprintf(stderr, "%s:%zu:%zu: %s\n", argv[1], stream.error.line + 1, stream.error.column + 1, message);
+        json_stream_free_resources(&stream);
+        free(buffer);
+        return EXIT_FAILURE;
+    }
+
+    if (!(schema->types & JSON_SCHEMA_OBJECT)) {
+        fprintf(stderr, "%s: the root schema must describe an object\n", argv[1]);
+        json_schema_free(schema);
+        json_stream_free_resources(&stream);
+        free(buffer);
+        return EXIT_FAILURE;
+    }
+
+    char type_name[256];
+    if (argc == 5) {
+        codegen_camel_case("", argv[4], type_name, sizeof(type_name));
+    } else if (schema->title) {
+        codegen_camel_case("", schema->title, type_name, sizeof(type_name));
+    } else {
+        char stem[256];
+        snprintf(stem, sizeof(stem), "%s", codegen_base_name(argv[1]));
+        char* dot = strchr(stem, '.');
+        if (dot) {
+            *dot = '\0';
+        }
+        codegen_camel_case("", stem, type_name, sizeof(type_name));
+    }
+
+    Codegen codegen = {.header = fopen(argv[2], "w"), .source = fopen(argv[3], "w")};
+    if (!codegen.header || !codegen.source) {
+        fprintf(stderr, "cannot open output files\n");
+        return EXIT_FAILURE;
+    }
+
+    char guard[256];
+    codegen_upper_case(codegen_base_name(argv[2]), guard, sizeof(guard));
+    char prefix[256];
+    codegen_snake_case(type_name, prefix, sizeof(prefix));
+
+    fprintf(codegen.header, "// Generated by json_codegen from %s. Do not edit.\n\n", codegen_base_name(argv[1]));
+    fprintf(codegen.header, "#ifndef %s\n#define %s\n\n", guard, guard);
+    fprintf(codegen.header, "#include <json_stream.h>\n#include <stddef.h>\n#include <stdint.h>\n\n");
+    codegen_emit_types(&codegen, schema, type_name);
+    fprintf(codegen.header, "bool %s_read(JsonStream* stream, %s* out);\n\n", prefix, type_name);
+    fprintf(codegen.header, "void %s_free(%s* value);\n\n", prefix, type_name);
+    fprintf(codegen.header, "#endif // %s\n", guard);
+
+    fprintf(codegen.source, "// Generated by json_codegen from %s. Do not edit.\n\n", codegen_base_name(argv[1]));
+    fprintf(codegen.source, "#include \"%s\"\n\n", codegen_base_name(argv[2]));
+    fprintf(codegen.source, "#include <stdlib.h>\n#include <string.h>\n\n");
+    codegen_emit_readers(&codegen, schema, type_name, true);
+
+    bool failed = ferror(codegen.header) || ferror(codegen.source);
+    failed |= fclose(codegen.header) != 0;
+    failed |= fclose(codegen.source) != 0;
+
+    json_schema_free(schema);
+    json_stream_free_resources(&stream);
+    free(buffer);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}